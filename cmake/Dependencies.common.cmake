@@ -27,6 +27,14 @@ list(APPEND DALI_LIBS ${OpenCV_LIBRARIES})
 message("OpenCV libraries: ${OpenCV_LIBRARIES}")
 list(APPEND DALI_EXCLUDES libopencv_core.a;libopencv_imgproc.a;libopencv_highgui.a;libopencv_imgcodecs.a;liblibwebp.a;libittnotify.a;libpng.a;liblibtiff.a;liblibjasper.a;libIlmImf.a;liblibjpeg-turbo.a)
 
+##################################################################
+# zlib, for the compressed TFRecord files
+##################################################################
+find_package(ZLIB REQUIRED)
+include_directories(SYSTEM ${ZLIB_INCLUDE_DIRS})
+list(APPEND DALI_LIBS ${ZLIB_LIBRARIES})
+list(APPEND DALI_EXCLUDES libz.a)
+
 ##################################################################
 #
 # Optional dependencies
@@ -100,6 +108,17 @@ else()
   message(STATUS "Building WITHOUT LMDB support")
 endif()
 
+##################################################################
+# liburing
+##################################################################
+if (BUILD_LIBURING)
+  find_package(LibUring REQUIRED)
+  include_directories(SYSTEM ${LIBURING_INCLUDE_DIR})
+  list(APPEND DALI_LIBS ${LIBURING_LIBRARIES})
+else()
+  message(STATUS "Building WITHOUT liburing support")
+endif()
+
 ##################################################################
 # FFmpeg
 ##################################################################
@@ -0,0 +1,155 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <random>
+
+#include "dali/core/host_pool.h"
+#include "dali/core/tensor_view.h"
+#include "dali/kernels/alloc.h"
+#include "dali/kernels/imgproc/resample_cpu.h"
+#include "dali/kernels/scratch.h"
+#include "dali/kernels/slice/slice_flip_normalize_permute_cpu.h"
+
+namespace dali {
+
+// CPU kernels on 4K frames, with the buffers on regular or huge pages.
+// Arguments: HostMemoryPool::HugePages mode, height of the frame.
+class HugePagesBench : public benchmark::Fixture {
+ protected:
+  using HugePages = HostMemoryPool::HugePages;
+
+  void SetUp(const benchmark::State& st) override {
+    auto &pool = HostMemoryPool::Instance();
+    prev_huge_pages_ = pool.GetHugePages();
+    pool.SetHugePages(static_cast<HugePages>(st.range(0)));
+    blocks_before_ = pool.GetStats().huge_page_blocks;
+  }
+
+  void TearDown(const benchmark::State&) override {
+    HostMemoryPool::Instance().SetHugePages(prev_huge_pages_);
+  }
+
+  template <typename T>
+  kernels::memory::KernelUniquePtr<T> Alloc(size_t count, bool random_fill) {
+    auto mem = kernels::memory::alloc_unique<T>(kernels::AllocType::Host, count);
+    if (random_fill) {
+      std::mt19937 rng(1234);
+      std::uniform_int_distribution<int> dist(0, 255);
+      for (size_t i = 0; i < count; i++)
+        mem.get()[i] = static_cast<T>(dist(rng));
+    } else {
+      // touch the pages, so the page faults don't count
+      memset(mem.get(), 0, count * sizeof(T));
+    }
+    return mem;
+  }
+
+  void SetCounters(benchmark::State& st, size_t bytes_per_iter) {
+    st.SetBytesProcessed(st.iterations() * bytes_per_iter);
+    st.counters["huge_page_blocks"] =
+        HostMemoryPool::Instance().GetStats().huge_page_blocks - blocks_before_;
+  }
+
+  HugePages prev_huge_pages_ = HugePages::Off;
+  size_t blocks_before_ = 0;
+};
+
+static void HugePagesArgs(benchmark::internal::Benchmark *b) {
+  for (auto huge_pages : { HostMemoryPool::HugePages::Off,
+                           HostMemoryPool::HugePages::Transparent,
+                           HostMemoryPool::HugePages::Reserved }) {
+    for (int H : { 2160, 1080 }) {
+      b->Args({static_cast<int>(huge_pages), H});
+    }
+  }
+}
+
+// Downscaling by 2 with a triangular filter - goes through the float intermediate image
+// in the scratchpad
+BENCHMARK_DEFINE_F(HugePagesBench, ResampleCPU)(benchmark::State& st) {
+  int H = st.range(1), W = H * 16 / 9, C = 3;
+  TensorShape<3> in_shape = { H, W, C };
+  auto in_mem = Alloc<uint8_t>(volume(in_shape), true);
+  auto in = make_tensor_cpu<3>(static_cast<const uint8_t *>(in_mem.get()), in_shape);
+
+  kernels::ResamplingParams2D params;
+  for (int d = 0; d < 2; d++) {
+    params[d].output_size = in_shape[d] / 2;
+    params[d].min_filter = params[d].mag_filter = kernels::ResamplingFilterType::Triangular;
+  }
+
+  kernels::ResampleCPU<uint8_t, uint8_t> kernel;
+  kernels::KernelContext ctx;
+  kernels::ScratchpadAllocator scratch_alloc;
+  auto req = kernel.Setup(ctx, in, params);
+  scratch_alloc.Reserve(req.scratch_sizes);
+  auto out_shape = req.output_shapes[0].tensor_shape<3>(0);
+  auto out_mem = Alloc<uint8_t>(volume(out_shape), false);
+  auto out = make_tensor_cpu<3>(out_mem.get(), out_shape);
+
+  for (auto _ : st) {
+    auto scratchpad = scratch_alloc.GetScratchpad();
+    ctx.scratchpad = &scratchpad;
+    kernel.Run(ctx, out, in, params);
+    benchmark::DoNotOptimize(out.data);
+  }
+  SetCounters(st, volume(in_shape));
+}
+
+BENCHMARK_REGISTER_F(HugePagesBench, ResampleCPU)->Iterations(20)
+->Unit(benchmark::kMillisecond)
+->UseRealTime()
+->Apply(HugePagesArgs);
+
+// Crop, flip, normalize and HWC->CHW transpose - strided writes all over the output
+BENCHMARK_DEFINE_F(HugePagesBench, SliceFlipNormalizePermuteCPU)(benchmark::State& st) {
+  int H = st.range(1), W = H * 16 / 9, C = 3;
+  TensorShape<3> in_shape = { H, W, C };
+  auto in_mem = Alloc<uint8_t>(volume(in_shape), true);
+  auto in = make_tensor_cpu<3>(static_cast<const uint8_t *>(in_mem.get()), in_shape);
+
+  using Kernel = kernels::SliceFlipNormalizePermuteCPU<float, uint8_t, 3>;
+  Kernel::Args args(in_shape);
+  args.anchor = { 8, 8, 0 };
+  args.shape = { H - 16, W - 16, C };
+  args.padded_shape = args.shape;
+  args.flip[1] = true;
+  args.permuted_dims = { 2, 0, 1 };
+  args.normalization_dim = 2;
+  args.mean = { 124.0f, 117.0f, 104.0f };
+  args.inv_stddev = { 1 / 58.0f, 1 / 57.0f, 1 / 57.5f };
+
+  Kernel kernel;
+  kernels::KernelContext ctx;
+  auto req = kernel.Setup(ctx, in, args);
+  auto out_shape = req.output_shapes[0].tensor_shape<3>(0);
+  auto out_mem = Alloc<float>(volume(out_shape), false);
+  auto out = make_tensor_cpu<3>(out_mem.get(), out_shape);
+
+  for (auto _ : st) {
+    kernel.Run(ctx, out, in, args);
+    benchmark::DoNotOptimize(out.data);
+  }
+  SetCounters(st, volume(in_shape));
+}
+
+BENCHMARK_REGISTER_F(HugePagesBench, SliceFlipNormalizePermuteCPU)->Iterations(20)
+->Unit(benchmark::kMillisecond)
+->UseRealTime()
+->Apply(HugePagesArgs);
+
+}  // namespace dali
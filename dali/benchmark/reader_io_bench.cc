@@ -0,0 +1,99 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dali/pipeline/pipeline.h"
+
+namespace dali {
+
+// Measures the steady state throughput of the FileReader alone for the different I/O modes.
+// The dataset is taken from DALI_TEST_FILE_READER_LIST_ROOT, for meaningful results it should
+// be much bigger than the host memory, so the mmap mode can't be served from the page cache.
+class ReaderIO : public benchmark::Fixture {
+};
+
+BENCHMARK_DEFINE_F(ReaderIO, FileReader)(benchmark::State& st) { // NOLINT
+  static const char *backends[] = {"mmap", "pread", "io_uring"};
+  std::string io_backend = backends[st.range(0)];
+  bool direct_io = st.range(1);
+  int num_io_threads = st.range(2);
+  const int batch_size = 128;
+
+  const char *list_root = std::getenv("DALI_TEST_FILE_READER_LIST_ROOT");
+  if (!list_root) {
+    st.SkipWithError("DALI_TEST_FILE_READER_LIST_ROOT is not set");
+    return;
+  }
+
+  Pipeline pipe(batch_size, 4, 0, -1, true, 2, true);
+  pipe.AddOperator(
+      OpSpec("FileReader")
+      .AddArg("device", "cpu")
+      .AddArg("file_root", std::string(list_root))
+      .AddArg("random_shuffle", true)
+      .AddArg("io_backend", io_backend)
+      .AddArg("direct_io", direct_io)
+      .AddArg("num_io_threads", num_io_threads)
+      .AddOutput("compressed_images", "cpu")
+      .AddOutput("labels", "cpu"));
+
+  vector<std::pair<string, string>> outputs = {{"compressed_images", "cpu"}};
+  pipe.Build(outputs);
+
+  // Warm up, the first batches include the initial buffer fill
+  DeviceWorkspace ws;
+  for (int i = 0; i < 3; i++) {
+    pipe.RunCPU();
+    pipe.RunGPU();
+    pipe.Outputs(&ws);
+  }
+
+  int64_t bytes = 0;
+  for (auto _ : st) {
+    pipe.RunCPU();
+    pipe.RunGPU();
+    pipe.Outputs(&ws);
+    bytes += ws.Output<CPUBackend>(0).nbytes();
+  }
+
+  st.counters["FPS"] = benchmark::Counter(batch_size * st.iterations(),
+      benchmark::Counter::kIsRate);
+  st.SetBytesProcessed(bytes);
+}
+
+static void ReaderIOArgs(benchmark::internal::Benchmark *b) {
+  for (int backend = 0; backend < 3; ++backend) {
+    for (int direct_io = 0; direct_io < 2; ++direct_io) {
+      // direct I/O with mmap would fall back to pread
+      if (backend == 0 && direct_io)
+        continue;
+      for (int num_io_threads = 1; num_io_threads <= 16; num_io_threads *= 4) {
+        b->Args({backend, direct_io, num_io_threads});
+      }
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(ReaderIO, FileReader)->Iterations(200)
+->Unit(benchmark::kMillisecond)
+->UseRealTime()
+->Apply(ReaderIOArgs);
+
+}  // namespace dali
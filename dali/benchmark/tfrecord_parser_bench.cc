@@ -0,0 +1,139 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dali/operators/reader/parser/tfrecord_parser.h"
+#include "dali/operators/reader/parser/example.pb.h"
+#include "dali/pipeline/workspace/sample_workspace.h"
+
+namespace dali {
+
+// Per record cost of extracting 3 features (image, label, bbox) from records with
+// a growing number of other features, e.g. the image/object/* features of detection datasets.
+class TFRecordParse : public benchmark::Fixture {
+ protected:
+  void MakeRecord(int num_extra_features, bool share) {
+    tensorflow::Example example;
+    auto &features = *example.mutable_features()->mutable_feature();
+    features["image/encoded"].mutable_bytes_list()->add_value(std::string(100000, 'x'));
+    features["image/class/label"].mutable_int64_list()->add_value(7);
+    auto *bbox = features["image/object/bbox"].mutable_float_list();
+    for (int i = 0; i < 4 * 16; i++)
+      bbox->add_value(i * 0.01f);
+    for (int i = 0; i < num_extra_features; i++) {
+      features["image/extra/" + std::to_string(i)].mutable_bytes_list()->add_value(
+          "some text metadata " + std::to_string(i));
+    }
+
+    std::string payload;
+    example.SerializeToString(&payload);
+    uint64_t length = payload.size();
+    record_.resize(sizeof(length) + 4 + payload.size() + 4);
+    std::memcpy(record_.data(), &length, sizeof(length));
+    std::memcpy(record_.data() + sizeof(length) + 4, payload.data(), payload.size());
+
+    input_.Reset();
+    if (share) {
+      input_.ShareData(record_.data(), record_.size(), {static_cast<Index>(record_.size())});
+    } else {
+      input_.Resize({static_cast<Index>(record_.size())});
+      std::memcpy(input_.mutable_data<uint8_t>(), record_.data(), record_.size());
+    }
+    input_.set_type(TypeInfo::Create<uint8_t>());
+
+    ws_.Clear();
+    for (int i = 0; i < 3; i++) {
+      outputs_[i] = std::make_shared<Tensor<CPUBackend>>();
+      ws_.AddOutput(outputs_[i]);
+    }
+  }
+
+  OpSpec Spec() const {
+    std::vector<std::string> names = {"image/encoded", "image/class/label", "image/object/bbox"};
+    std::vector<TFUtil::Feature> features = {
+      TFUtil::Feature({1}, TFUtil::FeatureType::string, {}),
+      TFUtil::Feature({1}, TFUtil::FeatureType::int64, {}),
+      TFUtil::Feature(TFUtil::FeatureType::float32, {}, {4}),
+    };
+    return OpSpec("_TFRecordReader")
+        .AddArg("feature_names", names)
+        .AddArg("features", features);
+  }
+
+  std::vector<uint8_t> record_;
+  Tensor<CPUBackend> input_;
+  SampleWorkspace ws_;
+  std::shared_ptr<Tensor<CPUBackend>> outputs_[3];
+};
+
+// What TFRecordParser used to do: build the whole Example and look the features up in its map
+BENCHMARK_DEFINE_F(TFRecordParse, Example)(benchmark::State& st) { // NOLINT
+  MakeRecord(st.range(0), false);
+  const uint8_t *payload = record_.data() + sizeof(uint64_t) + sizeof(uint32_t);
+  uint64_t length;
+  std::memcpy(&length, record_.data(), sizeof(length));
+
+  for (auto _ : st) {
+    tensorflow::Example example;
+    DALI_ENFORCE(example.ParseFromArray(payload, length));
+    auto &features = example.features().feature();
+
+    auto &image = features.at("image/encoded").bytes_list().value(0);
+    outputs_[0]->Resize({static_cast<Index>(image.size())});
+    std::memcpy(outputs_[0]->mutable_data<uint8_t>(), image.data(), image.size());
+
+    auto &label = features.at("image/class/label").int64_list().value();
+    outputs_[1]->Resize({1});
+    outputs_[1]->mutable_data<int64_t>()[0] = label.Get(0);
+
+    auto &bbox = features.at("image/object/bbox").float_list().value();
+    outputs_[2]->Resize({bbox.size() / 4, 4});
+    std::memcpy(outputs_[2]->mutable_data<float>(), bbox.data(), bbox.size() * sizeof(float));
+  }
+  st.counters["records/s"] = benchmark::Counter(st.iterations(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_DEFINE_F(TFRecordParse, WireFormat)(benchmark::State& st) { // NOLINT
+  MakeRecord(st.range(0), st.range(1));
+  TFRecordParser parser(Spec());
+
+  for (auto _ : st) {
+    parser.Parse(input_, &ws_);
+  }
+  st.counters["records/s"] = benchmark::Counter(st.iterations(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(TFRecordParse, Example)
+->Unit(benchmark::kMicrosecond)
+->Arg(0)->Arg(16)->Arg(128);
+
+static void WireFormatArgs(benchmark::internal::Benchmark *b) {
+  for (int num_extra_features : {0, 16, 128}) {
+    for (int share = 0; share < 2; share++) {
+      b->Args({num_extra_features, share});
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(TFRecordParse, WireFormat)
+->Unit(benchmark::kMicrosecond)
+->Apply(WireFormatArgs);
+
+}  // namespace dali
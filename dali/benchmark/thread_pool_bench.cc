@@ -0,0 +1,150 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "dali/pipeline/util/thread_pool.h"
+
+namespace dali {
+
+// Scheduling overhead and load balancing of the ThreadPool on batches of samples.
+// Arguments: number of threads, batch size.
+class ThreadPoolBench : public benchmark::Fixture {
+ protected:
+  void Init(const benchmark::State& st) {
+    pool_.reset(new ThreadPool(st.range(0), -1, false));
+    batch_size_ = st.range(1);
+    sink_.assign(pool_->size() * kPadding, 0);
+  }
+
+  // Busy work proportional to `cost`, the result goes to a per thread slot
+  void Work(int tid, int64_t cost) {
+    uint64_t x = cost;
+    for (int64_t i = 0; i < cost; i++) {
+      x = x * 6364136223846793005ull + 1442695040888963407ull;
+    }
+    sink_[tid * kPadding] += x;
+  }
+
+  // Sample sizes with a long tail, like the file sizes of the image datasets
+  std::vector<int64_t> SkewedCosts() const {
+    std::mt19937 rng(524287);
+    std::lognormal_distribution<> dist(8.0, 1.0);
+    std::vector<int64_t> costs(batch_size_);
+    for (auto &c : costs) {
+      c = static_cast<int64_t>(dist(rng));
+    }
+    return costs;
+  }
+
+  void SetCounters(benchmark::State& st) {
+    st.counters["tasks/s"] = benchmark::Counter(st.iterations() * batch_size_,
+                                                benchmark::Counter::kIsRate);
+    benchmark::DoNotOptimize(sink_.data());
+  }
+
+  static constexpr int kPadding = 16;
+  std::unique_ptr<ThreadPool> pool_;
+  int batch_size_ = 0;
+  std::vector<uint64_t> sink_;
+};
+
+// Tiny tasks, submitted one by one - the cost is dominated by the scheduling
+BENCHMARK_DEFINE_F(ThreadPoolBench, SmallTasksDoWork)(benchmark::State& st) { // NOLINT
+  Init(st);
+  for (auto _ : st) {
+    for (int i = 0; i < batch_size_; i++) {
+      pool_->DoWorkWithID([this](int tid) { Work(tid, 16); });
+    }
+    pool_->WaitForWork();
+  }
+  SetCounters(st);
+}
+
+// Tiny tasks, submitted in bulk
+BENCHMARK_DEFINE_F(ThreadPoolBench, SmallTasksRunAll)(benchmark::State& st) { // NOLINT
+  Init(st);
+  for (auto _ : st) {
+    for (int i = 0; i < batch_size_; i++) {
+      pool_->AddWork([this](int tid) { Work(tid, 16); });
+    }
+    pool_->RunAll();
+  }
+  SetCounters(st);
+}
+
+// Samples of varying size, in the order of the batch
+BENCHMARK_DEFINE_F(ThreadPoolBench, SkewedTasks)(benchmark::State& st) { // NOLINT
+  Init(st);
+  auto costs = SkewedCosts();
+  for (auto _ : st) {
+    for (int i = 0; i < batch_size_; i++) {
+      int64_t cost = costs[i];
+      pool_->AddWork([this, cost](int tid) { Work(tid, cost); });
+    }
+    pool_->RunAll();
+  }
+  SetCounters(st);
+}
+
+// Samples of varying size, the biggest ones first
+BENCHMARK_DEFINE_F(ThreadPoolBench, SkewedTasksPriority)(benchmark::State& st) { // NOLINT
+  Init(st);
+  auto costs = SkewedCosts();
+  for (auto _ : st) {
+    for (int i = 0; i < batch_size_; i++) {
+      int64_t cost = costs[i];
+      pool_->AddWork([this, cost](int tid) { Work(tid, cost); }, cost);
+    }
+    pool_->RunAll();
+  }
+  SetCounters(st);
+}
+
+static void ThreadPoolArgs(benchmark::internal::Benchmark *b) {
+  int max_threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 4) {
+    for (int batch_size : {32, 256}) {
+      b->Args({num_threads, batch_size});
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(ThreadPoolBench, SmallTasksDoWork)
+->Unit(benchmark::kMicrosecond)
+->UseRealTime()
+->Apply(ThreadPoolArgs);
+
+BENCHMARK_REGISTER_F(ThreadPoolBench, SmallTasksRunAll)
+->Unit(benchmark::kMicrosecond)
+->UseRealTime()
+->Apply(ThreadPoolArgs);
+
+BENCHMARK_REGISTER_F(ThreadPoolBench, SkewedTasks)
+->Unit(benchmark::kMicrosecond)
+->UseRealTime()
+->Apply(ThreadPoolArgs);
+
+BENCHMARK_REGISTER_F(ThreadPoolBench, SkewedTasksPriority)
+->Unit(benchmark::kMicrosecond)
+->UseRealTime()
+->Apply(ThreadPoolArgs);
+
+}  // namespace dali
@@ -242,6 +242,55 @@ void daliCopyTensorNTo(daliPipelineHandle* pipe_handle, void* dst, int n, device
   }
 }
 
+int daliGetOperatorStatistics(daliPipelineHandle* pipe_handle, daliOperatorStats** stats) {
+  static_assert(DALI_NUM_LATENCY_BUCKETS == dali::OperatorStats::kNumLatencyBuckets,
+                "Number of the latency buckets must match the one of dali::OperatorStats");
+  dali::Pipeline* pipeline = reinterpret_cast<dali::Pipeline*>(pipe_handle->pipe);
+  auto executor_stats = pipeline->GetExecutorStatistics();
+  int count = executor_stats.operators.size();
+  *stats = static_cast<daliOperatorStats*>(malloc(sizeof(daliOperatorStats) * count));
+  int i = 0;
+  for (const auto &op : executor_stats.operators) {
+    const dali::OperatorStats &op_stats = op.second;
+    daliOperatorStats &out = (*stats)[i++];
+    out.name = static_cast<char*>(malloc(op_stats.name.size() + 1));
+    memcpy(out.name, op_stats.name.c_str(), op_stats.name.size() + 1);
+    out.op_type = static_cast<int>(op_stats.op_type);
+    out.iterations = op_stats.iterations;
+    out.total_time_ns = op_stats.total_time_ns;
+    out.max_time_ns = op_stats.max_time_ns;
+    out.wait_time_ns = op_stats.wait_time_ns;
+    out.bytes_produced = op_stats.bytes_produced;
+    out.samples = op_stats.samples;
+    out.total_sample_time_ns = op_stats.total_sample_time_ns;
+    std::copy(op_stats.sample_latency_histogram.begin(), op_stats.sample_latency_histogram.end(),
+              out.sample_latency_histogram);
+  }
+  return count;
+}
+
+void daliFreeOperatorStatistics(daliOperatorStats* stats, int count) {
+  for (int i = 0; i < count; i++) {
+    free(stats[i].name);
+  }
+  free(stats);
+}
+
+static void daliStageStatsHelper(const dali::StageStats &stats, daliStageStats* out) {
+  out->iterations = stats.iterations;
+  out->wait_time_ns = stats.wait_time_ns;
+  out->max_wait_time_ns = stats.max_wait_time_ns;
+}
+
+void daliGetStageStatistics(daliPipelineHandle* pipe_handle, daliStageStats* cpu_stats,
+                            daliStageStats* mixed_stats, daliStageStats* gpu_stats) {
+  dali::Pipeline* pipeline = reinterpret_cast<dali::Pipeline*>(pipe_handle->pipe);
+  auto stages = pipeline->GetExecutorStatistics().stages;
+  daliStageStatsHelper(stages[dali::OpType::CPU], cpu_stats);
+  daliStageStatsHelper(stages[dali::OpType::MIXED], mixed_stats);
+  daliStageStatsHelper(stages[dali::OpType::GPU], gpu_stats);
+}
+
 void daliDeletePipeline(daliPipelineHandle* pipe_handle) {
   dali::Pipeline* pipeline = reinterpret_cast<dali::Pipeline*>(pipe_handle->pipe);
   dali::DeviceWorkspace* ws = reinterpret_cast<dali::DeviceWorkspace*>(pipe_handle->ws);
@@ -31,6 +31,36 @@ extern "C" {
     GPU = 1
   };
 
+  #define DALI_NUM_LATENCY_BUCKETS 24
+
+  /**
+   * @brief Run time statistics of a single operator
+   * op_type (0 - GPU, 1 - CPU, 2 - Mixed)
+   * sample_latency_histogram[i] counts the samples processed in [2^(i-1), 2^i) us,
+   * bucket 0 the ones shorter than 1 us and the last one also all the longer ones
+   */
+  struct daliOperatorStats {
+    char* name;
+    int op_type;
+    int64_t iterations;
+    int64_t total_time_ns;
+    int64_t max_time_ns;
+    int64_t wait_time_ns;
+    int64_t bytes_produced;
+    int64_t samples;
+    int64_t total_sample_time_ns;
+    int64_t sample_latency_histogram[DALI_NUM_LATENCY_BUCKETS];
+  };
+
+  /**
+   * @brief Time a stage of the executor spent waiting for its output buffers
+   */
+  struct daliStageStats {
+    int64_t iterations;
+    int64_t wait_time_ns;
+    int64_t max_wait_time_ns;
+  };
+
   /**
    * @brief Create DALI pipeline. Setting batch_size,
    * num_threads or device_id here overrides
@@ -150,6 +180,28 @@ extern "C" {
                                     device_type_t dst_type, cudaStream_t stream,
                                     bool non_blocking);
 
+  /**
+   * @brief Return the run time statistics of all the operators of the pipeline
+   * in `*stats` and their number.
+   * @remarks Caller is responsible to release the returned array
+   * with daliFreeOperatorStatistics
+   */
+  DLL_PUBLIC int daliGetOperatorStatistics(daliPipelineHandle* pipe_handle,
+                                           daliOperatorStats** stats);
+
+  /**
+   * @brief Release the statistics returned by daliGetOperatorStatistics
+   */
+  DLL_PUBLIC void daliFreeOperatorStatistics(daliOperatorStats* stats, int count);
+
+  /**
+   * @brief Return the queue wait times of the cpu, mixed and gpu stages of the executor.
+   */
+  DLL_PUBLIC void daliGetStageStatistics(daliPipelineHandle* pipe_handle,
+                                         daliStageStats* cpu_stats,
+                                         daliStageStats* mixed_stats,
+                                         daliStageStats* gpu_stats);
+
   /**
    * @brief Delete the pipeline object.
    */
@@ -0,0 +1,545 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dali/core/error_handling.h"
+#include "dali/core/host_pool.h"
+
+namespace dali {
+
+constexpr size_t HostMemoryPool::kMaxThreadCachedBytes;
+constexpr size_t HostMemoryPool::kMaxPooledBytes;
+constexpr size_t HostMemoryPool::kMinBlockBytes;
+constexpr size_t HostMemoryPool::kMinHugePageBytes;
+constexpr size_t HostMemoryPool::kHugePageSize;
+
+namespace {
+
+constexpr int kSubClassShift = 3;
+constexpr int kMinBlockShift = 6;
+constexpr int kUnpooled = -1;
+constexpr uint16_t kBlockMagic = 0xDA11;
+
+// Keeps the malloc alignment of the data following it
+struct alignas(16) BlockHeader {
+  int32_t size_class;
+  uint16_t magic;
+  // whether the block is mapped with mmap, rather than malloc'd
+  uint16_t mapped;
+  // usable bytes, or the length of the mapping
+  uint64_t bytes;
+};
+
+static_assert(sizeof(BlockHeader) == 16, "Unexpected size of the block header");
+
+inline BlockHeader *GetHeader(void *ptr) {
+  return static_cast<BlockHeader *>(ptr) - 1;
+}
+
+constexpr int Log2Floor(size_t x) {
+  int log = 0;
+  while (x >>= 1)
+    log++;
+  return log;
+}
+
+constexpr int SizeClassOf(size_t bytes) {
+  if (bytes <= HostMemoryPool::kMinBlockBytes)
+    return 0;
+  size_t s = bytes - 1;
+  int e = Log2Floor(s);
+  int sub = (s >> (e - kSubClassShift)) & ((1 << kSubClassShift) - 1);
+  return ((e - kMinBlockShift) << kSubClassShift) + sub + 1;
+}
+
+constexpr int kNumThreadClasses = SizeClassOf(HostMemoryPool::kMaxThreadCachedBytes) + 1;
+constexpr int kNumClasses = SizeClassOf(HostMemoryPool::kMaxPooledBytes) + 1;
+
+/**
+ * @brief Maps at least `bytes` bytes with huge pages requested.
+ *
+ * @param length the length of the mapping
+ * @param fell_back set if `Reserved` huge pages were requested and there were none
+ * @return the mapping, nullptr on failure
+ */
+void *MapHugePages(size_t bytes, HostMemoryPool::HugePages huge_pages,
+                   size_t &length, bool &fell_back) {
+  constexpr size_t page = HostMemoryPool::kHugePageSize;
+  length = (bytes + page - 1) & ~(page - 1);
+  fell_back = false;
+  if (huge_pages == HostMemoryPool::HugePages::Reserved) {
+#ifdef MAP_HUGETLB
+    void *mem = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mem != MAP_FAILED)
+      return mem;
+#endif
+    fell_back = true;
+  }
+  // The kernel backs only the aligned 2 MiB ranges with transparent huge pages,
+  // so map more and trim the mapping to an aligned start.
+  size_t mapped = length + page;
+  void *mem = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED)
+    return nullptr;
+  uintptr_t addr = reinterpret_cast<uintptr_t>(mem);
+  uintptr_t start = (addr + page - 1) & ~(page - 1);
+  size_t head = start - addr;
+  size_t tail = mapped - head - length;
+  if (head)
+    munmap(mem, head);
+  if (tail)
+    munmap(reinterpret_cast<void *>(start + length), tail);
+#ifdef MADV_HUGEPAGE
+  // without the THP support in the kernel, these are just regular pages
+  madvise(reinterpret_cast<void *>(start), length, MADV_HUGEPAGE);
+#endif
+  return reinterpret_cast<void *>(start);
+}
+
+void FreeBlock(void *ptr) {
+  auto *header = GetHeader(ptr);
+  if (header->mapped)
+    munmap(header, header->bytes);
+  else
+    free(header);
+}
+
+HostMemoryPool::HugePages HugePagesFromEnv() {
+  const char *env = std::getenv("DALI_HUGE_PAGES");
+  if (!env || !strcmp(env, "off") || !strcmp(env, "0"))
+    return HostMemoryPool::HugePages::Off;
+  if (!strcmp(env, "thp"))
+    return HostMemoryPool::HugePages::Transparent;
+  if (!strcmp(env, "reserved"))
+    return HostMemoryPool::HugePages::Reserved;
+  DALI_WARN("Unknown DALI_HUGE_PAGES value: " + std::string(env) +
+            ". Expected off, thp or reserved. Using regular pages.");
+  return HostMemoryPool::HugePages::Off;
+}
+
+}  // namespace
+
+int HostMemoryPool::SizeClass(size_t bytes) {
+  return SizeClassOf(bytes);
+}
+
+size_t HostMemoryPool::ClassBytes(int size_class) {
+  if (size_class == 0)
+    return kMinBlockBytes;
+  int e = ((size_class - 1) >> kSubClassShift) + kMinBlockShift;
+  int sub = (size_class - 1) & ((1 << kSubClassShift) - 1);
+  return (size_t(1) << e) + (size_t(sub + 1) << (e - kSubClassShift));
+}
+
+struct HostMemoryPool::SharedCache {
+  struct FreeList {
+    std::mutex mutex;
+    std::vector<void *> blocks;
+  };
+
+  SharedCache(const Params &params, bool enabled)
+      : free_lists(kNumClasses), enabled(enabled) {
+    static std::atomic<uint64_t> next_id{0};
+    id = next_id++;
+    SetParams(params);
+  }
+
+  ~SharedCache() {
+    for (auto &list : free_lists) {
+      for (void *block : list.blocks)
+        FreeBlock(block);
+    }
+  }
+
+  void SetParams(const Params &params) {
+    release_threshold = params.release_threshold;
+    thread_cache_bytes = params.thread_cache_bytes;
+  }
+
+  /**
+   * @brief Number of blocks of the size class a thread keeps - up to a quarter of its cache
+   */
+  size_t ThreadCacheLimit(int size_class) const {
+    return std::max<size_t>(2, thread_cache_bytes / 4 / ClassBytes(size_class));
+  }
+
+  void *Pop(int size_class) {
+    auto &list = free_lists[size_class];
+    std::lock_guard<std::mutex> lock(list.mutex);
+    if (list.blocks.empty())
+      return nullptr;
+    void *block = list.blocks.back();
+    list.blocks.pop_back();
+    size_t bytes = ClassBytes(size_class);
+    shared_bytes -= bytes;
+    cached_bytes -= bytes;
+    return block;
+  }
+
+  /**
+   * @brief Moves up to `count` blocks to `out`, returns the number of blocks moved
+   */
+  size_t PopMany(int size_class, std::vector<void *> &out, size_t count) {
+    auto &list = free_lists[size_class];
+    std::lock_guard<std::mutex> lock(list.mutex);
+    size_t n = std::min(count, list.blocks.size());
+    out.insert(out.end(), list.blocks.end() - n, list.blocks.end());
+    list.blocks.resize(list.blocks.size() - n);
+    // the blocks stay cached, in the thread cache now
+    shared_bytes -= n * ClassBytes(size_class);
+    return n;
+  }
+
+  /**
+   * @brief Puts the blocks, already counted in `cached_bytes`, in the free list.
+   *        The ones that don't fit in the release threshold are freed, and so are all of them
+   *        while the pooling is disabled.
+   */
+  void Push(int size_class, void *const *blocks, size_t count) {
+    size_t bytes = ClassBytes(size_class);
+    auto &list = free_lists[size_class];
+    size_t kept = 0;
+    if (enabled) {
+      std::lock_guard<std::mutex> lock(list.mutex);
+      for (; kept < count; kept++) {
+        if (shared_bytes + bytes > release_threshold)
+          break;
+        list.blocks.push_back(blocks[kept]);
+        shared_bytes += bytes;
+      }
+    }
+    for (size_t i = kept; i < count; i++)
+      FreeBlock(blocks[i]);
+    cached_bytes -= (count - kept) * bytes;
+    releases += count - kept;
+  }
+
+  void Release() {
+    for (int c = 0; c < kNumClasses; c++) {
+      std::vector<void *> blocks;
+      {
+        std::lock_guard<std::mutex> lock(free_lists[c].mutex);
+        blocks.swap(free_lists[c].blocks);
+      }
+      for (void *block : blocks)
+        FreeBlock(block);
+      shared_bytes -= blocks.size() * ClassBytes(c);
+      cached_bytes -= blocks.size() * ClassBytes(c);
+      releases += blocks.size();
+    }
+  }
+
+  void AddAllocated(size_t bytes) {
+    size_t allocated = allocated_bytes += bytes;
+    size_t peak = peak_allocated_bytes.load(std::memory_order_relaxed);
+    while (allocated > peak &&
+           !peak_allocated_bytes.compare_exchange_weak(peak, allocated,
+                                                       std::memory_order_relaxed)) {}
+  }
+
+  uint64_t id;
+  std::vector<FreeList> free_lists;
+  std::atomic<size_t> release_threshold;
+  std::atomic<size_t> thread_cache_bytes;
+  // mirrors the flag of the pool, so the blocks flushed from the thread caches are freed
+  // when the pooling is disabled
+  std::atomic<bool> enabled;
+
+  // bytes in the free lists above
+  std::atomic<size_t> shared_bytes{0};
+  // bytes in the free lists and in the thread caches
+  std::atomic<size_t> cached_bytes{0};
+  std::atomic<size_t> allocated_bytes{0};
+  std::atomic<size_t> peak_allocated_bytes{0};
+  std::atomic<size_t> hits{0};
+  std::atomic<size_t> misses{0};
+  std::atomic<size_t> releases{0};
+  std::atomic<size_t> huge_page_blocks{0};
+  std::atomic<size_t> huge_page_fallbacks{0};
+};
+
+namespace {
+
+/**
+ * @brief Free blocks of the calling thread, for every pool it used
+ */
+class ThreadCaches {
+ public:
+  struct Cache {
+    uint64_t pool_id;
+    std::weak_ptr<HostMemoryPool::SharedCache> shared;
+    std::vector<std::vector<void *>> blocks;
+    // bytes of all the blocks above
+    size_t bytes;
+  };
+
+  ~ThreadCaches() {
+    destroyed_ = true;
+    for (auto &cache : caches_)
+      Flush(cache);
+  }
+
+  /**
+   * @brief The caches of the calling thread, nullptr when the thread is exiting
+   *        and its thread-local objects may be already destroyed
+   */
+  static ThreadCaches *ThisThread();
+
+  Cache &Get(const std::shared_ptr<HostMemoryPool::SharedCache> &shared) {
+    for (auto &cache : caches_) {
+      if (cache.pool_id == shared->id)
+        return cache;
+    }
+    // drop the caches of the pools that are gone
+    for (auto it = caches_.begin(); it != caches_.end();) {
+      if (it->shared.expired()) {
+        Flush(*it);
+        it = caches_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    caches_.push_back({ shared->id, shared, std::vector<std::vector<void *>>(kNumThreadClasses),
+                        0 });
+    return caches_.back();
+  }
+
+  /**
+   * @brief Gives the blocks back to the pool, or to the system if the pool is gone
+   */
+  static void Flush(Cache &cache) {
+    auto shared = cache.shared.lock();
+    for (int c = 0; c < static_cast<int>(cache.blocks.size()); c++) {
+      auto &blocks = cache.blocks[c];
+      if (shared) {
+        shared->Push(c, blocks.data(), blocks.size());
+      } else {
+        for (void *block : blocks)
+          FreeBlock(block);
+      }
+      blocks.clear();
+    }
+    cache.bytes = 0;
+  }
+
+  /**
+   * @brief Gives the oldest blocks back to the shared cache, the biggest ones first,
+   *        until the cache keeps at most `max_bytes`
+   */
+  static void Trim(Cache &cache, HostMemoryPool::SharedCache &shared, size_t max_bytes) {
+    for (int c = static_cast<int>(cache.blocks.size()) - 1; c >= 0 && cache.bytes > max_bytes;
+         c--) {
+      auto &blocks = cache.blocks[c];
+      size_t class_bytes = HostMemoryPool::ClassBytes(c);
+      size_t n = std::min(blocks.size(), (cache.bytes - max_bytes + class_bytes - 1) / class_bytes);
+      shared.Push(c, blocks.data(), n);
+      blocks.erase(blocks.begin(), blocks.begin() + n);
+      cache.bytes -= n * class_bytes;
+    }
+  }
+
+ private:
+  std::vector<Cache> caches_;
+  // trivially destructible, so it can be checked after the caches are destroyed
+  static thread_local bool destroyed_;
+};
+
+thread_local bool ThreadCaches::destroyed_ = false;
+thread_local ThreadCaches thread_caches;
+
+ThreadCaches *ThreadCaches::ThisThread() {
+  return destroyed_ ? nullptr : &thread_caches;
+}
+
+}  // namespace
+
+HostMemoryPool &HostMemoryPool::Instance() {
+  // never destroyed, the blocks may be freed by static destructors
+  static HostMemoryPool *instance = []() {
+    auto *pool = new HostMemoryPool(Params(), false);
+    pool->SetHugePages(HugePagesFromEnv());
+    return pool;
+  }();
+  return *instance;
+}
+
+HostMemoryPool::HostMemoryPool() : HostMemoryPool(Params()) {}
+
+HostMemoryPool::HostMemoryPool(const Params &params, bool enabled)
+    : enabled_(enabled), shared_(std::make_shared<SharedCache>(params, enabled)) {}
+
+HostMemoryPool::~HostMemoryPool() = default;
+
+void HostMemoryPool::SetEnabled(bool enabled) {
+  enabled_ = enabled;
+  shared_->enabled = enabled;
+}
+
+void HostMemoryPool::SetParams(const Params &params) {
+  shared_->SetParams(params);
+}
+
+void *HostMemoryPool::AllocateBlock(int size_class, size_t bytes) noexcept {
+  size_t total = sizeof(BlockHeader) + bytes;
+  auto huge_pages = GetHugePages();
+  if (huge_pages != HugePages::Off && bytes >= kMinHugePageBytes) {
+    size_t length;
+    bool fell_back;
+    if (void *mem = MapHugePages(total, huge_pages, length, fell_back)) {
+      shared_->huge_page_blocks++;
+      if (fell_back)
+        shared_->huge_page_fallbacks++;
+      auto *header = static_cast<BlockHeader *>(mem);
+      header->size_class = size_class;
+      header->magic = kBlockMagic;
+      header->mapped = 1;
+      header->bytes = length;
+      return header + 1;
+    }
+    // no address space for the aligned mapping, malloc may still find some
+  }
+  auto *header = static_cast<BlockHeader *>(malloc(total));
+  if (!header)
+    return nullptr;
+  header->size_class = size_class;
+  header->magic = kBlockMagic;
+  header->mapped = 0;
+  header->bytes = bytes;
+  return header + 1;
+}
+
+void *HostMemoryPool::Allocate(size_t bytes) noexcept {
+  if (!IsEnabled() || bytes > kMaxPooledBytes)
+    return AllocateBlock(kUnpooled, bytes);
+
+  auto &shared = *shared_;
+  int size_class = SizeClass(bytes);
+  size_t class_bytes = ClassBytes(size_class);
+  void *block = nullptr;
+  auto *thread_cache = ThreadCaches::ThisThread();
+  if (size_class < kNumThreadClasses && thread_cache) {
+    auto &cache = thread_cache->Get(shared_);
+    auto &blocks = cache.blocks[size_class];
+    if (blocks.empty()) {
+      size_t n = shared.PopMany(size_class, blocks, (shared.ThreadCacheLimit(size_class) + 1) / 2);
+      cache.bytes += n * class_bytes;
+    }
+    if (!blocks.empty()) {
+      block = blocks.back();
+      blocks.pop_back();
+      cache.bytes -= class_bytes;
+      shared.cached_bytes -= class_bytes;
+    }
+  } else {
+    block = shared.Pop(size_class);
+  }
+
+  if (block) {
+    shared.hits++;
+  } else {
+    shared.misses++;
+    block = AllocateBlock(size_class, class_bytes);
+    if (!block) {
+      // the cached blocks of other sizes may be what's missing
+      Release();
+      block = AllocateBlock(size_class, class_bytes);
+      if (!block)
+        return nullptr;
+    }
+  }
+  shared.AddAllocated(class_bytes);
+  return block;
+}
+
+void HostMemoryPool::Deallocate(void *ptr) noexcept {
+  if (!ptr)
+    return;
+  auto *header = GetHeader(ptr);
+  assert(header->magic == kBlockMagic && "Not a block of the HostMemoryPool");
+  int size_class = header->size_class;
+  if (size_class == kUnpooled) {
+    FreeBlock(ptr);
+    return;
+  }
+
+  auto &shared = *shared_;
+  size_t class_bytes = ClassBytes(size_class);
+  shared.allocated_bytes -= class_bytes;
+  if (!IsEnabled()) {
+    FreeBlock(ptr);
+    shared.releases++;
+    return;
+  }
+
+  shared.cached_bytes += class_bytes;
+  auto *thread_cache = ThreadCaches::ThisThread();
+  if (size_class < kNumThreadClasses && thread_cache) {
+    auto &cache = thread_cache->Get(shared_);
+    auto &blocks = cache.blocks[size_class];
+    blocks.push_back(ptr);
+    cache.bytes += class_bytes;
+    size_t limit = shared.ThreadCacheLimit(size_class);
+    if (blocks.size() > limit) {
+      // keep the most recently freed blocks, they are likely still in the CPU cache
+      size_t n = blocks.size() - limit / 2;
+      shared.Push(size_class, blocks.data(), n);
+      blocks.erase(blocks.begin(), blocks.begin() + n);
+      cache.bytes -= n * class_bytes;
+    }
+    if (cache.bytes > shared.thread_cache_bytes)
+      ThreadCaches::Trim(cache, shared, shared.thread_cache_bytes / 2);
+  } else {
+    shared.Push(size_class, &ptr, 1);
+  }
+}
+
+void HostMemoryPool::Release() {
+  if (auto *thread_cache = ThreadCaches::ThisThread()) {
+    auto &cache = thread_cache->Get(shared_);
+    for (int c = 0; c < static_cast<int>(cache.blocks.size()); c++) {
+      for (void *block : cache.blocks[c])
+        FreeBlock(block);
+      shared_->cached_bytes -= cache.blocks[c].size() * ClassBytes(c);
+      shared_->releases += cache.blocks[c].size();
+      cache.blocks[c].clear();
+    }
+    cache.bytes = 0;
+  }
+  shared_->Release();
+}
+
+HostMemoryPool::Stats HostMemoryPool::GetStats() const {
+  Stats stats;
+  stats.allocated_bytes = shared_->allocated_bytes;
+  stats.peak_allocated_bytes = shared_->peak_allocated_bytes;
+  stats.cached_bytes = shared_->cached_bytes;
+  stats.hits = shared_->hits;
+  stats.misses = shared_->misses;
+  stats.releases = shared_->releases;
+  stats.huge_page_blocks = shared_->huge_page_blocks;
+  stats.huge_page_fallbacks = shared_->huge_page_fallbacks;
+  return stats;
+}
+
+}  // namespace dali
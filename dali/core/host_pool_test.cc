@@ -0,0 +1,213 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dali/core/host_pool.h"
+
+namespace dali {
+
+TEST(HostMemoryPoolTest, SizeClasses) {
+  EXPECT_EQ(HostMemoryPool::SizeClass(0), 0);
+  EXPECT_EQ(HostMemoryPool::SizeClass(64), 0);
+  EXPECT_EQ(HostMemoryPool::ClassBytes(HostMemoryPool::SizeClass(65)), 72u);
+  EXPECT_EQ(HostMemoryPool::ClassBytes(HostMemoryPool::SizeClass(128)), 128u);
+  EXPECT_EQ(HostMemoryPool::ClassBytes(HostMemoryPool::SizeClass(129)), 144u);
+  for (size_t bytes = 1; bytes < (size_t(1) << 34); bytes = bytes * 5 / 3 + 1) {
+    int size_class = HostMemoryPool::SizeClass(bytes);
+    size_t class_bytes = HostMemoryPool::ClassBytes(size_class);
+    EXPECT_GE(class_bytes, bytes);
+    EXPECT_LE(class_bytes, std::max<size_t>(64, bytes + bytes / 8));
+    EXPECT_EQ(HostMemoryPool::SizeClass(class_bytes), size_class);
+  }
+}
+
+TEST(HostMemoryPoolTest, ReusesBlocks) {
+  HostMemoryPool pool;
+  void *a = pool.Allocate(1000);
+  ASSERT_NE(a, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % alignof(std::max_align_t), 0u);
+  memset(a, 0xAB, 1000);
+  pool.Deallocate(a);
+  // same size class
+  void *b = pool.Allocate(990);
+  EXPECT_EQ(a, b);
+  auto stats = pool.GetStats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.allocated_bytes, HostMemoryPool::ClassBytes(HostMemoryPool::SizeClass(1000)));
+  EXPECT_EQ(stats.cached_bytes, 0u);
+  pool.Deallocate(b);
+
+  size_t large = 100 << 20;
+  void *c = pool.Allocate(large);
+  ASSERT_NE(c, nullptr);
+  pool.Deallocate(c);
+  EXPECT_GE(pool.GetStats().cached_bytes, large);
+  EXPECT_EQ(pool.Allocate(large), c);
+  pool.Deallocate(c);
+
+  pool.Release();
+  stats = pool.GetStats();
+  EXPECT_EQ(stats.cached_bytes, 0u);
+  EXPECT_EQ(stats.allocated_bytes, 0u);
+  EXPECT_GE(stats.peak_allocated_bytes, large);
+  EXPECT_EQ(stats.releases, 2u);
+}
+
+TEST(HostMemoryPoolTest, ReleaseThreshold) {
+  HostMemoryPool::Params params;
+  params.release_threshold = 3 << 20;
+  HostMemoryPool pool(params);
+  std::vector<void *> blocks;
+  for (int i = 0; i < 5; i++)
+    blocks.push_back(pool.Allocate(1 << 20));
+  for (void *block : blocks)
+    pool.Deallocate(block);
+  auto stats = pool.GetStats();
+  EXPECT_EQ(stats.cached_bytes, size_t(3) << 20);
+  EXPECT_EQ(stats.releases, 2u);
+}
+
+TEST(HostMemoryPoolTest, Disabled) {
+  HostMemoryPool pool({}, false);
+  void *a = pool.Allocate(1000);
+  ASSERT_NE(a, nullptr);
+  pool.Deallocate(a);
+  EXPECT_EQ(pool.GetStats().misses, 0u);
+  EXPECT_EQ(pool.GetStats().cached_bytes, 0u);
+
+  // the blocks allocated while pooling outlive it
+  pool.SetEnabled(true);
+  void *b = pool.Allocate(1000);
+  pool.SetEnabled(false);
+  pool.Deallocate(b);
+  EXPECT_EQ(pool.GetStats().allocated_bytes, 0u);
+  EXPECT_EQ(pool.GetStats().cached_bytes, 0u);
+}
+
+TEST(HostMemoryPoolTest, DisabledFreesThreadCaches) {
+  HostMemoryPool pool;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool cached = false, disabled = false;
+  std::thread thread([&]() {
+    // stays in the cache of this thread
+    pool.Deallocate(pool.Allocate(1000));
+    std::unique_lock<std::mutex> lock(mutex);
+    cached = true;
+    cv.notify_all();
+    cv.wait(lock, [&]() { return disabled; });
+  });
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]() { return cached; });
+  }
+  pool.SetEnabled(false);
+  pool.Release();
+  EXPECT_GT(pool.GetStats().cached_bytes, 0u);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    disabled = true;
+  }
+  cv.notify_all();
+  // the exiting thread flushes its cache, which is freed rather than kept in the pool
+  thread.join();
+  EXPECT_EQ(pool.GetStats().cached_bytes, 0u);
+}
+
+TEST(HostMemoryPoolTest, ThreadCacheBudget) {
+  HostMemoryPool::Params params;
+  params.thread_cache_bytes = 1 << 20;
+  HostMemoryPool pool(params);
+  std::vector<void *> blocks;
+  for (size_t bytes = 64; bytes <= HostMemoryPool::kMaxThreadCachedBytes; bytes = bytes * 5 / 4) {
+    for (int i = 0; i < 8; i++)
+      blocks.push_back(pool.Allocate(bytes));
+  }
+  for (void *block : blocks)
+    pool.Deallocate(block);
+  // releasing from another thread leaves only the cache of this one
+  std::thread([&pool]() { pool.Release(); }).join();
+  auto cached_bytes = pool.GetStats().cached_bytes;
+  EXPECT_GT(cached_bytes, 0u);
+  EXPECT_LE(cached_bytes, params.thread_cache_bytes);
+  pool.Release();
+  EXPECT_EQ(pool.GetStats().cached_bytes, 0u);
+}
+
+TEST(HostMemoryPoolTest, HugePages) {
+  for (auto huge_pages : { HostMemoryPool::HugePages::Transparent,
+                           HostMemoryPool::HugePages::Reserved }) {
+    for (bool pooled : { false, true }) {
+      HostMemoryPool pool({}, pooled);
+      pool.SetHugePages(huge_pages);
+      void *small = pool.Allocate(HostMemoryPool::kMinHugePageBytes / 2);
+      size_t bytes = 3 * HostMemoryPool::kMinHugePageBytes + 5;
+      void *big = pool.Allocate(bytes);
+      ASSERT_NE(small, nullptr);
+      ASSERT_NE(big, nullptr);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(big) % alignof(std::max_align_t), 0u);
+      memset(big, 0x5A, bytes);
+      // the block starts right after the header, at the beginning of a huge page
+      EXPECT_LE(reinterpret_cast<uintptr_t>(big) % HostMemoryPool::kHugePageSize, 16u);
+      auto stats = pool.GetStats();
+      EXPECT_EQ(stats.huge_page_blocks, 1u);
+      if (huge_pages == HostMemoryPool::HugePages::Transparent)
+        EXPECT_EQ(stats.huge_page_fallbacks, 0u);
+      pool.Deallocate(small);
+      pool.Deallocate(big);
+      pool.Release();
+    }
+  }
+}
+
+TEST(HostMemoryPoolTest, MultipleThreads) {
+  HostMemoryPool pool;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&pool, t]() {
+      std::vector<void *> blocks;
+      for (int i = 0; i < 1000; i++) {
+        size_t bytes = 1 + (i * 7919 + t) % (1 << 19);
+        void *block = pool.Allocate(bytes);
+        ASSERT_NE(block, nullptr);
+        memset(block, t, bytes);
+        blocks.push_back(block);
+        if (i % 3 == 2) {
+          pool.Deallocate(blocks.front());
+          blocks.erase(blocks.begin());
+        }
+      }
+      for (void *block : blocks)
+        pool.Deallocate(block);
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  // the thread caches were flushed when the threads exited
+  auto stats = pool.GetStats();
+  EXPECT_EQ(stats.allocated_bytes, 0u);
+  EXPECT_EQ(stats.hits + stats.misses, 4000u);
+  pool.Release();
+  EXPECT_EQ(pool.GetStats().cached_bytes, 0u);
+}
+
+}  // namespace dali
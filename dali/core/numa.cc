@@ -0,0 +1,219 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cuda_runtime_api.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <sys/sysinfo.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dali/core/error_handling.h"
+#include "dali/core/numa.h"
+
+namespace dali {
+namespace numa {
+
+namespace detail {
+
+std::vector<int> ParseCPUList(const std::string &list) {
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(),
+                               [](char c) { return std::isspace(c); }), range.end());
+    if (range.empty())
+      continue;
+    auto dash = range.find('-');
+    int first = std::stoi(range.substr(0, dash));
+    int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; cpu++) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+}  // namespace detail
+
+namespace {
+
+struct Topology {
+  std::vector<std::vector<int>> node_cpus;
+  std::vector<int> cpu_node;
+};
+
+bool ReadFirstLine(const std::string &path, std::string &line) {
+  std::ifstream file(path);
+  return file.good() && std::getline(file, line);
+}
+
+Topology DiscoverTopology() {
+  Topology topology;
+  std::string line;
+  if (ReadFirstLine("/sys/devices/system/node/online", line)) {
+    for (int node : detail::ParseCPUList(line)) {
+      std::string cpulist;
+      if (!ReadFirstLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist",
+                         cpulist))
+        continue;
+      if (static_cast<int>(topology.node_cpus.size()) <= node)
+        topology.node_cpus.resize(node + 1);
+      topology.node_cpus[node] = detail::ParseCPUList(cpulist);
+    }
+  }
+  if (topology.node_cpus.empty()) {
+    // no NUMA, a single node with all the CPUs
+    topology.node_cpus.resize(1);
+    for (int cpu = 0; cpu < get_nprocs_conf(); cpu++) {
+      topology.node_cpus[0].push_back(cpu);
+    }
+  }
+
+  for (size_t node = 0; node < topology.node_cpus.size(); node++) {
+    for (int cpu : topology.node_cpus[node]) {
+      if (static_cast<int>(topology.cpu_node.size()) <= cpu)
+        topology.cpu_node.resize(cpu + 1, -1);
+      topology.cpu_node[cpu] = node;
+    }
+  }
+  return topology;
+}
+
+const Topology &GetTopology() {
+  static const Topology topology = DiscoverTopology();
+  return topology;
+}
+
+thread_local int bound_node = -1;
+
+}  // namespace
+
+int NumNodes() {
+  return GetTopology().node_cpus.size();
+}
+
+const std::vector<int> &NodeCPUs(int node) {
+  DALI_ENFORCE(node >= 0 && node < NumNodes(),
+               "Invalid NUMA node " + std::to_string(node) + ", the host has " +
+               std::to_string(NumNodes()) + " nodes.");
+  return GetTopology().node_cpus[node];
+}
+
+int NodeOfCPU(int cpu) {
+  auto &cpu_node = GetTopology().cpu_node;
+  return cpu >= 0 && cpu < static_cast<int>(cpu_node.size()) ? cpu_node[cpu] : -1;
+}
+
+int CurrentNode() {
+  return NodeOfCPU(sched_getcpu());
+}
+
+int DeviceNode(int device_id) {
+  if (device_id < 0)
+    return -1;
+  char bus_id[64];
+  if (cudaDeviceGetPCIBusId(bus_id, sizeof(bus_id), device_id) != cudaSuccess) {
+    cudaGetLastError();
+    return -1;
+  }
+  std::string path = bus_id;
+  std::transform(path.begin(), path.end(), path.begin(), ::tolower);
+  std::string line;
+  if (!ReadFirstLine("/sys/bus/pci/devices/" + path + "/numa_node", line))
+    return -1;
+  int node = std::atoi(line.c_str());
+  return node < NumNodes() ? node : -1;
+}
+
+int AffinityNode(int device_id) {
+  const char *env_node = std::getenv("DALI_NUMA_NODE");
+  if (env_node) {
+    int node = std::atoi(env_node);
+    DALI_ENFORCE(node >= 0 && node < NumNodes(),
+                 "DALI_NUMA_NODE is set to " + std::string(env_node) + ", but the host has " +
+                 std::to_string(NumNodes()) + " NUMA nodes.");
+    return node;
+  }
+  if (NumNodes() <= 1)
+    return -1;
+  return DeviceNode(device_id);
+}
+
+bool BindCurrentThread(int node) {
+  cpu_set_t allowed_set;
+  CPU_ZERO(&allowed_set);
+  pthread_getaffinity_np(pthread_self(), sizeof(allowed_set), &allowed_set);
+
+  cpu_set_t node_set;
+  CPU_ZERO(&node_set);
+  int num_cpus = 0;
+  for (int cpu : NodeCPUs(node)) {
+    if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed_set)) {
+      CPU_SET(cpu, &node_set);
+      num_cpus++;
+    }
+  }
+  if (num_cpus == 0) {
+    DALI_WARN("None of the CPUs of the NUMA node " + std::to_string(node) +
+              " is allowed for the DALI thread. Use taskset tool to check allowed affinity");
+    return false;
+  }
+
+  int error = pthread_setaffinity_np(pthread_self(), sizeof(node_set), &node_set);
+  if (error != 0) {
+    DALI_WARN("Setting affinity failed! Error code: " + std::to_string(error));
+    return false;
+  }
+  bound_node = node;
+  return true;
+}
+
+int BoundNode() {
+  return bound_node;
+}
+
+void PlaceMemory(void *ptr, size_t bytes) {
+#if defined(__linux__) && defined(SYS_mbind)
+  if (bound_node < 0 || bytes < kMinPlacedBytes || ptr == nullptr)
+    return;
+  // only the pages entirely in the allocation
+  const uintptr_t page = sysconf(_SC_PAGESIZE);
+  uintptr_t begin = (reinterpret_cast<uintptr_t>(ptr) + page - 1) & ~(page - 1);
+  uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + bytes) & ~(page - 1);
+  if (end <= begin)
+    return;
+
+  // values from numaif.h, so that libnuma is not needed
+  constexpr int kMpolPreferred = 1;
+  constexpr unsigned kMpolMfMove = 1 << 1;
+  constexpr int kBitsPerLong = sizeof(unsigned long) * 8;  // NOLINT(runtime/int)
+  std::vector<unsigned long> node_mask(bound_node / kBitsPerLong + 1);  // NOLINT(runtime/int)
+  node_mask[bound_node / kBitsPerLong] = 1ul << (bound_node % kBitsPerLong);
+  syscall(SYS_mbind, begin, end - begin, kMpolPreferred, node_mask.data(),
+          node_mask.size() * kBitsPerLong + 1, kMpolMfMove);
+#endif
+}
+
+}  // namespace numa
+}  // namespace dali
@@ -0,0 +1,98 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <sched.h>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dali/core/numa.h"
+
+namespace dali {
+namespace numa {
+
+TEST(NumaTest, ParseCPUList) {
+  EXPECT_EQ(detail::ParseCPUList("0-3,8,10-11\n"), std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(detail::ParseCPUList("5"), std::vector<int>({5}));
+  EXPECT_TRUE(detail::ParseCPUList("").empty());
+}
+
+TEST(NumaTest, Topology) {
+  ASSERT_GE(NumNodes(), 1);
+  int num_cpus = 0;
+  for (int node = 0; node < NumNodes(); node++) {
+    for (int cpu : NodeCPUs(node)) {
+      EXPECT_EQ(NodeOfCPU(cpu), node);
+      num_cpus++;
+    }
+  }
+  EXPECT_GT(num_cpus, 0);
+  EXPECT_EQ(NodeOfCPU(-1), -1);
+  int current = CurrentNode();
+  EXPECT_GE(current, 0);
+  EXPECT_LT(current, NumNodes());
+}
+
+TEST(NumaTest, AffinityNodeFromEnv) {
+  setenv("DALI_NUMA_NODE", "0", 1);
+  EXPECT_EQ(AffinityNode(0), 0);
+  setenv("DALI_NUMA_NODE", std::to_string(NumNodes()).c_str(), 1);
+  EXPECT_THROW(AffinityNode(0), std::runtime_error);
+  unsetenv("DALI_NUMA_NODE");
+  // the GPU is not known
+  EXPECT_EQ(AffinityNode(-1), -1);
+}
+
+TEST(NumaTest, BindThread) {
+  // every node with CPUs this process may use
+  std::vector<int> nodes;
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  sched_getaffinity(0, sizeof(allowed), &allowed);
+  for (int node = 0; node < NumNodes(); node++) {
+    for (int cpu : NodeCPUs(node)) {
+      if (CPU_ISSET(cpu, &allowed)) {
+        nodes.push_back(node);
+        break;
+      }
+    }
+  }
+  ASSERT_FALSE(nodes.empty());
+
+  for (int node : nodes) {
+    std::thread t([node]() {
+      EXPECT_EQ(BoundNode(), -1);
+      ASSERT_TRUE(BindCurrentThread(node));
+      EXPECT_EQ(BoundNode(), node);
+      sched_yield();
+      EXPECT_EQ(CurrentNode(), node);
+
+      // the memory stays usable
+      std::vector<char> buffer(4 * kMinPlacedBytes, 1);
+      PlaceMemory(buffer.data(), buffer.size());
+      memset(buffer.data(), 2, buffer.size());
+      EXPECT_EQ(buffer.back(), 2);
+    });
+    t.join();
+  }
+  // the main thread is not affected
+  EXPECT_EQ(BoundNode(), -1);
+}
+
+}  // namespace numa
+}  // namespace dali
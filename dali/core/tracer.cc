@@ -0,0 +1,245 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "dali/core/error_handling.h"
+#include "dali/core/tracer.h"
+
+namespace dali {
+
+namespace {
+
+/**
+ * @brief Ring buffer of the events of a single thread.
+ *
+ * Only the owning thread writes to it. Every slot is guarded by a sequence number
+ * (odd while the slot is being written), so a concurrent dump can skip the slots
+ * that are being overwritten.
+ */
+struct ThreadTraceBuffer {
+  struct Slot {
+    std::atomic<uint64_t> seq{0};
+    char name[Tracer::kMaxNameLength + 1];
+    int64_t begin_ns;
+    int64_t end_ns;
+  };
+
+  explicit ThreadTraceBuffer(int tid) : tid(tid), slots(Tracer::kEventsPerThread) {}
+
+  void Record(const char *name, size_t length, int64_t begin_ns, int64_t end_ns) {
+    uint64_t idx = head.load(std::memory_order_relaxed);
+    Slot &slot = slots[idx % slots.size()];
+    slot.seq.store(2 * idx + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    length = std::min<size_t>(length, Tracer::kMaxNameLength);
+    memcpy(slot.name, name, length);
+    slot.name[length] = '\0';
+    slot.begin_ns = begin_ns;
+    slot.end_ns = end_ns;
+    slot.seq.store(2 * idx + 2, std::memory_order_release);
+    head.store(idx + 1, std::memory_order_release);
+  }
+
+  // Returns false if the event was (being) overwritten
+  bool Read(uint64_t idx, Slot &out) const {
+    const Slot &slot = slots[idx % slots.size()];
+    uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq != 2 * idx + 2)
+      return false;
+    memcpy(out.name, slot.name, sizeof(out.name));
+    out.begin_ns = slot.begin_ns;
+    out.end_ns = slot.end_ns;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == seq;
+  }
+
+  const int tid;
+  std::string thread_name;  // guarded by the mutex of the registry
+  std::atomic<bool> finished{false};
+  std::atomic<uint64_t> head{0};
+  std::atomic<uint64_t> cleared{0};
+  std::vector<Slot> slots;
+};
+
+struct TraceRegistry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers;
+  int next_tid = 0;
+};
+
+TraceRegistry &Registry() {
+  // never destroyed, the threads may outlive the static objects
+  static TraceRegistry *registry = new TraceRegistry();
+  return *registry;
+}
+
+struct ThreadTraceState {
+  ~ThreadTraceState() {
+    if (buffer)
+      buffer->finished = true;
+  }
+
+  std::shared_ptr<ThreadTraceBuffer> buffer;
+  std::string thread_name;
+};
+
+thread_local ThreadTraceState thread_state;
+
+ThreadTraceBuffer &CurrentBuffer() {
+  if (!thread_state.buffer) {
+    auto &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    thread_state.buffer = std::make_shared<ThreadTraceBuffer>(registry.next_tid++);
+    thread_state.buffer->thread_name = thread_state.thread_name;
+    registry.buffers.push_back(thread_state.buffer);
+  }
+  return *thread_state.buffer;
+}
+
+void WriteJsonString(std::ostream &os, const char *str) {
+  os << '"';
+  for (; *str; str++) {
+    char c = *str;
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      os << escaped;
+    } else {
+      os << c;
+    }
+  }
+  os << '"';
+}
+
+// The trace format uses microseconds
+void WriteMicroseconds(std::ostream &os, int64_t ns) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%" PRId64 ".%03" PRId64, ns / 1000, ns % 1000);
+  os << buf;
+}
+
+}  // namespace
+
+constexpr int Tracer::kMaxNameLength;
+constexpr int Tracer::kEventsPerThread;
+
+std::atomic<bool> Tracer::enabled_{false};
+
+void Tracer::Enable(bool enabled) {
+  enabled_ = enabled;
+}
+
+int64_t Tracer::Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::Record(const char *name, size_t length, int64_t begin_ns, int64_t end_ns) {
+  CurrentBuffer().Record(name, length, begin_ns, end_ns);
+}
+
+void Tracer::SetThreadName(const std::string &name) {
+  thread_state.thread_name = name;
+  if (thread_state.buffer) {
+    std::lock_guard<std::mutex> lock(Registry().mutex);
+    thread_state.buffer->thread_name = name;
+  }
+}
+
+void Tracer::DumpChromeTrace(std::ostream &os) {
+  std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers;
+  std::vector<std::string> thread_names;
+  {
+    auto &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    buffers = registry.buffers;
+    for (auto &buffer : buffers) {
+      thread_names.push_back(buffer->thread_name);
+    }
+  }
+
+  int pid = getpid();
+  bool first = true;
+  auto separator = [&]() {
+    os << (first ? "\n" : ",\n");
+    first = false;
+  };
+
+  os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  for (size_t b = 0; b < buffers.size(); b++) {
+    const auto &buffer = *buffers[b];
+    if (!thread_names[b].empty()) {
+      separator();
+      os << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid
+         << ", \"tid\": " << buffer.tid << ", \"args\": {\"name\": ";
+      WriteJsonString(os, thread_names[b].c_str());
+      os << "}}";
+    }
+
+    uint64_t head = buffer.head.load(std::memory_order_acquire);
+    uint64_t begin = head > buffer.slots.size() ? head - buffer.slots.size() : 0;
+    begin = std::max<uint64_t>(begin, buffer.cleared.load(std::memory_order_relaxed));
+    ThreadTraceBuffer::Slot event;
+    for (uint64_t idx = begin; idx < head; idx++) {
+      if (!buffer.Read(idx, event))
+        continue;
+      separator();
+      os << "{\"name\": ";
+      WriteJsonString(os, event.name);
+      os << ", \"ph\": \"X\", \"pid\": " << pid << ", \"tid\": " << buffer.tid << ", \"ts\": ";
+      WriteMicroseconds(os, event.begin_ns);
+      os << ", \"dur\": ";
+      WriteMicroseconds(os, event.end_ns - event.begin_ns);
+      os << "}";
+    }
+  }
+  os << "\n]}\n";
+}
+
+void Tracer::DumpChromeTrace(const std::string &filename) {
+  std::ofstream file(filename);
+  DALI_ENFORCE(file.good(), "Could not open the trace file " + filename + " for writing");
+  DumpChromeTrace(file);
+  DALI_ENFORCE(file.good(), "Could not write the trace file " + filename);
+}
+
+void Tracer::Clear() {
+  auto &registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto &buffers = registry.buffers;
+  buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                               [](const std::shared_ptr<ThreadTraceBuffer> &buffer) {
+                                 return buffer->finished.load();
+                               }),
+                buffers.end());
+  for (auto &buffer : buffers) {
+    buffer->cleared = buffer->head.load(std::memory_order_acquire);
+  }
+}
+
+}  // namespace dali
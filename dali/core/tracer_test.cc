@@ -0,0 +1,108 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "dali/core/common.h"
+#include "dali/core/tracer.h"
+
+namespace dali {
+
+namespace {
+
+int CountOccurrences(const std::string &str, const std::string &what) {
+  int count = 0;
+  for (size_t pos = str.find(what); pos != std::string::npos; pos = str.find(what, pos + 1)) {
+    count++;
+  }
+  return count;
+}
+
+std::string DumpTrace() {
+  std::stringstream ss;
+  Tracer::DumpChromeTrace(ss);
+  return ss.str();
+}
+
+}  // namespace
+
+TEST(TracerTest, TimeRange) {
+  Tracer::Clear();
+  Tracer::Enable();
+  {
+    TimeRange tr("tracer_test \"range\"");
+  }
+  Tracer::Enable(false);
+  {
+    TimeRange tr("tracer_test disabled range");
+  }
+  auto trace = DumpTrace();
+  EXPECT_EQ(trace.find("{\"displayTimeUnit\": \"ms\", \"traceEvents\": ["), 0u);
+  EXPECT_EQ(CountOccurrences(trace, "\"name\": \"tracer_test \\\"range\\\"\", \"ph\": \"X\""), 1);
+  EXPECT_EQ(CountOccurrences(trace, "tracer_test disabled range"), 0);
+}
+
+TEST(TracerTest, Threads) {
+  Tracer::Clear();
+  Tracer::Enable();
+  std::thread worker([]() {
+    Tracer::SetThreadName("tracer_test worker");
+    for (int i = 0; i < 3; i++) {
+      TimeRange tr("tracer_test worker event");
+    }
+  });
+  worker.join();
+  {
+    TimeRange tr("tracer_test main event");
+  }
+  Tracer::Enable(false);
+
+  auto trace = DumpTrace();
+  EXPECT_EQ(CountOccurrences(trace, "\"args\": {\"name\": \"tracer_test worker\"}"), 1);
+  EXPECT_EQ(CountOccurrences(trace, "tracer_test worker event"), 3);
+  EXPECT_EQ(CountOccurrences(trace, "tracer_test main event"), 1);
+
+  // the buffer of the finished thread is dropped
+  Tracer::Clear();
+  trace = DumpTrace();
+  EXPECT_EQ(CountOccurrences(trace, "tracer_test"), 0);
+}
+
+TEST(TracerTest, RingBuffer) {
+  Tracer::Clear();
+  const int n = Tracer::kEventsPerThread + 10;
+  for (int i = 0; i < n; i++) {
+    Tracer::Record("tracer_test event " + to_string(i), 1000 * i, 1000 * i + 1500);
+  }
+  auto trace = DumpTrace();
+  // only the most recent events are kept
+  EXPECT_EQ(CountOccurrences(trace, "tracer_test event"), Tracer::kEventsPerThread);
+  EXPECT_EQ(CountOccurrences(trace, "\"tracer_test event 9\""), 0);
+  EXPECT_EQ(CountOccurrences(trace, "\"tracer_test event 10\""), 1);
+  std::string last = "\"tracer_test event " + to_string(n - 1) + "\"";
+  EXPECT_EQ(CountOccurrences(trace, last), 1);
+  // microseconds
+  EXPECT_EQ(CountOccurrences(trace, "\"ts\": " + to_string(n - 1) + ".000, \"dur\": 1.500}"), 1);
+
+  std::string long_name(2 * Tracer::kMaxNameLength, 'x');
+  Tracer::Record(long_name, 0, 1);
+  trace = DumpTrace();
+  EXPECT_EQ(CountOccurrences(trace, "\"" + long_name.substr(0, Tracer::kMaxNameLength) + "\""), 1);
+  Tracer::Clear();
+}
+
+}  // namespace dali
@@ -80,6 +80,51 @@ GenericImage::DecodeImpl(DALIImageType image_type,
 }
 
 
+Image::Shape GenericImage::DecodeToImpl(DALIImageType image_type,
+                                        const uint8_t *encoded_buffer,
+                                        size_t length,
+                                        const OutputAllocator &get_output) const {
+  Shape shape;
+  bool peeked = false;
+  if (!GetCropWindowGenerator()) {
+    try {
+      shape = PeekShapeImpl(encoded_buffer, length);
+      peeked = true;
+    } catch (std::exception &) {
+      // Unknown format, imdecode will tell
+    }
+  }
+  if (!peeked) {
+    auto decoded = GenericImage::DecodeImpl(image_type, encoded_buffer, length);
+    std::memcpy(get_output(decoded.second), decoded.first.get(), volume(decoded.second));
+    return decoded.second;
+  }
+
+  const int c = IsColor(image_type) ? 3 : 1;
+  shape[2] = c;
+  // imdecode keeps the buffer of the destination if the decoded image has its size and type.
+  // It doesn't when e.g. the EXIF orientation transposes the image.
+  uint8_t *output = get_output(shape);
+  cv::Mat decoded_image(shape[0], shape[1], c == 3 ? CV_8UC3 : CV_8UC1, output);
+  cv::imdecode(
+    cv::Mat(1, length, CV_8UC1, (void *) (encoded_buffer)),         //NOLINT
+    IsColor(image_type) ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE,
+    &decoded_image);
+
+  DALI_ENFORCE(decoded_image.data != nullptr, "Unsupported image type.");
+
+  // if different image type needed (e.g. RGB), permute from BGR
+  if (IsColor(image_type) && image_type != DALI_BGR) {
+    OpenCvColorConversion(DALI_BGR, decoded_image, image_type, decoded_image);
+  }
+
+  if (decoded_image.data != output) {
+    shape = {decoded_image.rows, decoded_image.cols, c};
+    std::memcpy(get_output(shape), decoded_image.ptr(), volume(shape));
+  }
+  return shape;
+}
+
 Image::Shape GenericImage::PeekShapeImpl(const uint8_t *encoded_buffer, size_t length) const {
   DALI_FAIL("Cannot peek dims for Generic image (of unknown format)");
 }
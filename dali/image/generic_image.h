@@ -31,6 +31,13 @@ class GenericImage : public Image {
   DecodeImpl(DALIImageType image_type, const uint8_t *encoded_buffer, size_t length) const override;
 
   Shape PeekShapeImpl(const uint8_t *encoded_buffer, size_t length) const override;
+
+  /**
+   * If the shape of the image can be peeked and it's not cropped, OpenCV decodes it
+   * straight into the output. Otherwise the decoded image is copied.
+   */
+  Shape DecodeToImpl(DALIImageType image_type, const uint8_t *encoded_buffer, size_t length,
+                     const OutputAllocator &get_output) const override;
 };
 
 }  // namespace dali
@@ -71,8 +71,23 @@ void Image::Decode() {
 }
 
 
+Image::Shape Image::DecodeTo(const OutputAllocator &get_output) {
+  DALI_ENFORCE(!decoded_, "Called decode for already decoded image");
+  shape_ = DecodeToImpl(image_type_, encoded_image_, length_, get_output);
+  decoded_ = true;
+  return shape_;
+}
+
+Image::Shape Image::DecodeToImpl(DALIImageType image_type, const uint8_t *encoded_buffer,
+                                 size_t length, const OutputAllocator &get_output) const {
+  auto decoded = DecodeImpl(image_type, encoded_buffer, length);
+  std::memcpy(get_output(decoded.second), decoded.first.get(), volume(decoded.second));
+  return decoded.second;
+}
+
 std::shared_ptr<uint8_t> Image::GetImage() const {
   DALI_ENFORCE(decoded_, "Image not decoded. Run Decode()");
+  DALI_ENFORCE(decoded_image_, "Image decoded to an external buffer with DecodeTo()");
   return decoded_image_;
 }
 
@@ -46,12 +46,35 @@ class Image {
  public:
   using Shape = TensorShape<3>;
 
+  /**
+   * Provides the memory for the decoded image of a given shape.
+   *
+   * It can be called more than once for a single image, with different shapes, see DecodeTo.
+   */
+  using OutputAllocator = std::function<uint8_t *(const Shape &shape)>;
+
   /**
    * Perform image decoding. Actual implementation is defined
    * by DecodeImpl template method
    */
   DLL_PUBLIC void Decode();
 
+  /**
+   * Decodes the image straight into the memory returned by `get_output`,
+   * e.g. into the output tensor, without an intermediate buffer.
+   *
+   * `get_output` may be called more than once, and each time it has to return a buffer
+   * for the shape it gets:
+   * - when the decoder fails and falls back to another one,
+   * - when the decoded image doesn't have the shape from the header, e.g. it is transposed
+   *   by the EXIF orientation; the shape of the first call is then only tentative.
+   * The last call gets the shape of the decoded image, which is in the buffer it returned.
+   * The buffers of the earlier calls are not used afterwards, so they can be reallocated.
+   * GetImage() is not available afterwards.
+   * @return shape of the decoded image
+   */
+  DLL_PUBLIC Shape DecodeTo(const OutputAllocator &get_output);
+
   /**
    * Returns pointer to decoded image. Decode(...) has to be called
    * prior to calling this function
@@ -139,6 +162,14 @@ class Image {
    */
   virtual Shape PeekShapeImpl(const uint8_t *encoded_buffer, size_t length) const = 0;
 
+  /**
+   * Template method, that decodes the image into the memory provided by `get_output`.
+   * By default it runs DecodeImpl and copies the image.
+   * @return shape of the decoded image
+   */
+  virtual Shape DecodeToImpl(DALIImageType image_type, const uint8_t *encoded_buffer,
+                             size_t length, const OutputAllocator &get_output) const;
+
   Image(const uint8_t *encoded_buffer, size_t length, DALIImageType image_type);
 
   /**
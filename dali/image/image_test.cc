@@ -0,0 +1,71 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <vector>
+#include "dali/core/tensor_shape_print.h"
+#include "dali/test/dali_test_decoder.h"
+
+namespace dali {
+
+// Decoding straight into the output, with Image::DecodeTo, for the formats other than JPEG
+template <typename ImgType>
+class ImageDecodeToTest : public GenericDecoderTest<ImgType> {
+};
+
+typedef ::testing::Types<RGB, BGR, Gray> Types;
+TYPED_TEST_SUITE(ImageDecodeToTest, Types);
+
+TYPED_TEST(ImageDecodeToTest, PNG) {
+  this->RunTestDecodeTo(this->png_);
+}
+
+TYPED_TEST(ImageDecodeToTest, BMP) {
+  this->RunTestDecodeTo(this->bmp_);
+}
+
+TYPED_TEST(ImageDecodeToTest, TIFF) {
+  this->RunTestDecodeTo(this->tiff_);
+}
+
+class ImageDecodeToFallbackTest : public DALITest {
+};
+
+// YCbCr goes through OpenCV, into the output allocated for the shape in the JPEG header.
+// OpenCV applies the EXIF orientation, so it has to reallocate the decoded image, which is
+// then copied to the output allocated again with the transposed shape.
+TEST_F(ImageDecodeToFallbackTest, ExifRotatedJpeg) {
+  const int h = 40, w = 64;
+  auto jpeg = RotatedJpeg(h, w);
+
+  Tensor<CPUBackend> reference;
+  DecodeImage(jpeg.data(), jpeg.size(), 3, DALI_YCbCr, &reference);
+
+  Tensor<CPUBackend> out;
+  std::vector<Image::Shape> allocations;
+  auto img = ImageFactory::CreateImage(jpeg.data(), jpeg.size(), DALI_YCbCr);
+  auto shape = img->DecodeTo([&](const Image::Shape &shape) {
+    allocations.push_back(shape);
+    out.Resize(shape);
+    return out.mutable_data<uint8_t>();
+  });
+
+  ASSERT_FALSE(allocations.empty());
+  EXPECT_EQ(allocations.front(), (Image::Shape{h, w, 3}));
+  EXPECT_EQ(allocations.back(), shape);
+  ASSERT_EQ(out.shape(), reference.shape());
+  EXPECT_EQ(std::memcmp(out.data<uint8_t>(), reference.data<uint8_t>(), out.nbytes()), 0);
+}
+
+}  // namespace dali
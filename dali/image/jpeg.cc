@@ -60,6 +60,20 @@ bool get_jpeg_size(const uint8 *data, size_t data_size, int *height, int *width,
 
 std::pair<std::shared_ptr<uint8_t>, Image::Shape>
 JpegImage::DecodeImpl(DALIImageType type, const uint8 *jpeg, size_t length) const {
+#ifdef DALI_USE_JPEG_TURBO
+  std::shared_ptr<uint8_t> decoded_image;
+  auto shape = DecodeToImpl(type, jpeg, length, [&decoded_image](const Shape &shape) {
+    decoded_image.reset(new uint8_t[volume(shape)], [](uint8_t* data){ delete [] data; });
+    return decoded_image.get();
+  });
+  return {decoded_image, shape};
+#else  // DALI_USE_JPEG_TURBO
+  return GenericImage::DecodeImpl(type, jpeg, length);
+#endif  // DALI_USE_JPEG_TURBO
+}
+
+Image::Shape JpegImage::DecodeToImpl(DALIImageType type, const uint8 *jpeg, size_t length,
+                                     const OutputAllocator &get_output) const {
   const int c = IsColor(type) ? 3 : 1;
   const auto shape = PeekShapeImpl(jpeg, length);
   const auto h = shape[0];
@@ -73,7 +87,7 @@ JpegImage::DecodeImpl(DALIImageType type, const uint8 *jpeg, size_t length) cons
 #ifdef DALI_USE_JPEG_TURBO
   // not supported by libjpeg-turbo
   if (type == DALI_YCbCr) {
-    return GenericImage::DecodeImpl(type, jpeg, length);
+    return GenericImage::DecodeToImpl(type, jpeg, length, get_output);
   }
 
   jpeg::UncompressFlags flags;
@@ -99,28 +113,24 @@ JpegImage::DecodeImpl(DALIImageType type, const uint8 *jpeg, size_t length) cons
                "Color space not supported by libjpeg-turbo");
   flags.color_space = type;
 
-  std::shared_ptr<uint8_t> decoded_image;
   int cropped_h = 0;
   int cropped_w = 0;
   uint8_t* result = jpeg::Uncompress(
     jpeg, length, flags, nullptr /* nwarn */,
-    [&decoded_image, &cropped_h, &cropped_w](int width, int height, int channels) -> uint8* {
-      decoded_image.reset(
-        new uint8_t[height * width * channels],
-        [](uint8_t* data){ delete [] data; } );
+    [&get_output, &cropped_h, &cropped_w](int width, int height, int channels) -> uint8* {
       cropped_h = height;
       cropped_w = width;
-      return decoded_image.get();
+      return get_output({height, width, channels});
     });
 
   if (result == nullptr) {
     // Failed to decode, fallback
-    return GenericImage::DecodeImpl(type, jpeg, length);
+    return GenericImage::DecodeToImpl(type, jpeg, length, get_output);
   }
 
-  return {decoded_image, {cropped_h, cropped_w, c}};
+  return {cropped_h, cropped_w, c};
 #else  // DALI_USE_JPEG_TURBO
-  return GenericImage::DecodeImpl(type, jpeg, length);
+  return GenericImage::DecodeToImpl(type, jpeg, length, get_output);
 #endif  // DALI_USE_JPEG_TURBO
 }
 
@@ -36,6 +36,12 @@ class JpegImage final : public GenericImage {
   DecodeImpl(DALIImageType image_type, const uint8_t *encoded_buffer, size_t length) const override;
 
   Shape PeekShapeImpl(const uint8_t *encoded_buffer, size_t length) const override;
+
+  /**
+   * libjpeg-turbo writes the rows straight into the output
+   */
+  Shape DecodeToImpl(DALIImageType image_type, const uint8_t *encoded_buffer, size_t length,
+                     const OutputAllocator &get_output) const override;
 };
 
 }  // namespace dali
@@ -30,4 +30,8 @@ TYPED_TEST(JpegDecodeTest, DecodeJPEGHost) {
   this->RunTestDecode(this->jpegs_);
 }
 
+TYPED_TEST(JpegDecodeTest, DecodeJPEGHostToOutput) {
+  this->RunTestDecodeTo(this->jpegs_);
+}
+
 }  // namespace dali
@@ -270,9 +270,22 @@ std::pair<std::shared_ptr<uint8_t>, Image::Shape>
 TiffImage_Libtiff::DecodeImpl(DALIImageType image_type,
                               const uint8 *encoded_buffer,
                               size_t length) const {
+  std::shared_ptr<uint8_t> decoded_img_ptr;
+  auto decoded_shape = DecodeToImpl(image_type, encoded_buffer, length,
+    [&decoded_img_ptr](const Image::Shape &shape) {
+      decoded_img_ptr.reset(new uint8_t[volume(shape)], [](uint8_t* ptr){ delete [] ptr; });
+      return decoded_img_ptr.get();
+    });
+  return {decoded_img_ptr, decoded_shape};
+}
+
+Image::Shape TiffImage_Libtiff::DecodeToImpl(DALIImageType image_type,
+                                             const uint8_t *encoded_buffer,
+                                             size_t length,
+                                             const OutputAllocator &get_output) const {
   if (!CanDecode(image_type)) {
     DALI_WARN("Warning: Falling back to GenericImage");
-    return GenericImage::DecodeImpl(image_type, encoded_buffer, length);
+    return GenericImage::DecodeToImpl(image_type, encoded_buffer, length, get_output);
   }
 
   const int64_t H = shape_[0], W = shape_[1], C = shape_[2];
@@ -307,11 +320,6 @@ TiffImage_Libtiff::DecodeImpl(DALIImageType image_type,
   }
 
   TensorShape<3> decoded_shape = {roi_h, roi_w, out_C};
-  const size_t decoded_size = volume(decoded_shape);
-  std::shared_ptr<uint8_t> decoded_img_ptr{
-    new uint8_t[decoded_size],
-    [](uint8_t* ptr){ delete [] ptr; }
-  };
 
   // TODO(janton): support different types in ImageDecoder
   using InType = uint8_t;
@@ -329,7 +337,7 @@ TiffImage_Libtiff::DecodeImpl(DALIImageType image_type,
 
   const int64_t out_row_stride = roi_w * out_C;
   InType * const row_in  = row_buf.get();
-  OutType * const img_out = decoded_img_ptr.get();
+  OutType * const img_out = get_output(decoded_shape);
 
   // Need to read sequentially since not all the images support random access
 
@@ -358,7 +366,7 @@ TiffImage_Libtiff::DecodeImpl(DALIImageType image_type,
     detail::ConvertLine(row_out, out_C, row_in, C, roi_x, roi_w, image_type);
   }
 
-  return {decoded_img_ptr, decoded_shape};
+  return decoded_shape;
 }
 
 bool TiffImage_Libtiff::CanDecode(DALIImageType image_type) const {
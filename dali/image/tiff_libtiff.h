@@ -35,6 +35,9 @@ class TiffImage_Libtiff : public GenericImage {
 
   Image::Shape PeekShapeImpl(const uint8_t *encoded_buffer, size_t length) const override;
 
+  Image::Shape DecodeToImpl(DALIImageType image_type, const uint8_t *encoded_buffer,
+                            size_t length, const OutputAllocator &get_output) const override;
+
  private:
   span<const uint8_t> buf_;
   size_t buf_pos_;
@@ -18,6 +18,8 @@
 #include "dali/kernels/alloc.h"
 #include "dali/core/static_switch.h"
 #include "dali/core/device_guard.h"
+#include "dali/core/host_pool.h"
+#include "dali/core/numa.h"
 
 namespace dali {
 namespace kernels {
@@ -26,14 +28,19 @@ namespace memory {
 template <AllocType>
 struct Allocator;
 
+// Goes through the host memory pool, which is a plain malloc unless the pooling is enabled
 template <>
 struct Allocator<AllocType::Host> {
   static void Deallocate(void *ptr, int device) noexcept {
     (void)device;
-    free(ptr);
+    HostMemoryPool::Instance().Deallocate(ptr);
   }
 
-  static void *Allocate(size_t bytes) noexcept { return malloc(bytes); }
+  static void *Allocate(size_t bytes) noexcept {
+    void *ptr = HostMemoryPool::Instance().Allocate(bytes);
+    numa::PlaceMemory(ptr, bytes);
+    return ptr;
+  }
 };
 
 template <>
@@ -73,13 +73,14 @@ void BrightnessContrastCpu::RunImpl(workspace_t<CPUBackend> &ws) {
               kernels::KernelContext ctx;
               auto& tp = ws.GetThreadPool();
               for (int sample_id = 0; sample_id < input.shape().num_samples(); sample_id++) {
-                tp.DoWorkWithID([&, sample_id](int thread_id) {
+                tp.AddWork([&, sample_id](int thread_id) {
                     auto tvin = view<const InputType, 3>(input[sample_id]);
                     auto tvout = view<OutputType, 3>(output[sample_id]);
                     kernel_manager_.Run<Kernel>(thread_id, sample_id, ctx, tvout, tvin,
                                                 brightness_[sample_id], contrast_[sample_id]);
-                });
+                }, volume(input[sample_id].shape()));
               }
+              tp.RunAll();
           }
       ), DALI_FAIL("Unsupported output type"))  // NOLINT
   ), DALI_FAIL("Unsupported input type"))  // NOLINT
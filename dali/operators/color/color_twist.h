@@ -185,6 +185,10 @@ class ColorTwistBase : public Operator<Backend> {
     return false;
   }
 
+  bool CanRunPerSample() const override {
+    return std::is_same<Backend, CPUBackend>::value;
+  }
+
   void RunImpl(Workspace<Backend> &ws) override;
 
   std::vector<ColorAugment*> augments_;
@@ -36,6 +36,10 @@ class ColorSpaceConversion : public Operator<Backend> {
     return false;
   }
 
+  bool CanRunPerSample() const override {
+    return std::is_same<Backend, CPUBackend>::value;
+  }
+
   void RunImpl(Workspace<Backend> &ws) override;
 
   USE_OPERATOR_MEMBERS();
@@ -36,16 +36,14 @@ void HostDecoder::RunImpl(SampleWorkspace &ws) {
     img = ImageFactory::CreateImage(input.data<uint8>(), input.size(), output_type_);
     img->SetCropWindowGenerator(GetCropWindowGenerator(ws.data_idx()));
     img->SetUseFastIdct(use_fast_idct_);
-    img->Decode();
+    img->DecodeTo([&output](const Image::Shape &shape) {
+      output.Resize(shape);
+      return output.mutable_data<uint8_t>();
+    });
   } catch (std::exception &e) {
     DALI_FAIL(e.what() + "File: " + file_name);
   }
-  const auto decoded = img->GetImage();
-  const auto shape = img->GetShape();
-  output.Resize(shape);
   output.SetLayout("HWC");
-  unsigned char *out_data = output.mutable_data<unsigned char>();
-  std::memcpy(out_data, decoded.get(), volume(shape));
 }
 
 DALI_REGISTER_OPERATOR(ImageDecoder, HostDecoder, CPU);
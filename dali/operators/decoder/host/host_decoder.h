@@ -41,6 +41,10 @@ class HostDecoder : public Operator<CPUBackend> {
     return false;
   }
 
+  bool CanRunPerSample() const override {
+    return true;
+  }
+
   void RunImpl(SampleWorkspace &ws) override;
 
   virtual CropWindowGenerator GetCropWindowGenerator(int data_idx) const {
@@ -0,0 +1,66 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include "dali/pipeline/pipeline.h"
+#include "dali/test/dali_test_decoder.h"
+
+namespace dali {
+
+class HostDecoderExifTest : public DALITest {
+};
+
+// YCbCr goes through OpenCV, which transposes the images for the EXIF orientation after
+// the output was allocated for the shape in the header, so the output is allocated again
+TEST_F(HostDecoderExifTest, RotatedJpeg) {
+  std::vector<std::vector<uint8_t>> jpegs = {RotatedJpeg(40, 64), RotatedJpeg(24, 16)};
+  const int batch_size = jpegs.size();
+  TensorList<CPUBackend> encoded;
+  TensorListShape<> shape(batch_size, 1);
+  for (int i = 0; i < batch_size; i++)
+    shape.set_tensor_shape(i, {static_cast<Index>(jpegs[i].size())});
+  encoded.mutable_data<uint8_t>();
+  encoded.Resize(shape);
+  for (int i = 0; i < batch_size; i++)
+    std::memcpy(encoded.mutable_tensor<uint8_t>(i), jpegs[i].data(), jpegs[i].size());
+
+  Pipeline pipe(batch_size, 1, 0);
+  pipe.AddExternalInput("encoded");
+  pipe.SetExternalInput("encoded", encoded);
+  pipe.AddOperator(
+      OpSpec("ImageDecoder")
+      .AddArg("device", "cpu")
+      .AddArg("output_type", DALI_YCbCr)
+      .AddInput("encoded", "cpu")
+      .AddOutput("decoded", "cpu"));
+  pipe.Build({{"decoded", "cpu"}});
+  pipe.RunCPU();
+  pipe.RunGPU();
+  DeviceWorkspace ws;
+  pipe.Outputs(&ws);
+
+  auto &decoded = ws.Output<CPUBackend>(0);
+  ASSERT_EQ(static_cast<int>(decoded.ntensor()), batch_size);
+  for (int i = 0; i < batch_size; i++) {
+    Tensor<CPUBackend> reference;
+    DecodeImage(jpegs[i].data(), jpegs[i].size(), 3, DALI_YCbCr, &reference);
+    ASSERT_EQ(decoded.tensor_shape(i), reference.shape());
+    EXPECT_EQ(std::memcmp(decoded.tensor<uint8_t>(i), reference.data<uint8_t>(),
+                          reference.nbytes()), 0);
+  }
+}
+
+}  // namespace dali
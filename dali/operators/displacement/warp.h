@@ -171,7 +171,7 @@ class WarpOpImpl : public OpImplInterface<Backend> {
             param_provider_->Border());
       });
     }
-    pool.WaitForWork(true);
+    pool.RunAll();
   }
 
   void RunBackend(DeviceWorkspace &ws) {
@@ -128,6 +128,10 @@ class CropMirrorNormalize : public Operator<Backend>, protected CropAttr {
     return true;
   }
 
+  bool CanRunPerSample() const override {
+    return std::is_same<Backend, CPUBackend>::value;
+  }
+
   // Propagate input -> output type and layout
   // Gather the CropAttr (obtain arguments from Spec/ArgumentWorkspace)
   void SetupAndInitialize(const workspace_t<Backend> &ws) {
@@ -89,7 +89,7 @@ void CopyOutputData(TensorVector<CPUBackend> &output, std::vector<DLMTensorPtr>
       CopyDlTensor<CPUBackend>(output[i].raw_mutable_data(), dl_tensors[i]);
     });
   }
-  thread_pool.WaitForWork();
+  thread_pool.RunAll();
 }
 
 template <>
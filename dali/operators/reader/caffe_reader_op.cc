@@ -25,6 +25,16 @@ DALI_SCHEMA(CaffeReader)
   .AddArg("path",
       R"code(List of paths to Caffe LMDB directories.)code",
       DALI_STRING_VEC)
+  .AddOptionalArg("key_index",
+      R"code(Build an index of all the keys when the database is opened, so any entry can be reached
+directly, instead of moving the cursor one entry at a time. Speeds up the start of shards other than
+the first one and `stick_to_shard` wrap-arounds for big databases.)code", false)
+  .AddOptionalArg("persist_key_index",
+      R"code(Like `key_index`, but the index is also saved next to the database (if the directory
+is writable) and reused by the following runs, as long as the database doesn't change.)code", false)
+  .AddOptionalArg("zero_copy",
+      R"code(Don't copy the entries out of the database, the samples point directly to the memory
+mapped database instead. The database stays open as long as any sample refers to it.)code", false)
   .AddParent("LoaderBase");
 
 }  // namespace dali
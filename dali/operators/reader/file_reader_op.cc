@@ -34,6 +34,16 @@ directories with images in them. To obtain labels `FileReader` sorts directories
       R"code(Path to the file with a list of pairs ``file label``
 (leave empty to traverse the `file_root` directory to obtain files and labels))code",
       std::string())
+  .AddOptionalArg("file_list_cache",
+      R"code(Path to a file caching the result of the `file_root` traversal. If the file exists and
+neither `file_root` nor any of its class directories were modified since it was written, the files
+and labels are read from it and the directories are not traversed. Otherwise the directories are
+traversed and the result is saved there. Ignored when `file_list` is used.)code",
+      std::string())
+  .AddOptionalArg("num_traversal_threads",
+      R"code(Number of threads reading the class directories of `file_root` concurrently at startup.
+Ignored when `file_list` is used.)code",
+      8)
 .AddOptionalArg("shuffle_after_epoch",
       R"code(If true, reader shuffles whole dataset after each epoch. It is exclusive with
 `stick_to_shard` and `random_shuffle`.)code",
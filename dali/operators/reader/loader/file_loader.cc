@@ -14,24 +14,68 @@
 
 #include <dirent.h>
 #include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "dali/core/common.h"
 #include "dali/image/image.h"
 #include "dali/operators/reader/loader/file_loader.h"
+#include "dali/pipeline/util/thread_pool.h"
 #include "dali/util/file.h"
 
 namespace dali {
 
-inline void assemble_file_list(const std::string& path, const std::string& curr_entry, int label,
+namespace {
+
+constexpr const char kFileListCacheHeader[] = "# DALI file list cache v1";
+
+struct DirStamp {
+  std::string name;
+  int64_t sec, nsec;
+};
+
+DirStamp GetDirStamp(const std::string &file_root, const std::string &name) {
+  std::string full_path = file_root + "/" + name;
+  struct stat s;
+  DALI_ENFORCE(stat(full_path.c_str(), &s) == 0,
+      "Could not access " + full_path + " during directory traversal.");
+  return {name, static_cast<int64_t>(s.st_mtim.tv_sec), static_cast<int64_t>(s.st_mtim.tv_nsec)};
+}
+
+// Runs `func(i)` for i in [0, n) on `num_threads` threads
+template <typename Func>
+void ParallelFor(int n, int num_threads, Func &&func) {
+  num_threads = std::min(num_threads, n);
+  if (num_threads <= 1) {
+    for (int i = 0; i < n; i++)
+      func(i);
+    return;
+  }
+  // readdir and stat don't need any CUDA context, hence no device id
+  ThreadPool pool(num_threads, -1, false);
+  for (int i = 0; i < n; i++)
+    pool.DoWorkWithID([&func, i](int) { func(i); });
+  pool.WaitForWork();
+}
+
+void assemble_file_list(const std::string& path, const std::string& curr_entry, int label,
                         std::vector<std::pair<std::string, int>> *file_label_pairs) {
   std::string curr_dir_path = path + "/" + curr_entry;
   DIR *dir = opendir(curr_dir_path.c_str());
+  DALI_ENFORCE(dir != nullptr,
+      "Directory " + curr_dir_path + " could not be opened.");
 
   struct dirent *entry;
 
   while ((entry = readdir(dir))) {
-    std::string full_path = curr_dir_path + "/" + std::string{entry->d_name};
 #ifdef _DIRENT_HAVE_D_TYPE
     /*
      * we support only regular files and symlinks, if FS returns DT_UNKNOWN
@@ -50,42 +94,171 @@ inline void assemble_file_list(const std::string& path, const std::string& curr_
   closedir(dir);
 }
 
-vector<std::pair<string, int>> filesystem::traverse_directories(const std::string& file_root) {
-  // open the root
+// Lists the class directories of `file_root`, sorted
+std::vector<std::string> list_class_dirs(const std::string& file_root, int num_threads) {
   DIR *dir = opendir(file_root.c_str());
 
   DALI_ENFORCE(dir != nullptr,
       "Directory " + file_root + " could not be opened.");
 
   struct dirent *entry;
-
-  std::vector<std::pair<std::string, int>> file_label_pairs;
   std::vector<std::string> entry_name_list;
+  // entries which type is not known from readdir and need a stat
+  std::vector<std::string> unknown_entries;
 
   while ((entry = readdir(dir))) {
-    struct stat s;
-    std::string entry_name(entry->d_name);
-    std::string full_path = file_root + "/" + entry_name;
-    int ret = stat(full_path.c_str(), &s);
-    DALI_ENFORCE(ret == 0,
-        "Could not access " + full_path + " during directory traversal.");
     if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
-    if (S_ISDIR(s.st_mode)) {
-      entry_name_list.push_back(entry_name);
+#ifdef _DIRENT_HAVE_D_TYPE
+    if (entry->d_type == DT_DIR) {
+      entry_name_list.push_back(entry->d_name);
+      continue;
+    } else if (entry->d_type != DT_LNK && entry->d_type != DT_UNKNOWN) {
+      continue;
     }
+#endif
+    unknown_entries.push_back(entry->d_name);
+  }
+  closedir(dir);
+
+  std::vector<char> is_dir(unknown_entries.size(), 0);
+  ParallelFor(unknown_entries.size(), num_threads, [&](int i) {
+    struct stat s;
+    std::string full_path = file_root + "/" + unknown_entries[i];
+    DALI_ENFORCE(stat(full_path.c_str(), &s) == 0,
+        "Could not access " + full_path + " during directory traversal.");
+    is_dir[i] = S_ISDIR(s.st_mode);
+  });
+  for (size_t i = 0; i < unknown_entries.size(); i++) {
+    if (is_dir[i])
+      entry_name_list.push_back(std::move(unknown_entries[i]));
   }
+
   // sort directories to preserve class alphabetic order, as readdir could
   // return unordered dir list. Otherwise file reader for training and validation
   // could return directories with the same names in completely different order
   std::sort(entry_name_list.begin(), entry_name_list.end());
-  for (unsigned dir_count = 0; dir_count < entry_name_list.size(); ++dir_count) {
-      assemble_file_list(file_root, entry_name_list[dir_count], dir_count, &file_label_pairs);
+  return entry_name_list;
+}
+
+/*
+ * The cache stores the modification time of `file_root` and of every class directory.
+ * Adding, removing or renaming a file or a class directory changes the mtime of its parent,
+ * so checking them is enough to tell whether the listing is still valid, without reading
+ * the directories.
+ */
+bool read_file_list_cache(const std::string &cache_path, const std::string &file_root,
+                          int num_threads, std::vector<std::pair<std::string, int>> *out) {
+  std::ifstream s(cache_path);
+  if (!s.is_open())
+    return false;
+
+  std::string line;
+  if (!std::getline(s, line) || line != kFileListCacheHeader)
+    return false;
+  if (!std::getline(s, line) || line != file_root)
+    return false;
+
+  size_t num_dirs = 0;
+  if (!(s >> num_dirs))
+    return false;
+  std::vector<DirStamp> stamps(num_dirs);
+  for (auto &stamp : stamps) {
+    if (!(s >> stamp.sec >> stamp.nsec) || s.get() != ' ' || !std::getline(s, stamp.name))
+      return false;
   }
+
+  // the first entry is the root itself, the class directories follow
+  std::vector<char> valid(num_dirs, 0);
+  ParallelFor(num_dirs, num_threads, [&](int i) {
+    struct stat st;
+    std::string full_path = file_root + "/" + stamps[i].name;
+    valid[i] = stat(full_path.c_str(), &st) == 0 &&
+               st.st_mtim.tv_sec == stamps[i].sec && st.st_mtim.tv_nsec == stamps[i].nsec;
+  });
+  if (num_dirs == 0 || !std::all_of(valid.begin(), valid.end(), [](char v) { return v; }))
+    return false;
+
+  size_t num_files = 0;
+  if (!(s >> num_files))
+    return false;
+  std::vector<std::pair<std::string, int>> file_label_pairs(num_files);
+  for (auto &p : file_label_pairs) {
+    if (!(s >> p.second) || s.get() != ' ' || !std::getline(s, p.first))
+      return false;
+  }
+  *out = std::move(file_label_pairs);
+  return true;
+}
+
+void write_file_list_cache(const std::string &cache_path, const std::string &file_root,
+                           const std::vector<DirStamp> &stamps,
+                           const std::vector<std::pair<std::string, int>> &file_label_pairs) {
+  // write to a temporary file first, so concurrent jobs never see a partial cache
+  std::string tmp_path = cache_path + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream s(tmp_path);
+    if (!s.is_open()) {
+      DALI_WARN("Could not write the file list cache to " + cache_path);
+      return;
+    }
+    s << kFileListCacheHeader << "\n" << file_root << "\n" << stamps.size() << "\n";
+    for (auto &stamp : stamps)
+      s << stamp.sec << " " << stamp.nsec << " " << stamp.name << "\n";
+    s << file_label_pairs.size() << "\n";
+    for (auto &p : file_label_pairs)
+      s << p.second << " " << p.first << "\n";
+    if (!s.good()) {
+      DALI_WARN("Could not write the file list cache to " + cache_path);
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), cache_path.c_str()) != 0)
+    std::remove(tmp_path.c_str());
+}
+
+}  // namespace
+
+vector<std::pair<string, int>> filesystem::traverse_directories(const std::string& file_root,
+                                                                int num_threads,
+                                                                const std::string& cache_path) {
+  std::vector<std::pair<std::string, int>> file_label_pairs;
+  if (!cache_path.empty() &&
+      read_file_list_cache(cache_path, file_root, num_threads, &file_label_pairs)) {
+    printf("read %lu files from the file list cache %s\n", file_label_pairs.size(),
+           cache_path.c_str());
+    return file_label_pairs;
+  }
+
+  // take the mtime of the root before listing it, so any concurrent change invalidates the cache
+  std::vector<DirStamp> stamps;
+  if (!cache_path.empty())
+    stamps.push_back(GetDirStamp(file_root, "."));
+
+  auto entry_name_list = list_class_dirs(file_root, num_threads);
+  if (!cache_path.empty())
+    stamps.resize(entry_name_list.size() + 1);
+
+  // one task per class directory, each filling its own list
+  std::vector<std::vector<std::pair<std::string, int>>> dir_files(entry_name_list.size());
+  ParallelFor(entry_name_list.size(), num_threads, [&](int dir_idx) {
+    if (!cache_path.empty())
+      stamps[dir_idx + 1] = GetDirStamp(file_root, entry_name_list[dir_idx]);
+    assemble_file_list(file_root, entry_name_list[dir_idx], dir_idx, &dir_files[dir_idx]);
+  });
+
+  size_t total = 0;
+  for (auto &files : dir_files)
+    total += files.size();
+  file_label_pairs.reserve(total);
+  for (auto &files : dir_files)
+    file_label_pairs.insert(file_label_pairs.end(), files.begin(), files.end());
   // sort file names as well
   std::sort(file_label_pairs.begin(), file_label_pairs.end());
   printf("read %lu files from %lu directories\n", file_label_pairs.size(), entry_name_list.size());
 
-  closedir(dir);
+  if (!cache_path.empty())
+    write_file_list_cache(cache_path, file_root, stamps, file_label_pairs);
 
   return file_label_pairs;
 }
@@ -95,7 +268,11 @@ void FileLoader::PrepareEmpty(ImageLabelWrapper &image_label) {
 }
 
 void FileLoader::ReadSample(ImageLabelWrapper &image_label) {
-  auto image_pair = image_label_pairs_[current_index_++];
+  ReadSampleSync(image_label);
+}
+
+FileLoader::ReadWork FileLoader::PrepareReadSample(ImageLabelWrapper &image_label) {
+  auto image_pair = image_label_pairs_[ShuffledIndex(current_index_++)];
 
   // handle wrap-around
   MoveToNextShard(current_index_);
@@ -113,32 +290,55 @@ void FileLoader::ReadSample(ImageLabelWrapper &image_label) {
     image_label.image.SetMeta(meta);
     image_label.image.set_type(TypeInfo::Create<uint8_t>());
     image_label.image.Resize({0});
-    return;
+    return {};
+  }
+
+  std::string path = file_root_ + "/" + image_pair.first;
+  if (ReadFromSampleCache(path, image_label.image)) {
+    image_label.image.SetMeta(meta);
+    return {};
   }
+  if (io_backend_ != IOBackend::MMAP) {
+    return [this, &image_label, path, meta]() {
+      auto &image = image_label.image;
+      Index image_size = BatchFileReader::FileSize(path);
+      if (image.shares_data()) {
+        image.Reset();
+      }
+      image.set_type(TypeInfo::Create<uint8_t>());
+      image.Resize({image_size});
+      GetBatchFileReader().Enqueue(path, 0, image_size, image.mutable_data<uint8_t>());
+      image.SetMeta(meta);
+      AddToSampleCache(path, image);
+    };
+  }
+  return [this, &image_label, path, meta]() {
+    ReadImage(image_label.image, path);
+    image_label.image.SetMeta(meta);
+    AddToSampleCache(path, image_label.image);
+  };
+}
 
-  auto current_image = FileStream::Open(file_root_ + "/" + image_pair.first, read_ahead_);
+void FileLoader::ReadImage(Tensor<CPUBackend> &image, const std::string &path) {
+  auto current_image = FileStream::Open(path, read_ahead_);
   Index image_size = current_image->Size();
 
   if (copy_read_data_) {
-    if (image_label.image.shares_data()) {
-      image_label.image.Reset();
+    if (image.shares_data()) {
+      image.Reset();
     }
-    image_label.image.Resize({image_size});
+    image.Resize({image_size});
     // copy the image
-    current_image->Read(image_label.image.mutable_data<uint8_t>(), image_size);
+    current_image->Read(image.mutable_data<uint8_t>(), image_size);
   } else {
     auto p = current_image->Get(image_size);
     // Wrap the raw data in the Tensor object.
-    image_label.image.ShareData(p, image_size, {image_size});
-    image_label.image.set_type(TypeInfo::Create<uint8_t>());
+    image.ShareData(p, image_size, {image_size});
+    image.set_type(TypeInfo::Create<uint8_t>());
   }
 
   // close the file handle
   current_image->Close();
-
-  // copy the label
-  image_label.label = image_pair.second;
-  image_label.image.SetMeta(meta);
 }
 
 Index FileLoader::SizeImpl() {
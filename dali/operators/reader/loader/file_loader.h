@@ -34,7 +34,17 @@ namespace dali {
 
 namespace filesystem {
 
-vector<std::pair<string, int>> traverse_directories(const std::string& path);
+/**
+ * @brief Lists the images in the class directories of `path`, labeled by the index
+ *        of their directory in alphabetical order.
+ *
+ * The class directories are read by `num_threads` threads. If `cache_path` is given and holds
+ * a listing of `path` which is still up to date, the listing is taken from there; otherwise
+ * the directories are read and the listing is saved to `cache_path`.
+ */
+vector<std::pair<string, int>> traverse_directories(const std::string& path,
+                                                    int num_threads = 1,
+                                                    const std::string& cache_path = "");
 
 }  // namespace filesystem
 
@@ -43,6 +53,10 @@ struct ImageLabelWrapper {
   int label;
 };
 
+inline size_t LoadTargetBytes(const ImageLabelWrapper &target) {
+  return target.image.nbytes();
+}
+
 class FileLoader : public Loader<CPUBackend, ImageLabelWrapper> {
  public:
   explicit inline FileLoader(
@@ -52,6 +66,11 @@ class FileLoader : public Loader<CPUBackend, ImageLabelWrapper> {
     : Loader<CPUBackend, ImageLabelWrapper>(spec),
       file_root_(spec.GetArgument<string>("file_root")),
       file_list_(spec.GetArgument<string>("file_list")),
+      // readers reusing FileLoader with their own listing, like COCOReader, don't have these
+      file_list_cache_(spec.GetSchema().HasArgument("file_list_cache")
+                       ? spec.GetArgument<string>("file_list_cache") : ""),
+      num_traversal_threads_(spec.GetSchema().HasArgument("num_traversal_threads")
+                             ? spec.GetArgument<int>("num_traversal_threads") : 1),
       image_label_pairs_(std::move(image_label_pairs)),
       shuffle_after_epoch_(shuffle_after_epoch),
       current_index_(0),
@@ -62,6 +81,8 @@ class FileLoader : public Loader<CPUBackend, ImageLabelWrapper> {
       * Still when `shuffle_after_epoch` we will set `stick_to_shard` internally in the FileLoader so all
       * DALI instances will do shuffling after each epoch
       */
+      DALI_ENFORCE(!shuffle_after_epoch_ || shuffle_block_size_ == 0,
+          "shuffle_after_epoch and shuffle_block_size cannot be both set");
       if (shuffle_after_epoch_ || stick_to_shard_)
         DALI_ENFORCE(
           !shuffle_after_epoch_ || !stick_to_shard_,
@@ -83,14 +104,24 @@ class FileLoader : public Loader<CPUBackend, ImageLabelWrapper> {
 
   void PrepareEmpty(ImageLabelWrapper &tensor) override;
   void ReadSample(ImageLabelWrapper &tensor) override;
+  ReadWork PrepareReadSample(ImageLabelWrapper &tensor) override;
+
+  // With `shuffle_after_epoch` the order of the files depends on all the previous epochs
+  bool SupportsCheckpointing() const override {
+    return !shuffle_after_epoch_;
+  }
 
  protected:
   Index SizeImpl() override;
 
+  // Reads the whole file under `path` into `image`, safe to call from the I/O threads
+  void ReadImage(Tensor<CPUBackend> &image, const std::string &path);
+
   void PrepareMetadataImpl() override {
     if (image_label_pairs_.empty()) {
       if (file_list_ == "") {
-        image_label_pairs_ = filesystem::traverse_directories(file_root_);
+        image_label_pairs_ = filesystem::traverse_directories(file_root_, num_traversal_threads_,
+                                                              file_list_cache_);
       } else {
         // load (path, label) pairs from list
         std::ifstream s(file_list_);
@@ -107,7 +138,8 @@ class FileLoader : public Loader<CPUBackend, ImageLabelWrapper> {
     }
     DALI_ENFORCE(Size() > 0, "No files found.");
 
-    if (shuffle_) {
+    // the block shuffle keeps the files of a block together
+    if (shuffle_ && shuffle_block_size_ == 0) {
       // seeded with hardcoded value to get
       // the same sequence on every shard
       std::mt19937 g(524287);
@@ -116,6 +148,14 @@ class FileLoader : public Loader<CPUBackend, ImageLabelWrapper> {
     Reset(true);
   }
 
+  Index Tell() const override {
+    return current_index_;
+  }
+
+  void Seek(Index position) override {
+    current_index_ = position;
+  }
+
   void Reset(bool wrap_to_shard) override {
     if (wrap_to_shard) {
       current_index_ = start_index(shard_id_, num_shards_, Size());
@@ -124,6 +164,7 @@ class FileLoader : public Loader<CPUBackend, ImageLabelWrapper> {
     }
 
     current_epoch_++;
+    ShuffleBlocks();
 
     if (shuffle_after_epoch_) {
       std::mt19937 g(524287 + current_epoch_);
@@ -133,8 +174,11 @@ class FileLoader : public Loader<CPUBackend, ImageLabelWrapper> {
 
   using Loader<CPUBackend, ImageLabelWrapper>::shard_id_;
   using Loader<CPUBackend, ImageLabelWrapper>::num_shards_;
+  using Loader<CPUBackend, ImageLabelWrapper>::shuffle_block_size_;
 
   string file_root_, file_list_;
+  string file_list_cache_;
+  int num_traversal_threads_;
   vector<std::pair<string, int>> image_label_pairs_;
   bool shuffle_after_epoch_;
   Index current_index_;
@@ -23,6 +23,7 @@
 
 #include "dali/core/common.h"
 #include "dali/operators/reader/loader/loader.h"
+#include "dali/operators/reader/loader/sample_index.h"
 #include "dali/util/file.h"
 
 namespace dali {
@@ -37,60 +38,87 @@ class IndexedFileLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
     }
 
   void ReadSample(Tensor<CPUBackend>& tensor) override {
+    if (ReadsInBatches()) {
+      ReadSampleSync(tensor);
+      return;
+    }
     MoveToNextShard(current_index_);
 
     int64 seek_pos, size;
     size_t file_index;
-    std::tie(seek_pos, size, file_index) = indices_[current_index_];
+    size_t sample_idx = ShuffledIndex(current_index_);
+    std::tie(seek_pos, size, file_index) = indices_[sample_idx];
     ++current_index_;
 
-    std::string image_key = uris_[file_index] + " at index " + to_string(seek_pos);
-    DALIMeta meta;
-    meta.SetSourceInfo(image_key);
-    meta.SetSkipSample(false);
-
-    if (file_index != current_file_index_) {
-      current_file_->Close();
-      current_file_ = FileStream::Open(uris_[file_index], read_ahead_);
-      current_file_index_ = file_index;
+    SwitchFile(file_index);
+    // jump to another block of the block shuffle
+    if (sample_idx != next_sample_idx_) {
+      should_seek_ = true;
     }
+    next_sample_idx_ = sample_idx + 1;
 
-    // if image is cached, skip loading
-    if (ShouldSkipImage(image_key)) {
-      meta.SetSkipSample(true);
+    DALIMeta meta;
+    if (!PrepareSampleMeta(tensor, seek_pos, file_index, meta)) {
       should_seek_ = true;
-      tensor.Reset();
-      tensor.SetMeta(meta);
-      tensor.set_type(TypeInfo::Create<uint8_t>());
-      tensor.Resize({0});
       return;
     }
+    std::string image_key = meta.GetSourceInfo();
 
     if (should_seek_) {
       current_file_->Seek(seek_pos);
       should_seek_ = false;
     }
 
-    if (!copy_read_data_) {
-      auto p = current_file_->Get(size);
-      DALI_ENFORCE(p != nullptr, "Error reading from a file " + uris_[current_file_index_]);
-      // Wrap the raw data in the Tensor object.
-      tensor.ShareData(p, size, {size});
-      tensor.set_type(TypeInfo::Create<uint8_t>());
-    } else {
+    ReadFromStream(*current_file_, tensor, size, uris_[current_file_index_]);
+
+    tensor.SetMeta(meta);
+    AddToSampleCache(image_key, tensor);
+    return;
+  }
+
+  ReadWork PrepareReadSample(Tensor<CPUBackend>& tensor) override {
+    if (!ReadsInBatches() && copy_read_data_) {
+      // Without shared mappings every stream would map and unmap the file again,
+      // which is slower than reading the samples sequentially from the current file
+      ReadSample(tensor);
+      return {};
+    }
+    MoveToNextShard(current_index_);
+
+    int64 seek_pos, size;
+    size_t file_index;
+    std::tie(seek_pos, size, file_index) = indices_[ShuffledIndex(current_index_)];
+    ++current_index_;
+
+    DALIMeta meta;
+    if (!PrepareSampleMeta(tensor, seek_pos, file_index, meta)) {
+      return {};
+    }
+    std::string image_key = meta.GetSourceInfo();
+
+    if (ReadsInBatches()) {
       if (tensor.shares_data()) {
         tensor.Reset();
       }
       tensor.set_type(TypeInfo::Create<uint8_t>());
       tensor.Resize({size});
-
-      int64 n_read = current_file_->Read(reinterpret_cast<uint8_t*>(tensor.raw_mutable_data()),
-                          size);
-      DALI_ENFORCE(n_read == size, "Error reading from a file " + uris_[current_file_index_]);
+      tensor.SetMeta(meta);
+      GetBatchFileReader().Enqueue(uris_[file_index], seek_pos, size,
+                                   tensor.mutable_data<uint8_t>());
+      AddToSampleCache(image_key, tensor);
+      return {};
     }
 
-    tensor.SetMeta(meta);
-    return;
+    // Each read uses its own stream, so they don't share the position. The mappings are
+    // shared here, so opening a stream for a mapped file only takes a reference to it.
+    return [this, &tensor, seek_pos, size, file_index, meta, image_key]() {
+      auto file = OpenFile(uris_[file_index]);
+      file->Seek(seek_pos);
+      ReadFromStream(*file, tensor, size, uris_[file_index]);
+      file->Close();
+      tensor.SetMeta(meta);
+      AddToSampleCache(image_key, tensor);
+    };
   }
 
   ~IndexedFileLoader() override {
@@ -99,17 +127,15 @@ class IndexedFileLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
     }
   }
 
+  bool SupportsCheckpointing() const override {
+    return true;
+  }
+
   virtual void ReadIndexFile(const std::vector<std::string>& index_uris) {
     DALI_ENFORCE(index_uris.size() == uris_.size(),
         "Number of index files needs to match the number of data files");
     for (size_t i = 0; i < index_uris.size(); ++i) {
-      std::ifstream fin(index_uris[i]);
-      DALI_ENFORCE(fin.good(), "Failed to open file " + index_uris[i]);
-      int64 pos, size;
-      while (fin >> pos >> size) {
-        indices_.push_back(std::make_tuple(pos, size, i));
-      }
-      fin.close();
+      DALI_ENFORCE(LoadIndexFile(index_uris[i], i), "Failed to open file " + index_uris[i]);
     }
   }
 
@@ -118,6 +144,94 @@ class IndexedFileLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
     return indices_.size();
   }
 
+  /**
+   * @brief Appends the entries of the index of data file `file_index`, either memory mapping
+   *        a binary index or parsing the text one with "offset size" lines.
+   *        Returns false if the file can't be opened.
+   */
+  bool LoadIndexFile(const std::string &index_uri, size_t file_index) {
+    if (IsBinaryIndexFile(index_uri)) {
+      indices_.MapBinaryIndexFile(index_uri, file_index);
+      return true;
+    }
+    std::ifstream fin(index_uri);
+    if (!fin.good())
+      return false;
+    int64 pos, size;
+    while (fin >> pos >> size) {
+      indices_.push_back(std::make_tuple(pos, size, file_index));
+    }
+    return true;
+  }
+
+  // Makes `file_index` the current file, opening it if needed
+  void SwitchFile(size_t file_index) {
+    if (file_index != current_file_index_) {
+      if (current_file_) {
+        current_file_->Close();
+      }
+      current_file_ = OpenFile(uris_[file_index]);
+      current_file_index_ = file_index;
+    }
+  }
+
+  /**
+   * @brief Sets up the meta of the sample at `seek_pos` in data file `file_index`.
+   *        Returns false if the sample doesn't have to be read, because it is skipped
+   *        or was taken from the sample cache; the tensor is then already filled.
+   */
+  bool PrepareSampleMeta(Tensor<CPUBackend> &tensor, int64 seek_pos, size_t file_index,
+                         DALIMeta &meta) {
+    std::string image_key = uris_[file_index] + " at index " + to_string(seek_pos);
+    meta.SetSourceInfo(image_key);
+    meta.SetSkipSample(false);
+
+    // if image is cached, skip loading
+    if (ShouldSkipImage(image_key)) {
+      meta.SetSkipSample(true);
+      tensor.Reset();
+      tensor.SetMeta(meta);
+      tensor.set_type(TypeInfo::Create<uint8_t>());
+      tensor.Resize({0});
+      return false;
+    }
+
+    if (ReadFromSampleCache(image_key, tensor)) {
+      tensor.SetMeta(meta);
+      return false;
+    }
+    return true;
+  }
+
+  virtual std::unique_ptr<FileStream> OpenFile(const std::string &uri) {
+    return FileStream::Open(uri, read_ahead_);
+  }
+
+  // Whether the samples are read with the BatchFileReader instead of the FileStreams
+  virtual bool ReadsInBatches() const {
+    return io_backend_ != IOBackend::MMAP;
+  }
+
+  void ReadFromStream(FileStream &file, Tensor<CPUBackend>& tensor, int64 size,
+                      const std::string &uri) {
+    if (!copy_read_data_) {
+      auto p = file.Get(size);
+      DALI_ENFORCE(p != nullptr, "Error reading from a file " + uri);
+      // Wrap the raw data in the Tensor object.
+      tensor.ShareData(p, size, {size});
+      tensor.set_type(TypeInfo::Create<uint8_t>());
+    } else {
+      if (tensor.shares_data()) {
+        tensor.Reset();
+      }
+      tensor.set_type(TypeInfo::Create<uint8_t>());
+      tensor.Resize({size});
+
+      int64 n_read = file.Read(reinterpret_cast<uint8_t*>(tensor.raw_mutable_data()), size);
+      DALI_ENFORCE(n_read == size, "Error reading from a file " + uri);
+    }
+  }
+
   void PrepareMetadataImpl() override {
     DALI_ENFORCE(!uris_.empty(), "No files specified.");
     ReadIndexFile(index_uris_);
@@ -129,6 +243,16 @@ class IndexedFileLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
     copy_read_data_ = !mmap_reserver.CanShareMappedData();
   }
 
+  Index Tell() const override {
+    return current_index_;
+  }
+
+  // The position is looked up in the index, the file is opened and seeked in the next read
+  void Seek(Index position) override {
+    current_index_ = position;
+    next_sample_idx_ = static_cast<size_t>(-1);
+  }
+
   void Reset(bool wrap_to_shard) override {
     int64 seek_pos, size;
     size_t file_index;
@@ -137,26 +261,24 @@ class IndexedFileLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
     } else {
       current_index_ = 0;
     }
-    std::tie(seek_pos, size, file_index) = indices_[current_index_];
-    if (file_index != current_file_index_) {
-      if (current_file_index_ != static_cast<size_t>(INVALID_INDEX)) {
-        current_file_->Close();
-      }
-      current_file_ = FileStream::Open(uris_[file_index], read_ahead_);
-      current_file_index_ = file_index;
-    }
+    ShuffleBlocks();
+    next_sample_idx_ = ShuffledIndex(current_index_);
+    std::tie(seek_pos, size, file_index) = indices_[next_sample_idx_];
+    SwitchFile(file_index);
     current_file_->Seek(seek_pos);
   }
 
   std::vector<std::string> uris_;
   std::vector<std::string> index_uris_;
-  std::vector<std::tuple<int64, int64, size_t>> indices_;
+  SampleIndex indices_;
   size_t current_index_;
   size_t current_file_index_;
   std::unique_ptr<FileStream> current_file_;
   FileStream::FileStreamMappinReserver mmap_reserver;
   static constexpr int INVALID_INDEX = -1;
   bool should_seek_ = false;
+  // index of the sample following the last one read through current_file_
+  size_t next_sample_idx_ = 0;
 };
 
 }  // namespace dali
@@ -16,6 +16,11 @@
 #define DALI_OPERATORS_READER_LOADER_LMDB_H_
 
 #include <lmdb.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <vector>
@@ -37,22 +42,193 @@ class IndexedLMDB {
   MDB_cursor* mdb_cursor_ = nullptr;
   MDB_dbi mdb_dbi_;
   MDB_txn* mdb_transaction_ = nullptr;
+  // Owns the read transaction and the environment. The values returned by the cursor point
+  // into the transaction's mapping, so the samples sharing them hold a reference to it
+  // and the database is closed only when the last of them is released.
+  std::shared_ptr<void> mdb_mapping_;
   int num_;
   Index mdb_index_;
   std::string db_path_;
   Index mdb_size_;
 
+  // Keys of all entries, in the database order, used to jump to any index with MDB_SET_KEY.
+  // The keys are stored back to back in key_data_, key i spans [key_offsets_[i], key_offsets_[i+1])
+  std::vector<char> key_data_;
+  std::vector<uint64_t> key_offsets_;
+
+  static const char *KeyIndexMagic() { return "DALIKIDX"; }
+  static constexpr uint64_t kKeyIndexVersion = 1;
+
+  struct KeyIndexHeader {
+    char magic[8];
+    uint64_t version;
+    uint64_t num_entries;
+    uint64_t key_data_size;
+    // used to detect that the index is stale
+    int64_t data_mtime;
+    uint64_t data_size;
+  };
+
+  std::string KeyIndexPath() const {
+    return db_path_ + "/data.mdb.dali_key_index";
+  }
+
+  KeyIndexHeader MakeKeyIndexHeader() const {
+    KeyIndexHeader header;
+    std::memcpy(header.magic, KeyIndexMagic(), sizeof(header.magic));
+    header.version = kKeyIndexVersion;
+    header.num_entries = mdb_size_;
+    header.key_data_size = key_data_.size();
+    struct stat s;
+    if (stat((db_path_ + "/data.mdb").c_str(), &s) == 0) {
+      header.data_mtime = s.st_mtime;
+      header.data_size = s.st_size;
+    } else {
+      header.data_mtime = -1;
+      header.data_size = 0;
+    }
+    return header;
+  }
+
+  bool LoadKeyIndex() {
+    std::ifstream f(KeyIndexPath(), std::ios::binary);
+    if (!f.good())
+      return false;
+    KeyIndexHeader header, expected = MakeKeyIndexHeader();
+    if (!f.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, KeyIndexMagic(), sizeof(header.magic)) != 0 ||
+        header.version != expected.version ||
+        header.num_entries != expected.num_entries ||
+        header.data_mtime != expected.data_mtime ||
+        header.data_size != expected.data_size) {
+      LOG_LINE << "lmdb " << num_ << " " << db_path_ << " key index is stale" << std::endl;
+      return false;
+    }
+    // the sizes come from the file, check them against it before allocating anything
+    struct stat s;
+    size_t offsets_size = (static_cast<size_t>(mdb_size_) + 1) * sizeof(uint64_t);
+    if (stat(KeyIndexPath().c_str(), &s) != 0 ||
+        static_cast<uint64_t>(s.st_size) < sizeof(header) + offsets_size ||
+        header.key_data_size != s.st_size - sizeof(header) - offsets_size) {
+      LOG_LINE << "lmdb " << num_ << " " << db_path_ << " key index is corrupted" << std::endl;
+      return false;
+    }
+    key_offsets_.resize(mdb_size_ + 1);
+    key_data_.resize(header.key_data_size);
+    if (!f.read(reinterpret_cast<char*>(key_offsets_.data()), offsets_size) ||
+        !f.read(key_data_.data(), key_data_.size()) ||
+        !ValidKeyOffsets()) {
+      LOG_LINE << "lmdb " << num_ << " " << db_path_ << " key index is corrupted" << std::endl;
+      key_offsets_.clear();
+      key_data_.clear();
+      return false;
+    }
+    return true;
+  }
+
+  // the offsets start at 0, don't decrease and end at the size of key_data_
+  bool ValidKeyOffsets() const {
+    if (key_offsets_.empty() || key_offsets_.front() != 0 ||
+        key_offsets_.back() != key_data_.size())
+      return false;
+    for (size_t i = 1; i < key_offsets_.size(); i++) {
+      if (key_offsets_[i] < key_offsets_[i - 1])
+        return false;
+    }
+    return true;
+  }
+
+  void SaveKeyIndex() {
+    // the database directory may be read-only, the index then lives only in memory
+    std::string tmp_path = KeyIndexPath() + ".tmp" + std::to_string(getpid());
+    {
+      std::ofstream f(tmp_path, std::ios::binary);
+      if (!f.good())
+        return;
+      KeyIndexHeader header = MakeKeyIndexHeader();
+      f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      f.write(reinterpret_cast<const char*>(key_offsets_.data()),
+              key_offsets_.size() * sizeof(uint64_t));
+      f.write(key_data_.data(), key_data_.size());
+      if (!f.good()) {
+        f.close();
+        std::remove(tmp_path.c_str());
+        return;
+      }
+    }
+    // rename is atomic, so the concurrently started readers never see a partial index
+    if (std::rename(tmp_path.c_str(), KeyIndexPath().c_str()) != 0)
+      std::remove(tmp_path.c_str());
+  }
+
+  void ScanKeys() {
+    TimeRange tr("[LMDB] Building key index", TimeRange::kBlue1);
+    key_offsets_.clear();
+    key_data_.clear();
+    key_offsets_.reserve(mdb_size_ + 1);
+    key_offsets_.push_back(0);
+    MDB_val key, value;
+    int status = mdb_cursor_get(mdb_cursor_, &key, &value, MDB_FIRST);
+    while (status == MDB_SUCCESS) {
+      const char *k = static_cast<const char*>(key.mv_data);
+      key_data_.insert(key_data_.end(), k, k + key.mv_size);
+      key_offsets_.push_back(key_data_.size());
+      status = mdb_cursor_get(mdb_cursor_, &key, &value, MDB_NEXT);
+    }
+    DALI_ENFORCE(status == MDB_NOTFOUND, "LMDB Error: " + string(mdb_strerror(status)) +
+                                         ", with file: " + db_path_);
+    DALI_ENFORCE(key_offsets_.size() == static_cast<size_t>(mdb_size_) + 1,
+                 "Number of keys doesn't match the number of entries in " + db_path_);
+    // go back to the position expected by SeekByIndex
+    CHECK_LMDB(mdb_cursor_get(mdb_cursor_, &key, &value, MDB_FIRST), db_path_);
+  }
+
+  void SeekByKey(Index index, MDB_val* key, MDB_val* value) {
+    key->mv_data = key_data_.data() + key_offsets_[index];
+    key->mv_size = key_offsets_[index + 1] - key_offsets_[index];
+    CHECK_LMDB(mdb_cursor_get(mdb_cursor_, key, value, MDB_SET_KEY), db_path_);
+  }
+
  public:
+  /**
+   * @brief Builds the index of all the keys, so any entry can be reached in constant number
+   *        of cursor operations. With `persist` the index is loaded from and saved next to
+   *        the database, so only the first job using the database pays for the key scan.
+   */
+  void BuildKeyIndex(bool persist) {
+    if (persist && LoadKeyIndex()) {
+      LOG_LINE << "lmdb " << num_ << " " << db_path_ << " loaded key index" << std::endl;
+      return;
+    }
+    ScanKeys();
+    if (persist) {
+      SaveKeyIndex();
+    }
+  }
+
+  bool HasKeyIndex() const {
+    return !key_offsets_.empty();
+  }
+
   void Open(const std::string& path, int num) {
     DALI_ENFORCE(mdb_env_ == nullptr, "Previous MDB environment was not closed");
     db_path_ = path;
     num_ = num;
     CHECK_LMDB(mdb_env_create(&mdb_env_), db_path_);
+    MDB_env *env = mdb_env_;
+    mdb_mapping_ = std::shared_ptr<void>(env, [](void *env) {
+      mdb_env_close(static_cast<MDB_env*>(env));
+    });
     auto mdb_flags = MDB_RDONLY | MDB_NOTLS | MDB_NOLOCK;
     CHECK_LMDB(mdb_env_open(mdb_env_, path.c_str(), mdb_flags, 0664), db_path_);
 
     // Create transaction and cursor
     CHECK_LMDB(mdb_txn_begin(mdb_env_, NULL, MDB_RDONLY, &mdb_transaction_), db_path_);
+    MDB_txn *txn = mdb_transaction_;
+    mdb_mapping_ = std::shared_ptr<void>(txn, [env](void *txn) {
+      mdb_txn_abort(static_cast<MDB_txn*>(txn));
+      mdb_env_close(env);
+    });
     CHECK_LMDB(mdb_dbi_open(mdb_transaction_, NULL, 0, &mdb_dbi_), db_path_);
     CHECK_LMDB(mdb_cursor_open(mdb_transaction_, mdb_dbi_, &mdb_cursor_), db_path_);
     MDB_stat stat;
@@ -63,6 +239,15 @@ class IndexedLMDB {
     mdb_index_ = 0;
   }
   size_t GetSize() const { return mdb_size_; }
+
+  /**
+   * @brief Returns a pointer to the memory of `value` that keeps the database mapping alive,
+   *        even after Close
+   */
+  std::shared_ptr<void> ShareValue(const MDB_val &value) const {
+    return std::shared_ptr<void>(mdb_mapping_, value.mv_data);
+  }
+
   Index GetIndex() const { return mdb_index_; }
   void SeekByIndex(Index index, MDB_val* key = nullptr, MDB_val* value = nullptr) {
     MDB_val tmp_key, tmp_value;
@@ -87,6 +272,8 @@ class IndexedLMDB {
       CHECK_LMDB(mdb_cursor_get(mdb_cursor_, key, value, MDB_PREV), db_path_);
     } else if (index == mdb_index_ + 1) {
       CHECK_LMDB(mdb_cursor_get(mdb_cursor_, key, value, MDB_NEXT), db_path_);
+    } else if (HasKeyIndex()) {
+      SeekByKey(index, key, value);
     } else if (index > mdb_index_) {
       LOG_LINE << "lmdb " << num_ << " " << db_path_
                << " exec a large step forward " << mdb_index_ << "->" << index << std::endl;
@@ -105,19 +292,16 @@ class IndexedLMDB {
   }
 
   void Close() {
+    key_data_.clear();
+    key_offsets_.clear();
     if (mdb_cursor_) {
       mdb_cursor_close(mdb_cursor_);
-      mdb_dbi_close(mdb_env_, mdb_dbi_);
       mdb_cursor_ = nullptr;
     }
-    if (mdb_transaction_) {
-      mdb_txn_abort(mdb_transaction_);
-      mdb_transaction_ = nullptr;
-    }
-    if (mdb_env_) {
-      mdb_env_close(mdb_env_);
-      mdb_env_ = nullptr;
-    }
+    // the transaction and the environment are released with the last shared value
+    mdb_transaction_ = nullptr;
+    mdb_env_ = nullptr;
+    mdb_mapping_.reset();
   }
 };
 
@@ -143,7 +327,10 @@ static int find_lower_bound(const std::vector<Index>& a, Index x) {
 class LMDBLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
  public:
   explicit LMDBLoader(const OpSpec& options)
-      : Loader(options) {
+      : Loader(options),
+        key_index_(options.GetArgument<bool>("key_index")),
+        persist_key_index_(options.GetArgument<bool>("persist_key_index")),
+        zero_copy_(options.GetArgument<bool>("zero_copy")) {
     bool ret = options.TryGetRepeatedArgument<std::string>(db_paths_, "path");
     if (!ret) {
       std::string path = options.GetArgument<std::string>("path");
@@ -157,6 +344,10 @@ class LMDBLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
     }
   }
 
+  bool SupportsCheckpointing() const override {
+    return true;
+  }
+
   void MapIndexToFile(Index index, Index& file_index, Index& local_index) {
     DALI_ENFORCE(offsets_.size() > 0);
     DALI_ENFORCE(index >= 0 && index < offsets_.back());
@@ -168,7 +359,7 @@ class LMDBLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
     // assume cursor is valid, read next, loop to start if necessary
 
     Index file_index, local_index;
-    MapIndexToFile(current_index_, file_index, local_index);
+    MapIndexToFile(ShuffledIndex(current_index_), file_index, local_index);
 
     MDB_val key, value;
     mdb_[file_index].SeekByIndex(local_index, &key, &value);
@@ -195,11 +386,32 @@ class LMDBLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
       return;
     }
 
+    if (ReadFromSampleCache(image_key, tensor)) {
+      tensor.SetMeta(meta);
+      return;
+    }
+
+    if (zero_copy_ && value.mv_size > 0) {
+      // the value stays valid as long as the read transaction is alive
+      tensor.Reset();
+      tensor.SetMeta(meta);
+      tensor.ShareData(mdb_[file_index].ShareValue(value), value.mv_size,
+                       {static_cast<Index>(value.mv_size)});
+      tensor.set_type(TypeInfo::Create<uint8_t>());
+      AddToSampleCache(image_key, tensor);
+      return;
+    }
+
+    if (tensor.shares_data()) {
+      tensor.Reset();
+      tensor.set_type(TypeInfo::Create<uint8_t>());
+    }
     tensor.SetMeta(meta);
     tensor.Resize({static_cast<Index>(value.mv_size)});
     std::memcpy(tensor.raw_mutable_data(),
                 reinterpret_cast<uint8_t*>(value.mv_data),
                 value.mv_size * sizeof(uint8_t));
+    AddToSampleCache(image_key, tensor);
   }
 
  protected:
@@ -213,11 +425,23 @@ class LMDBLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
     mdb_.resize(db_paths_.size());
     for (size_t i = 0; i < db_paths_.size(); i++) {
       mdb_[i].Open(db_paths_[i], i);
+      if (key_index_ || persist_key_index_) {
+        mdb_[i].BuildKeyIndex(persist_key_index_);
+      }
       offsets_[i + 1] = offsets_[i] + mdb_[i].GetSize();
     }
     Reset(true);
   }
 
+  Index Tell() const override {
+    return current_index_;
+  }
+
+  // The cursor is moved in the next read, with the key index if it's enabled
+  void Seek(Index position) override {
+    current_index_ = position;
+  }
+
  private:
   void Reset(bool wrap_to_shard) override {
     // work out how many entries to move forward to handle sharding
@@ -226,8 +450,9 @@ class LMDBLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
     } else {
       current_index_ = 0;
     }
+    ShuffleBlocks();
     Index file_index, local_index;
-    MapIndexToFile(current_index_, file_index, local_index);
+    MapIndexToFile(ShuffledIndex(current_index_), file_index, local_index);
 
     mdb_[file_index].SeekByIndex(local_index);
   }
@@ -242,6 +467,9 @@ class LMDBLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
 
   // options
   std::vector<std::string> db_paths_;
+  bool key_index_;
+  bool persist_key_index_;
+  bool zero_copy_;
 };
 
 };  // namespace dali
@@ -41,6 +41,17 @@ accesses.)code", false)
   .AddOptionalArg("prefetch_queue_depth",
       R"code(Specifies the number of batches prefetched by the internal Loader. To be increased when pipeline
 processing is CPU stage-bound, trading memory consumption for better interleaving with the Loader thread.)code", 1)
+  .AddOptionalArg("adaptive_prefetch",
+      R"code(If set to true, `prefetch_queue_depth` is only the initial depth of the prefetch queue.
+The depth grows, up to `max_prefetch_queue_depth`, when the pipeline waits for the reader while the
+reader has time to spare, i.e. the reads are uneven, and shrinks when the pipeline doesn't wait
+for a while, releasing the memory of the prefetched samples.)code", false)
+  .AddOptionalArg("max_prefetch_queue_depth",
+      R"code(Maximum depth of the prefetch queue when `adaptive_prefetch` is set.)code", 8)
+  .AddOptionalArg("prefetch_memory_budget",
+      R"code(Limit, in megabytes, of the memory taken by the prefetched batches when `adaptive_prefetch`
+is set. The queue doesn't grow beyond the number of batches of the biggest size seen that fit in it.
+0 means no limit other than `max_prefetch_queue_depth`.)code", 0)
   .AddOptionalArg("skip_cached_images",
       R"code(If set to true, loading data will be skipped when the sample is present in the decoder cache.
 In such case the output of the loader will be empty)code", false)
@@ -49,7 +60,49 @@ In such case the output of the loader will be empty)code", false)
 instead of in the constructor.)code", false)
   .AddOptionalArg("pad_last_batch",
       R"code(If set to true, the Loader will pad the last batch with the last image when the batch size is not aligned
-with the shard size.)code", false);
+with the shard size.)code", false)
+  .AddOptionalArg("num_io_threads",
+      R"code(Number of threads used to read the samples of a batch concurrently. The order of samples,
+sharding and padding are the same as for the sequential read. Readers that don't support
+concurrent reads ignore this argument.)code", 1)
+  .AddOptionalArg("io_backend",
+      R"code(How the files are read. `mmap` maps the files to memory and shares the mapped data
+when possible. `pread` reads all samples of a batch into the output buffers, with up to `io_queue_depth`
+reads in flight. `io_uring` is like `pread` but submits the reads through io_uring; it falls back
+to `pread` when not available. Only the FileReader, the TFRecordReader and the MXNetReader support
+backends other than `mmap`.)code",
+      std::string("mmap"))
+  .AddOptionalArg("io_queue_depth",
+      R"code(Maximum number of reads in flight for the `pread` and `io_uring` I/O backends.)code", 32)
+  .AddOptionalArg("direct_io",
+      R"code(If set to true, the files are read with O_DIRECT, bypassing the page cache. It keeps the
+page cache from being flooded by datasets much bigger than the host memory. Implies the `pread` I/O backend
+when `io_backend` is `mmap`. Supported by the FileReader, the TFRecordReader and the MXNetReader.)code", false)
+  .AddOptionalArg("shuffle_block_size",
+      R"code(If greater than 0, the data set is split into blocks of this many consecutive samples and
+every epoch reads the blocks in a new random order, while the samples within a block are read
+sequentially. Combined with `random_shuffle`, which shuffles the samples within the prefetch buffer,
+it gives a close to global shuffle with mostly sequential I/O and a much smaller `initial_fill`.
+The order of blocks is the same for all the shards, and the option implies `stick_to_shard`.
+Supported by the FileReader, the TFRecordReader, the MXNetReader, the CaffeReader and the Caffe2Reader;
+the LMDB based readers need `key_index` to jump between the blocks quickly. It's not supported
+for the compressed TFRecord files.)code", 0)
+  .AddOptionalArg("sample_cache_size",
+      R"code(Size, in megabytes, of the host memory cache of the samples read. When set, the encoded
+samples are kept in memory and the following epochs read them from the cache instead of the storage.
+Supported by the FileReader, the TFRecordReader, the MXNetReader, the CaffeReader and the Caffe2Reader.)code",
+      0)
+  .AddOptionalArg("sample_cache_name",
+      R"code(Name of the sample cache. Readers using the same name, also in different pipelines of
+the process, share one cache, which has to be created with the same size and policy. The statistics
+of the cache are available through `nvidia.dali.backend.GetSampleCacheStats(name)`.)code",
+      std::string())
+  .AddOptionalArg("sample_cache_policy",
+      R"code(How the sample cache is filled. `lru`: when full, evicts the least recently used samples.
+`fill`: adds samples until the cache is full and never evicts them. When the data set is bigger than
+the cache, `fill` gives a hit rate close to the cache size divided by the data set size,
+while `lru` evicts every sample before it is read again in the next epoch.)code",
+      std::string("lru"));
 
 size_t start_index(const size_t shard_id,
                    const size_t shard_num,
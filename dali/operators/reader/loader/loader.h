@@ -15,28 +15,53 @@
 #ifndef DALI_OPERATORS_READER_LOADER_LOADER_H_
 #define DALI_OPERATORS_READER_LOADER_LOADER_H_
 
+#include <algorithm>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <random>
+#include <sstream>
 #include <string>
 #include <type_traits>
 #include <utility>
 #include <vector>
 #include <deque>
+#include <functional>
 
 #include "dali/core/common.h"
 #include "dali/core/error_handling.h"
 #include "dali/pipeline/operator/op_spec.h"
 #include "dali/pipeline/data/tensor.h"
+#include "dali/pipeline/util/state_io.h"
+#include "dali/pipeline/util/thread_pool.h"
+#include "dali/util/batch_file_reader.h"
 #include "dali/operators/decoder/cache/image_cache_factory.h"
+#include "dali/operators/reader/loader/sample_cache.h"
 
 namespace dali {
 
 DLL_PUBLIC size_t start_index(const size_t shard_id,
                               const size_t shard_num,
                               const size_t size);
+
+/**
+ * @brief Bytes taken by the data of a loaded sample, 0 if not known.
+ *
+ * Used to estimate the memory of the prefetched batches. Loaders with custom LoadTarget
+ * types provide overloads for them.
+ */
+template <typename LoadTarget>
+size_t LoadTargetBytes(const LoadTarget &) {
+  return 0;
+}
+
+template <typename Backend>
+size_t LoadTargetBytes(const Tensor<Backend> &tensor) {
+  return tensor.nbytes();
+}
+
 /**
  * @brief Base class for Loaders, responsible for reading samples from resource of some kind
  *        into memory.
@@ -49,11 +74,15 @@ class Loader {
  public:
   using LoadTargetUniquePtr = std::unique_ptr<LoadTarget>;
   using LoadTargetSharedPtr = std::shared_ptr<LoadTarget>;
+  // Deferred part of reading a sample, executed by the I/O thread pool
+  using ReadWork = std::function<void()>;
   explicit Loader(const OpSpec& options)
     : shuffle_(options.GetArgument<bool>("random_shuffle")),
       initial_buffer_fill_(shuffle_ ? options.GetArgument<int>("initial_fill") : 1),
       initial_empty_size_(2 * options.GetArgument<int>("prefetch_queue_depth")
                           * options.GetArgument<int>("batch_size")),
+      batch_size_(options.GetArgument<int>("batch_size")),
+      adaptive_prefetch_(options.GetArgument<bool>("adaptive_prefetch")),
       tensor_init_bytes_(options.GetArgument<int>("tensor_init_bytes")),
       seed_(options.GetArgument<Index>("seed")),
       shard_id_(options.GetArgument<int>("shard_id")),
@@ -65,9 +94,31 @@ class Loader {
       lazy_init_(options.GetArgument<bool>("lazy_init")),
       loading_flag_(false),
       read_sample_counter_(0),
-      pad_last_batch_(options.GetArgument<bool>("pad_last_batch")) {
+      pad_last_batch_(options.GetArgument<bool>("pad_last_batch")),
+      num_io_threads_(options.GetArgument<int>("num_io_threads")),
+      direct_io_(options.GetArgument<bool>("direct_io")),
+      io_backend_(GetIOBackend(options, direct_io_)),
+      io_queue_depth_(options.GetArgument<int>("io_queue_depth")),
+      shuffle_block_size_(options.GetArgument<int>("shuffle_block_size")) {
+    int sample_cache_size = options.GetArgument<int>("sample_cache_size");
+    DALI_ENFORCE(sample_cache_size >= 0, "sample_cache_size can't be negative");
+    if (sample_cache_size > 0) {
+      sample_cache_ = SampleCacheRegistry::Instance().Get(
+          options.GetArgument<std::string>("sample_cache_name"),
+          static_cast<size_t>(sample_cache_size) * 1024 * 1024,
+          SampleCache::ParsePolicy(options.GetArgument<std::string>("sample_cache_policy")));
+    }
     DALI_ENFORCE(initial_empty_size_ > 0, "Batch size needs to be greater than 0");
     DALI_ENFORCE(num_shards_ > shard_id_, "num_shards needs to be greater than shard_id");
+    DALI_ENFORCE(num_io_threads_ > 0, "num_io_threads needs to be greater than 0");
+    DALI_ENFORCE(shuffle_block_size_ >= 0, "shuffle_block_size can't be negative");
+    /*
+     * Every epoch reads the blocks in a different order, so the shards of the readers are
+     * disjoint only if each reader goes through its own shard, like with `shuffle_after_epoch`
+     */
+    if (shuffle_block_size_ > 0) {
+      stick_to_shard_ = true;
+    }
     // initialize a random distribution -- this will be
     // used to pick from our sample buffer
     std::seed_seq seq({seed_});
@@ -76,6 +127,9 @@ class Loader {
   }
 
   virtual ~Loader() {
+    // make sure that no I/O work is touching the buffers that are going to be released
+    io_thread_pool_.reset();
+    batch_file_reader_.reset();
     sample_buffer_.clear();
     empty_tensors_.clear();
   }
@@ -111,6 +165,140 @@ class Loader {
 
   // Get a random read sample
   LoadTargetSharedPtr ReadOne(bool is_new_epoch) {
+    auto sample_ptr = ReadOneImpl(is_new_epoch);
+    CompletePendingReads();
+    return sample_ptr;
+  }
+
+  /**
+   * @brief Read `batch_size` samples into `batch`.
+   *
+   * The order of samples is the same as for `batch_size` consecutive calls to ReadOne,
+   * but when `num_io_threads` > 1 the actual reads of the whole batch are issued
+   * concurrently and awaited once, at the end.
+   */
+  void ReadBatch(std::vector<LoadTargetSharedPtr> &batch, int batch_size) {
+    batch.clear();
+    batch.reserve(batch_size);
+    for (int i = 0; i < batch_size; ++i) {
+      batch.push_back(ReadOneImpl(i == 0));
+    }
+    CompletePendingReads();
+  }
+
+  /**
+   * @brief Whether the loader can save its position with `SaveState` and resume from it
+   *        with `RestoreState`.
+   */
+  virtual bool SupportsCheckpointing() const {
+    return false;
+  }
+
+  /**
+   * @brief Saves the position of the loader, the state of the shuffling and the positions
+   *        of the samples in the shuffle buffer (without their data).
+   *
+   * Has to be called between the reads.
+   */
+  std::string SaveState() {
+    DALI_ENFORCE(SupportsCheckpointing(), "The loader doesn't support checkpointing");
+    StateWriter writer;
+    writer.Write<uint32_t>(kStateVersion);
+    writer.Write<Index>(initial_buffer_fill_);
+    writer.Write<Index>(shard_id_);
+    writer.Write<Index>(num_shards_);
+    writer.Write<bool>(initial_buffer_filled_);
+    if (!initial_buffer_filled_)
+      return std::move(writer.data());
+
+    writer.Write<Index>(Size());
+    std::stringstream rng;
+    rng << e_;
+    writer.Write(rng.str());
+    writer.Write(std::vector<ShardBoundaries>(shards_.begin(), shards_.end()));
+    writer.Write<Index>(read_sample_counter_);
+    writer.Write<Index>(virtual_shard_id_);
+    writer.Write(sample_positions_);
+    writer.Write(CurrentPosition());
+    writer.Write<bool>(last_sample_ptr_tmp != nullptr);
+    writer.Write(last_sample_position_);
+    return std::move(writer.data());
+  }
+
+  /**
+   * @brief Resumes reading from the state saved with `SaveState`.
+   *
+   * The loader seeks straight to the saved position. Only the samples that were
+   * in the shuffle buffer are read again, in the order of their positions.
+   * Can only be called before the first read.
+   */
+  void RestoreState(const std::string &state) {
+    DALI_ENFORCE(SupportsCheckpointing(), "The loader doesn't support checkpointing");
+    DALI_ENFORCE(!initial_buffer_filled_,
+                 "The state of the loader can only be restored before the first read");
+    StateReader reader(state);
+    DALI_ENFORCE(reader.Read<uint32_t>() == kStateVersion,
+                 "Unsupported version of the loader state");
+    DALI_ENFORCE(reader.Read<Index>() == initial_buffer_fill_ &&
+                 reader.Read<Index>() == shard_id_ &&
+                 reader.Read<Index>() == num_shards_,
+                 "The loader state was saved with different `initial_fill`, `shard_id` or "
+                 "`num_shards`");
+    if (!reader.Read<bool>())
+      return;
+
+    DALI_ENFORCE(reader.Read<Index>() == Size(),
+                 "The loader state was saved for a data set of a different size");
+    std::stringstream rng(reader.ReadString());
+    rng >> e_;
+    DALI_ENFORCE(!rng.fail(), "The loader state is corrupted");
+    auto shards = reader.ReadVector<ShardBoundaries>();
+    auto read_sample_counter = reader.Read<Index>();
+    auto virtual_shard_id = reader.Read<Index>();
+    auto sample_positions = reader.ReadVector<SamplePosition>();
+    auto current_position = reader.Read<SamplePosition>();
+    bool has_last_sample = reader.Read<bool>();
+    auto last_sample_position = reader.Read<SamplePosition>();
+    DALI_ENFORCE(reader.AtEnd() && !shards.empty() &&
+                 sample_positions.size() == static_cast<size_t>(initial_buffer_fill_),
+                 "The loader state is corrupted");
+
+    TimeRange tr("[Loader] Restoring state", TimeRange::kBlue1);
+    sample_buffer_.resize(initial_buffer_fill_);
+    // sorted, so that the file streams mostly move forward
+    std::vector<size_t> read_order(sample_positions.size());
+    std::iota(read_order.begin(), read_order.end(), 0);
+    std::sort(read_order.begin(), read_order.end(), [&](size_t a, size_t b) {
+      return std::make_pair(sample_positions[a].shuffle_epoch, sample_positions[a].index) <
+             std::make_pair(sample_positions[b].shuffle_epoch, sample_positions[b].index);
+    });
+    for (size_t i : read_order) {
+      sample_buffer_[i] = LoadTargetUniquePtr(new LoadTarget());
+      PrepareEmpty(*sample_buffer_[i]);
+      SetPosition(sample_positions[i]);
+      ScheduleRead(*sample_buffer_[i]);
+    }
+    if (has_last_sample && pad_last_batch_) {
+      auto tensor_ptr = LoadTargetUniquePtr(new LoadTarget());
+      PrepareEmpty(*tensor_ptr);
+      SetPosition(last_sample_position);
+      ScheduleRead(*tensor_ptr);
+      last_sample_ptr_tmp = std::move(tensor_ptr);
+    }
+    FillEmptyTensors();
+    CompletePendingReads();
+
+    shards_.assign(shards.begin(), shards.end());
+    read_sample_counter_ = read_sample_counter;
+    virtual_shard_id_ = virtual_shard_id;
+    sample_positions_ = std::move(sample_positions);
+    last_sample_position_ = last_sample_position;
+    SetPosition(current_position);
+    initial_buffer_filled_ = true;
+  }
+
+ private:
+  LoadTargetSharedPtr ReadOneImpl(bool is_new_epoch) {
     if (!loading_flag_) {
       PrepareMetadata();
     }
@@ -122,25 +310,21 @@ class Loader {
 
       // Read an initial number of samples to fill our
       // sample buffer
+      sample_positions_.clear();
       for (int i = 0; i < initial_buffer_fill_; ++i) {
         auto tensor_ptr = LoadTargetUniquePtr(new LoadTarget());
         PrepareEmpty(*tensor_ptr);
-        ReadSample(*tensor_ptr);
+        sample_positions_.push_back(CurrentPosition());
+        ScheduleRead(*tensor_ptr);
         IncreaseReadSampleCounter();
         sample_buffer_.push_back(std::move(tensor_ptr));
         ++shards_.back().end;
       }
 
-      // need some entries in the empty_tensors_ list
-      TimeRange tr2("[Loader] Filling empty list", TimeRange::kOrange);
-      std::lock_guard<std::mutex> lock(empty_tensors_mutex_);
-      for (int i = 0; i < initial_empty_size_; ++i) {
-        auto tensor_ptr = LoadTargetUniquePtr(new LoadTarget());
-        PrepareEmpty(*tensor_ptr);
-        empty_tensors_.push_back(std::move(tensor_ptr));
-      }
+      FillEmptyTensors();
 
       initial_buffer_filled_ = true;
+      CompletePendingReads();
     }
 
     int samples_to_choose_from = initial_buffer_fill_;
@@ -158,25 +342,37 @@ class Loader {
 
     int offset = shuffle_ ? dis(e_) : 0;
     Index idx = (shards_.front().start + offset) % sample_buffer_.size();
+    Index front_idx = shards_.front().start % sample_buffer_.size();
     LoadTargetSharedPtr sample_ptr(sample_buffer_[idx].release(),
       [this](LoadTarget* sample) {
         LoadTargetUniquePtr recycle_ptr(sample);
         RecycleTensor(std::move(recycle_ptr));
     });
-    std::swap(sample_buffer_[idx], sample_buffer_[shards_.front().start % sample_buffer_.size()]);
+    last_sample_position_ = sample_positions_[idx];
+    std::swap(sample_buffer_[idx], sample_buffer_[front_idx]);
+    std::swap(sample_positions_[idx], sample_positions_[front_idx]);
     // now grab an empty tensor, fill it and add to filled buffers
     // empty_tensors_ needs to be thread-safe w.r.t. RecycleTensor()
     // being called by multiple consumer threads
     LoadTargetUniquePtr tensor_ptr;
     {
       std::lock_guard<std::mutex> lock(empty_tensors_mutex_);
-      DALI_ENFORCE(empty_tensors_.size() > 0, "No empty tensors - did you forget to return them?");
-      tensor_ptr = std::move(empty_tensors_.back());
-      empty_tensors_.pop_back();
+      if (empty_tensors_.empty() && adaptive_prefetch_) {
+        // the prefetch queue got deeper
+        tensor_ptr = LoadTargetUniquePtr(new LoadTarget());
+        PrepareEmpty(*tensor_ptr);
+      } else {
+        DALI_ENFORCE(empty_tensors_.size() > 0,
+                     "No empty tensors - did you forget to return them?");
+        tensor_ptr = std::move(empty_tensors_.back());
+        empty_tensors_.pop_back();
+      }
     }
-    ReadSample(*tensor_ptr);
+    Index back_idx = shards_.back().end % sample_buffer_.size();
+    sample_positions_[back_idx] = CurrentPosition();
+    ScheduleRead(*tensor_ptr);
     IncreaseReadSampleCounter();
-    std::swap(sample_buffer_[shards_.back().end % sample_buffer_.size()], tensor_ptr);
+    std::swap(sample_buffer_[back_idx], tensor_ptr);
     ++shards_.back().end;
     last_sample_ptr_tmp = sample_ptr;
 
@@ -184,6 +380,70 @@ class Loader {
     return sample_ptr;
   }
 
+  // need some entries in the empty_tensors_ list
+  void FillEmptyTensors() {
+    TimeRange tr("[Loader] Filling empty list", TimeRange::kOrange);
+    std::lock_guard<std::mutex> lock(empty_tensors_mutex_);
+    for (int i = 0; i < initial_empty_size_; ++i) {
+      auto tensor_ptr = LoadTargetUniquePtr(new LoadTarget());
+      PrepareEmpty(*tensor_ptr);
+      empty_tensors_.push_back(std::move(tensor_ptr));
+    }
+  }
+
+  // Advance the loader and either read the sample right away or queue the I/O part of it
+  void ScheduleRead(LoadTarget &tensor) {
+    if (num_io_threads_ == 1 && io_backend_ == IOBackend::MMAP) {
+      ReadSample(tensor);
+      return;
+    }
+    auto work = PrepareReadSample(tensor);
+    if (work) {
+      pending_reads_.push_back(std::move(work));
+    }
+  }
+
+  // Issue all queued reads at once and wait for them
+  void CompletePendingReads() {
+    if (pending_reads_.empty() && !batch_file_reader_) {
+      FlushSampleCacheAdds();
+      return;
+    }
+    TimeRange tr("[Loader] CompletePendingReads", TimeRange::kGreen1);
+    std::vector<ReadWork> reads;
+    std::swap(reads, pending_reads_);
+    if (num_io_threads_ == 1) {
+      for (auto &work : reads) {
+        work();
+      }
+    } else if (!reads.empty()) {
+      if (!io_thread_pool_) {
+        // I/O threads don't need any CUDA context, hence no device id
+        io_thread_pool_ = std::make_unique<ThreadPool>(num_io_threads_, -1, false);
+      }
+      for (auto &work : reads) {
+        io_thread_pool_->DoWorkWithID([&work](int) { work(); });
+      }
+      io_thread_pool_->WaitForWork();
+    }
+    // the works could have queued reads in the batch file reader
+    if (batch_file_reader_) {
+      batch_file_reader_->Wait();
+    }
+    FlushSampleCacheAdds();
+  }
+
+  void FlushSampleCacheAdds() {
+    if (!sample_cache_)
+      return;
+    std::lock_guard<std::mutex> lock(sample_cache_mutex_);
+    for (auto &add : pending_cache_adds_) {
+      sample_cache_->Add(add.first, add.second->raw_data(), add.second->nbytes());
+    }
+    pending_cache_adds_.clear();
+  }
+
+ public:
   // return a tensor to the empty pile
   // called by multiple consumer threads
   void RecycleTensor(LoadTargetUniquePtr&& tensor_ptr) {
@@ -191,11 +451,38 @@ class Loader {
     empty_tensors_.push_back(std::move(tensor_ptr));
   }
 
+  // Releases the empty tensors beyond what a prefetch queue of `prefetch_depth` batches needs,
+  // called when the adaptive prefetch queue shrinks
+  void TrimEmptyTensors(int prefetch_depth) {
+    std::vector<LoadTargetUniquePtr> released;
+    {
+      std::lock_guard<std::mutex> lock(empty_tensors_mutex_);
+      size_t keep = 2 * prefetch_depth * batch_size_;
+      while (empty_tensors_.size() > keep) {
+        released.push_back(std::move(empty_tensors_.back()));
+        empty_tensors_.pop_back();
+      }
+    }
+  }
+
   // Read an actual sample from the FileStore,
   // used to populate the sample buffer for "shuffled"
   // reads.
   virtual void ReadSample(LoadTarget& tensor) = 0;
 
+  /**
+   * @brief Split variant of ReadSample used when `num_io_threads` > 1.
+   *
+   * Everything that depends on the Loader state (current index, sharding, open streams)
+   * has to be done here, in order. The returned work performs the actual read into `tensor`
+   * and may run concurrently with the works of other samples.
+   * The default implementation reads the sample right away and returns an empty work.
+   */
+  virtual ReadWork PrepareReadSample(LoadTarget& tensor) {
+    ReadSample(tensor);
+    return {};
+  }
+
   void PrepareMetadata() {
     std::lock_guard<std::mutex> l(prepare_metadata_mutex_);
     if (!loading_flag_) {
@@ -225,6 +512,52 @@ class Loader {
   // Reset reader to the first sample
   virtual void Reset(bool wrap_to_shard) = 0;
 
+  /**
+   * @brief Position of the next sample to read, in the (block shuffled) order of the epoch.
+   *
+   * Together with the block shuffle epoch it identifies the sample, so the loaders that
+   * support checkpointing can go back to it with `Seek`.
+   */
+  virtual Index Tell() const {
+    return 0;
+  }
+
+  // Makes the next read return the sample at `position`, as returned by `Tell`
+  virtual void Seek(Index position) {
+    DALI_FAIL("The loader doesn't support seeking");
+  }
+
+  /**
+   * @brief Draws a new order of the blocks of `shuffle_block_size` consecutive samples.
+   *
+   * Called by the loaders supporting the block shuffle whenever they start a new epoch.
+   * The last, incomplete block always stays at the end.
+   */
+  void ShuffleBlocks() {
+    if (shuffle_block_size_ == 0)
+      return;
+    block_order_.resize(Size() / shuffle_block_size_);
+    std::iota(block_order_.begin(), block_order_.end(), 0);
+    // seeded with hardcoded value to get the same sequence on every shard
+    std::mt19937 g(524287 + block_shuffle_epoch_++);
+    std::shuffle(block_order_.begin(), block_order_.end(), g);
+  }
+
+  /**
+   * @brief Maps the position of a sample in the epoch to its index in the data set.
+   *
+   * Samples are read sequentially within the blocks, so with the block shuffle the loaders
+   * keep most of the locality of the plain sequential read.
+   */
+  inline Index ShuffledIndex(Index idx) const {
+    if (shuffle_block_size_ == 0)
+      return idx;
+    Index block = idx / shuffle_block_size_;
+    if (block >= static_cast<Index>(block_order_.size()))
+      return idx;
+    return block_order_[block] * shuffle_block_size_ + idx % shuffle_block_size_;
+  }
+
   // Check if given reader moved to the next shard
   virtual inline bool IsNextShard(Index current_index) {
      return current_index >= Size() ||
@@ -254,6 +587,71 @@ class Loader {
     }
   }
 
+  /**
+   * @brief Returns the reader used by the loaders with `io_backend` other than mmap.
+   *
+   * The reads queued there are issued, all at once, after the read works of the batch
+   * are done, so the works only need to size the output and call Enqueue.
+   */
+  BatchFileReader &GetBatchFileReader() {
+    std::call_once(batch_file_reader_created_, [this]() {
+      batch_file_reader_ = BatchFileReader::Create(io_backend_, io_queue_depth_, direct_io_);
+    });
+    return *batch_file_reader_;
+  }
+
+  // Reads the sample right away through the split read path
+  void ReadSampleSync(LoadTarget &tensor) {
+    auto work = PrepareReadSample(tensor);
+    if (work) {
+      work();
+    }
+    if (batch_file_reader_) {
+      batch_file_reader_->Wait();
+    }
+    FlushSampleCacheAdds();
+  }
+
+  /**
+   * @brief Shares the cached copy of the sample `key` with `tensor`.
+   *        Returns false if the sample isn't cached or the cache is disabled.
+   *
+   * The metadata of `tensor` has to be set after this call.
+   */
+  bool ReadFromSampleCache(const std::string &key, Tensor<CPUBackend> &tensor) {
+    if (!sample_cache_)
+      return false;
+    size_t size = 0;
+    auto data = sample_cache_->Get(key, size);
+    if (!data)
+      return false;
+    tensor.Reset();
+    // the cached data is never written, the outputs only read it
+    tensor.ShareData(std::const_pointer_cast<uint8_t>(data), size, {static_cast<Index>(size)});
+    tensor.set_type(TypeInfo::Create<uint8_t>());
+    return true;
+  }
+
+  /**
+   * @brief Adds the sample read into `tensor` to the cache, once its read is complete.
+   *        Can be called from the read works.
+   */
+  void AddToSampleCache(const std::string &key, Tensor<CPUBackend> &tensor) {
+    if (!sample_cache_)
+      return;
+    std::lock_guard<std::mutex> lock(sample_cache_mutex_);
+    pending_cache_adds_.emplace_back(key, &tensor);
+  }
+
+  // Direct I/O can't be done through a memory mapping, so it implies the pread backend
+  static IOBackend GetIOBackend(const OpSpec &options, bool direct_io) {
+    auto backend = ParseIOBackend(options.GetArgument<std::string>("io_backend"));
+    if (direct_io && backend == IOBackend::MMAP) {
+      backend = IOBackend::PREAD;
+    }
+    return backend;
+  }
+
   bool ShouldSkipImage(const ImageCache::ImageKey& key) {
     if (!skip_cached_images_)
       return false;
@@ -278,6 +676,10 @@ class Loader {
   bool shuffle_;
   const int initial_buffer_fill_;
   const int initial_empty_size_;
+  const int batch_size_;
+  // whether the prefetch queue may get deeper than `prefetch_queue_depth`,
+  // so more empty tensors are needed
+  const bool adaptive_prefetch_;
   const int tensor_init_bytes_;
   bool initial_buffer_filled_ = false;
 
@@ -326,14 +728,66 @@ class Loader {
   // Keeps pointer to the last returned sample just in case it needs to be cloned
   LoadTargetSharedPtr last_sample_ptr_tmp;
 
+  // Number of threads used to read samples concurrently
+  const int num_io_threads_;
+  std::unique_ptr<ThreadPool> io_thread_pool_;
+  // Reads that were prepared but not issued yet
+  std::vector<ReadWork> pending_reads_;
+
+  // How the files are accessed by loaders that support it
+  const bool direct_io_;
+  const IOBackend io_backend_;
+  const int io_queue_depth_;
+  std::once_flag batch_file_reader_created_;
+  std::unique_ptr<BatchFileReader> batch_file_reader_;
+
+  // Host memory cache of the samples read, shared by the loaders using the same cache name
+  std::shared_ptr<SampleCache> sample_cache_;
+  // Samples to be added to the cache when their reads complete
+  std::vector<std::pair<std::string, Tensor<CPUBackend>*>> pending_cache_adds_;
+  std::mutex sample_cache_mutex_;
+
+  // Number of consecutive samples read together when the order of blocks is shuffled,
+  // 0 disables the block shuffle
+  const Index shuffle_block_size_;
+  std::vector<Index> block_order_;
+  int block_shuffle_epoch_ = 0;
+
   struct ShardBoundaries {
     Index start;
     Index end;
   };
 
   std::deque<ShardBoundaries> shards_;
+
+  struct SamplePosition {
+    Index index;
+    Index shuffle_epoch;
+  };
+
+  SamplePosition CurrentPosition() const {
+    return {Tell(), block_shuffle_epoch_};
+  }
+
+  // Moves to the position returned by CurrentPosition, restoring the order of the blocks
+  void SetPosition(const SamplePosition &position) {
+    if (shuffle_block_size_ > 0 && position.shuffle_epoch != block_shuffle_epoch_) {
+      block_shuffle_epoch_ = position.shuffle_epoch - 1;
+      ShuffleBlocks();
+    }
+    Seek(position.index);
+  }
+
+  // Positions of the samples in sample_buffer_, saved in the checkpoints instead of their data
+  std::vector<SamplePosition> sample_positions_;
+  SamplePosition last_sample_position_ = {0, 0};
+
+  static constexpr uint32_t kStateVersion = 1;
 };
 
+template <typename Backend, typename LoadTarget>
+constexpr uint32_t Loader<Backend, LoadTarget>::kStateVersion;
+
 template<typename T, typename... Args>
 std::unique_ptr<T> InitLoader(const OpSpec& spec, Args&&... args) {
   std::unique_ptr<T> loader (new T(spec, std::forward<Args>(args)...));
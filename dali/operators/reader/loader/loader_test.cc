@@ -13,7 +13,17 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "dali/core/common.h"
 #include "dali/pipeline/data/backend.h"
@@ -23,6 +33,7 @@
 #include "dali/operators/reader/loader/loader.h"
 #include "dali/operators/reader/loader/file_loader.h"
 #include "dali/operators/reader/loader/lmdb.h"
+#include "dali/operators/reader/loader/tfrecord_loader.h"
 
 namespace dali {
 
@@ -58,6 +69,145 @@ TYPED_TEST(DataLoadStoreTest, LMDBTest) {
   return;
 }
 
+TYPED_TEST(DataLoadStoreTest, LMDBKeyIndexTest) {
+  auto make_reader = [](bool key_index) {
+    return std::make_shared<LMDBLoader>(
+        OpSpec("CaffeReader")
+        .AddArg("batch_size", 32)
+        .AddArg("path", testing::dali_extra_path() + "/db/c2lmdb/")
+        .AddArg("shard_id", 1)
+        .AddArg("num_shards", 3)
+        .AddArg("stick_to_shard", true)
+        .AddArg("key_index", key_index)
+        .AddArg("device_id", 0));
+  };
+  auto reader = make_reader(false);
+  auto indexed_reader = make_reader(true);
+  reader->PrepareMetadata();
+  indexed_reader->PrepareMetadata();
+
+  // go through the shard more than once, so the wrap-around is covered as well
+  for (Index i = 0; i < reader->Size(); ++i) {
+    auto sample = reader->ReadOne(false);
+    auto indexed_sample = indexed_reader->ReadOne(false);
+    ASSERT_EQ(sample->GetSourceInfo(), indexed_sample->GetSourceInfo());
+    ASSERT_EQ(sample->size(), indexed_sample->size());
+  }
+}
+
+TYPED_TEST(DataLoadStoreTest, LMDBCopyIntoSharedTensorTest) {
+  // the copied sample goes to a tensor that shared a zero-copy value before
+  auto make_reader = [](bool zero_copy) {
+    return std::make_shared<LMDBLoader>(
+        OpSpec("CaffeReader")
+        .AddArg("batch_size", 32)
+        .AddArg("path", testing::dali_extra_path() + "/db/lmdb/")
+        .AddArg("zero_copy", zero_copy)
+        .AddArg("device_id", 0));
+  };
+  auto reader = make_reader(false);
+  auto zero_copy_reader = make_reader(true);
+  reader->PrepareMetadata();
+  zero_copy_reader->PrepareMetadata();
+
+  Tensor<CPUBackend> tensor;
+  zero_copy_reader->ReadSample(tensor);
+  ASSERT_TRUE(tensor.shares_data());
+  auto zero_copy_data = tensor.get_data_ptr();
+  reader->ReadSample(tensor);
+  EXPECT_FALSE(tensor.shares_data());
+  ASSERT_EQ(tensor.nbytes(), tensor.size());
+  ASSERT_NE(tensor.raw_data(), nullptr);
+  EXPECT_EQ(std::memcmp(tensor.raw_data(), zero_copy_data.get(), tensor.nbytes()), 0);
+}
+
+TYPED_TEST(DataLoadStoreTest, LMDBCorruptedKeyIndexTest) {
+  // a writable copy of the database, so the key index can be saved next to it
+  char tmpl[] = "/tmp/dali_lmdb_XXXXXX";
+  ASSERT_NE(mkdtemp(tmpl), nullptr);
+  std::string dir = tmpl;
+  {
+    std::ifstream src(testing::dali_extra_path() + "/db/c2lmdb/data.mdb", std::ios::binary);
+    std::ofstream dst(dir + "/data.mdb", std::ios::binary);
+    dst << src.rdbuf();
+  }
+  auto make_reader = [&](bool persist) {
+    return std::make_shared<LMDBLoader>(
+        OpSpec("CaffeReader")
+        .AddArg("batch_size", 32)
+        .AddArg("path", persist ? dir : testing::dali_extra_path() + "/db/c2lmdb/")
+        .AddArg("persist_key_index", persist)
+        .AddArg("device_id", 0));
+  };
+  make_reader(true)->PrepareMetadata();
+  std::string index_path = dir + "/data.mdb.dali_key_index";
+  struct stat s;
+  ASSERT_EQ(stat(index_path.c_str(), &s), 0);
+  auto index_size = s.st_size;
+
+  // offsets going backwards and past the keys, the file size stays the same
+  {
+    std::fstream f(index_path, std::ios::binary | std::ios::in | std::ios::out);
+    f.seekp(5 * sizeof(uint64_t) + sizeof(int64_t));
+    uint64_t offsets[2] = {uint64_t(1) << 40, 1};
+    f.write(reinterpret_cast<const char*>(offsets), sizeof(offsets));
+  }
+  auto reader = make_reader(false);
+  auto indexed_reader = make_reader(true);
+  reader->PrepareMetadata();
+  indexed_reader->PrepareMetadata();
+  for (Index i = 0; i < reader->Size(); ++i) {
+    auto sample = reader->ReadOne(false);
+    auto indexed_sample = indexed_reader->ReadOne(false);
+    ASSERT_EQ(sample->size(), indexed_sample->size());
+  }
+
+  // truncated, the index is rebuilt again
+  ASSERT_EQ(truncate(index_path.c_str(), index_size - 1), 0);
+  indexed_reader = make_reader(true);
+  indexed_reader->PrepareMetadata();
+  EXPECT_EQ(indexed_reader->Size(), reader->Size());
+  ASSERT_EQ(stat(index_path.c_str(), &s), 0);
+  EXPECT_EQ(s.st_size, index_size);
+
+  indexed_reader.reset();
+  std::remove(index_path.c_str());
+  std::remove((dir + "/data.mdb").c_str());
+  rmdir(dir.c_str());
+}
+
+TYPED_TEST(DataLoadStoreTest, LMDBZeroCopyTest) {
+  auto make_reader = [](bool zero_copy) {
+    return std::make_shared<LMDBLoader>(
+        OpSpec("CaffeReader")
+        .AddArg("batch_size", 32)
+        .AddArg("path", testing::dali_extra_path() + "/db/lmdb/")
+        .AddArg("zero_copy", zero_copy)
+        .AddArg("device_id", 0));
+  };
+  auto reader = make_reader(false);
+  auto zero_copy_reader = make_reader(true);
+  reader->PrepareMetadata();
+  zero_copy_reader->PrepareMetadata();
+
+  std::vector<std::vector<uint8_t>> expected;
+  std::vector<std::shared_ptr<void>> shared;
+  for (Index i = 0; i < reader->Size(); ++i) {
+    auto sample = reader->ReadOne(false);
+    auto zero_copy_sample = zero_copy_reader->ReadOne(false);
+    ASSERT_EQ(sample->GetSourceInfo(), zero_copy_sample->GetSourceInfo());
+    ASSERT_EQ(sample->nbytes(), zero_copy_sample->nbytes());
+    auto *data = static_cast<const uint8_t*>(sample->raw_data());
+    expected.emplace_back(data, data + sample->nbytes());
+    shared.push_back(zero_copy_sample->get_data_ptr());
+  }
+  // the shared values keep the database mapped after the loader is gone
+  zero_copy_reader.reset();
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(std::memcmp(shared[i].get(), expected[i].data(), expected[i].size()), 0);
+  }
+}
+
 TYPED_TEST(DataLoadStoreTest, LoaderTest) {
   shared_ptr<dali::FileLoader> reader(
       new FileLoader(
@@ -78,6 +228,59 @@ TYPED_TEST(DataLoadStoreTest, LoaderTest) {
   return;
 }
 
+void CompareWithSequentialRead(int num_io_threads, const std::string &io_backend,
+                               bool direct_io = false) {
+  auto make_reader = [](int num_io_threads, const std::string &io_backend, bool direct_io) {
+    return std::make_shared<FileLoader>(
+        OpSpec("FileReader")
+        .AddArg("file_root", loader_test_image_folder)
+        .AddArg("batch_size", 32)
+        .AddArg("random_shuffle", true)
+        .AddArg("initial_fill", 16)
+        .AddArg("num_io_threads", num_io_threads)
+        .AddArg("io_backend", io_backend)
+        .AddArg("direct_io", direct_io)
+        .AddArg("device_id", 0));
+  };
+  auto reader = make_reader(1, "mmap", false);
+  auto tested_reader = make_reader(num_io_threads, io_backend, direct_io);
+  reader->PrepareMetadata();
+  tested_reader->PrepareMetadata();
+
+  // the order and the content of the samples has to be the same as for the sequential read
+  for (int iter = 0; iter < 5; ++iter) {
+    std::vector<std::shared_ptr<ImageLabelWrapper>> batch, tested_batch;
+    reader->ReadBatch(batch, 7);
+    tested_reader->ReadBatch(tested_batch, 7);
+    ASSERT_EQ(batch.size(), tested_batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+      EXPECT_EQ(batch[i]->image.GetSourceInfo(), tested_batch[i]->image.GetSourceInfo());
+      EXPECT_EQ(batch[i]->label, tested_batch[i]->label);
+      ASSERT_EQ(batch[i]->image.size(), tested_batch[i]->image.size());
+      EXPECT_EQ(0, std::memcmp(batch[i]->image.raw_data(), tested_batch[i]->image.raw_data(),
+                               batch[i]->image.size()));
+    }
+  }
+}
+
+TYPED_TEST(DataLoadStoreTest, LoaderParallelReadTest) {
+  CompareWithSequentialRead(4, "mmap");
+}
+
+TYPED_TEST(DataLoadStoreTest, LoaderPreadBackendTest) {
+  CompareWithSequentialRead(1, "pread");
+  CompareWithSequentialRead(4, "pread");
+}
+
+TYPED_TEST(DataLoadStoreTest, LoaderIoUringBackendTest) {
+  CompareWithSequentialRead(1, "io_uring");
+}
+
+TYPED_TEST(DataLoadStoreTest, LoaderDirectIOTest) {
+  CompareWithSequentialRead(1, "mmap", true);
+  CompareWithSequentialRead(4, "io_uring", true);
+}
+
 TYPED_TEST(DataLoadStoreTest, LoaderTestFail) {
   shared_ptr<dali::FileLoader> reader(
       new FileLoader(OpSpec("FileReader")
@@ -87,6 +290,365 @@ TYPED_TEST(DataLoadStoreTest, LoaderTestFail) {
   ASSERT_THROW(reader->PrepareMetadata(), std::runtime_error);
 }
 
+namespace {
+
+std::vector<std::string> ReadEpoch(FileLoader &loader, Index n) {
+  std::vector<std::string> names;
+  for (Index i = 0; i < n; ++i) {
+    names.push_back(loader.ReadOne(false)->image.GetSourceInfo());
+  }
+  return names;
+}
+
+}  // namespace
+
+TYPED_TEST(DataLoadStoreTest, BlockShuffleTest) {
+  const int block_size = 4;
+  auto make_reader = [&](int shard_id, int num_shards) {
+    auto reader = std::make_shared<FileLoader>(
+        OpSpec("FileReader")
+        .AddArg("file_root", loader_test_image_folder)
+        .AddArg("batch_size", 32)
+        .AddArg("initial_fill", 1)
+        .AddArg("shuffle_block_size", block_size)
+        .AddArg("shard_id", shard_id)
+        .AddArg("num_shards", num_shards)
+        .AddArg("device_id", 0));
+    reader->PrepareMetadata();
+    return reader;
+  };
+  auto sequential = filesystem::traverse_directories(loader_test_image_folder);
+  Index size = sequential.size();
+  ASSERT_GE(size, 4 * block_size);
+
+  auto reader = make_reader(0, 1);
+  auto epoch0 = ReadEpoch(*reader, size);
+  auto epoch1 = ReadEpoch(*reader, size);
+  EXPECT_NE(epoch0, epoch1);
+  for (auto *epoch : {&epoch0, &epoch1}) {
+    // whole blocks of consecutive samples, the incomplete one at the end
+    for (Index b = 0; b < size; b += block_size) {
+      auto first = std::find_if(sequential.begin(), sequential.end(), [&](auto &p) {
+        return p.first == (*epoch)[b];
+      });
+      ASSERT_NE(first, sequential.end());
+      Index start = first - sequential.begin();
+      EXPECT_EQ(start % block_size, 0);
+      for (Index i = b; i < std::min<Index>(b + block_size, size); ++i) {
+        EXPECT_EQ((*epoch)[i], sequential[start + i - b].first);
+      }
+    }
+    auto sorted = *epoch;
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  }
+
+  // the shards read disjoint parts of the same order
+  std::vector<std::string> sharded;
+  for (int shard_id = 0; shard_id < 3; ++shard_id) {
+    auto shard = ReadEpoch(*make_reader(shard_id, 3),
+                           start_index(shard_id + 1, 3, size) - start_index(shard_id, 3, size));
+    sharded.insert(sharded.end(), shard.begin(), shard.end());
+  }
+  EXPECT_EQ(sharded, epoch0);
+}
+
+namespace {
+
+std::string SampleKey(const ImageLabelWrapper &sample) {
+  return sample.image.GetSourceInfo();
+}
+
+std::string SampleKey(const Tensor<CPUBackend> &sample) {
+  return sample.GetSourceInfo();
+}
+
+/**
+ * Reads the samples following the first `skip` ones, over the end of the epoch,
+ * and checks that a loader restored from the state saved after `skip` samples
+ * returns the same ones
+ */
+template <typename LoaderType>
+void CheckRestoredState(const OpSpec &spec, Index skip) {
+  auto loader = InitLoader<LoaderType>(spec);
+  for (Index i = 0; i < skip; ++i) {
+    loader->ReadOne(false);
+  }
+  auto state = loader->SaveState();
+  std::vector<std::string> expected;
+  for (Index i = 0; i < loader->Size(); ++i) {
+    expected.push_back(SampleKey(*loader->ReadOne(false)));
+  }
+
+  auto restored = InitLoader<LoaderType>(spec);
+  restored->RestoreState(state);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(SampleKey(*restored->ReadOne(false)), expected[i]) << "sample " << i;
+  }
+}
+
+OpSpec FileReaderSpec() {
+  return OpSpec("FileReader")
+      .AddArg("file_root", loader_test_image_folder)
+      .AddArg("batch_size", 32)
+      .AddArg("device_id", 0);
+}
+
+}  // namespace
+
+TYPED_TEST(DataLoadStoreTest, LoaderRestoreStateTest) {
+  CheckRestoredState<FileLoader>(FileReaderSpec(), 0);
+  CheckRestoredState<FileLoader>(FileReaderSpec(), 5);
+  CheckRestoredState<FileLoader>(FileReaderSpec()
+                                 .AddArg("random_shuffle", true)
+                                 .AddArg("initial_fill", 16), 21);
+  CheckRestoredState<FileLoader>(FileReaderSpec()
+                                 .AddArg("random_shuffle", true)
+                                 .AddArg("initial_fill", 16)
+                                 .AddArg("shuffle_block_size", 4)
+                                 .AddArg("num_io_threads", 4), 13);
+  CheckRestoredState<FileLoader>(FileReaderSpec()
+                                 .AddArg("random_shuffle", true)
+                                 .AddArg("initial_fill", 8)
+                                 .AddArg("shard_id", 1)
+                                 .AddArg("num_shards", 3)
+                                 .AddArg("pad_last_batch", true), 7);
+
+  CheckRestoredState<LMDBLoader>(OpSpec("CaffeReader")
+                                 .AddArg("batch_size", 32)
+                                 .AddArg("path", testing::dali_extra_path() + "/db/c2lmdb/")
+                                 .AddArg("random_shuffle", true)
+                                 .AddArg("initial_fill", 64)
+                                 .AddArg("key_index", true)
+                                 .AddArg("device_id", 0), 100);
+}
+
+TYPED_TEST(DataLoadStoreTest, LoaderRestoreStateFail) {
+  auto loader = InitLoader<FileLoader>(FileReaderSpec().AddArg("initial_fill", 8));
+  loader->ReadOne(false);
+  auto state = loader->SaveState();
+
+  // other configuration
+  auto other = InitLoader<FileLoader>(FileReaderSpec().AddArg("initial_fill", 8)
+                                                      .AddArg("num_shards", 2));
+  EXPECT_THROW(other->RestoreState(state), std::runtime_error);
+  // truncated
+  auto restored = InitLoader<FileLoader>(FileReaderSpec().AddArg("initial_fill", 8));
+  EXPECT_THROW(restored->RestoreState(state.substr(0, state.size() - 1)), std::runtime_error);
+  // after the first read
+  EXPECT_THROW(loader->RestoreState(state), std::runtime_error);
+  // order depending on all the previous epochs
+  FileLoader shuffled(FileReaderSpec(), {}, true);
+  EXPECT_FALSE(shuffled.SupportsCheckpointing());
+  EXPECT_THROW(shuffled.SaveState(), std::runtime_error);
+}
+
+void SampleCacheTest(int num_io_threads, const std::string &io_backend) {
+  std::string cache_name = "LoaderSampleCacheTest" + io_backend + std::to_string(num_io_threads);
+  auto reader = std::make_shared<FileLoader>(
+      OpSpec("FileReader")
+      .AddArg("file_root", loader_test_image_folder)
+      .AddArg("batch_size", 32)
+      .AddArg("initial_fill", 1)
+      .AddArg("num_io_threads", num_io_threads)
+      .AddArg("io_backend", io_backend)
+      .AddArg("sample_cache_size", 256)
+      .AddArg("sample_cache_name", cache_name)
+      .AddArg("device_id", 0));
+  reader->PrepareMetadata();
+  Index size = reader->Size();
+
+  std::vector<std::vector<uint8_t>> epoch0;
+  for (Index i = 0; i < size; ++i) {
+    auto sample = reader->ReadOne(false);
+    auto *data = sample->image.template data<uint8_t>();
+    epoch0.emplace_back(data, data + sample->image.size());
+  }
+  // the loader already prefetched the first sample of the next epoch
+  auto stats = SampleCacheRegistry::Instance().GetStats(cache_name);
+  EXPECT_EQ(stats.misses, size);
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.num_entries, size);
+
+  for (Index i = 0; i < size; ++i) {
+    auto sample = reader->ReadOne(false);
+    EXPECT_TRUE(sample->image.shares_data());
+    ASSERT_EQ(sample->image.size(), static_cast<Index>(epoch0[i].size()));
+    EXPECT_EQ(0, std::memcmp(sample->image.raw_data(), epoch0[i].data(), epoch0[i].size()));
+  }
+  stats = SampleCacheRegistry::Instance().GetStats(cache_name);
+  EXPECT_EQ(stats.misses, size);
+  EXPECT_EQ(stats.hits, size + 1);
+}
+
+TYPED_TEST(DataLoadStoreTest, SampleCacheTest) {
+  SampleCacheTest(1, "mmap");
+  SampleCacheTest(4, "pread");
+}
+
+TYPED_TEST(DataLoadStoreTest, ParallelTraversalTest) {
+  auto expected = filesystem::traverse_directories(loader_test_image_folder, 1);
+  ASSERT_FALSE(expected.empty());
+  EXPECT_EQ(expected, filesystem::traverse_directories(loader_test_image_folder, 4));
+}
+
+namespace {
+
+void WriteFile(const std::string &path, const std::string &content = "") {
+  std::ofstream f(path);
+  f << content;
+}
+
+std::string ReadFile(const std::string &path) {
+  std::ifstream f(path);
+  return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+TYPED_TEST(DataLoadStoreTest, FileListCacheTest) {
+  char tmpl[] = "/tmp/dali_file_list_XXXXXX";
+  ASSERT_NE(mkdtemp(tmpl), nullptr);
+  std::string root = tmpl;
+  std::string cache = root + ".cache";
+  for (auto dir : {"/b", "/a"})
+    ASSERT_EQ(mkdir((root + dir).c_str(), 0755), 0);
+  WriteFile(root + "/a/1.jpg");
+  WriteFile(root + "/a/2.png");
+  WriteFile(root + "/a/notes.txt");
+  WriteFile(root + "/b/3.jpg");
+
+  std::vector<std::pair<std::string, int>> expected = {{"a/1.jpg", 0}, {"a/2.png", 0},
+                                                       {"b/3.jpg", 1}};
+  EXPECT_EQ(filesystem::traverse_directories(root, 2, cache), expected);
+
+  // the second traversal is served from the cache
+  std::string content = ReadFile(cache);
+  auto pos = content.find("a/1.jpg");
+  ASSERT_NE(pos, std::string::npos);
+  content[pos + 2] = '9';
+  WriteFile(cache, content);
+  auto cached = filesystem::traverse_directories(root, 2, cache);
+  ASSERT_EQ(cached.size(), expected.size());
+  EXPECT_EQ(cached[0].first, "a/9.jpg");
+
+  // a change in a class directory invalidates the cache
+  WriteFile(root + "/b/4.jpg");
+  expected.emplace_back("b/4.jpg", 1);
+  EXPECT_EQ(filesystem::traverse_directories(root, 2, cache), expected);
+  EXPECT_EQ(filesystem::traverse_directories(root, 2, cache), expected);
+
+  // so does a new class directory
+  ASSERT_EQ(mkdir((root + "/c").c_str(), 0755), 0);
+  WriteFile(root + "/c/5.jpg");
+  expected.emplace_back("c/5.jpg", 2);
+  EXPECT_EQ(filesystem::traverse_directories(root, 2, cache), expected);
+
+  for (auto file : {"/a/1.jpg", "/a/2.png", "/a/notes.txt", "/b/3.jpg", "/b/4.jpg", "/c/5.jpg"})
+    std::remove((root + file).c_str());
+  for (auto dir : {"/a", "/b", "/c", ""})
+    rmdir((root + dir).c_str());
+  std::remove(cache.c_str());
+}
+
+#ifdef DALI_BUILD_PROTO3
+
+namespace {
+
+const std::string tfrecord_path = testing::dali_extra_path() + "/db/tfrecord/train";  // NOLINT
+
+OpSpec TFRecordSpec(const std::string &path, const std::string &compression = "none") {
+  return OpSpec("_TFRecordReader")
+      .AddArg("path", std::vector<std::string>{path})
+      .AddArg("compression", compression)
+      .AddArg("verify_crc", true)
+      .AddArg("batch_size", 32)
+      .AddArg("device_id", 0);
+}
+
+std::vector<std::vector<uint8_t>> ReadAllRecords(const OpSpec &spec) {
+  TFRecordLoader loader(spec);
+  loader.PrepareMetadata();
+  std::vector<std::vector<uint8_t>> records;
+  for (Index i = 0; i < loader.Size(); ++i) {
+    auto sample = loader.ReadOne(false);
+    auto *data = static_cast<const uint8_t*>(sample->raw_data());
+    records.emplace_back(data, data + sample->nbytes());
+  }
+  return records;
+}
+
+std::string TempPath() {
+  char name[] = "/tmp/dali_tfrecord_XXXXXX";
+  int fd = mkstemp(name);
+  close(fd);
+  return name;
+}
+
+}  // namespace
+
+TYPED_TEST(DataLoadStoreTest, TFRecordLoaderNoIndexTest) {
+  auto expected = ReadAllRecords(
+      TFRecordSpec(tfrecord_path).AddArg("index_path", std::vector<std::string>{
+          tfrecord_path + ".idx"}));
+  auto records = ReadAllRecords(TFRecordSpec(tfrecord_path));
+  ASSERT_FALSE(records.empty());
+  EXPECT_EQ(records, expected);
+
+  // a missing index is built and saved
+  std::string index_path = TempPath();
+  std::remove(index_path.c_str());
+  records = ReadAllRecords(
+      TFRecordSpec(tfrecord_path).AddArg("index_path", std::vector<std::string>{index_path}));
+  EXPECT_EQ(records, expected);
+  records = ReadAllRecords(
+      TFRecordSpec(tfrecord_path).AddArg("index_path", std::vector<std::string>{index_path}));
+  EXPECT_EQ(records, expected);
+  std::remove(index_path.c_str());
+}
+
+TYPED_TEST(DataLoadStoreTest, TFRecordLoaderRestoreStateTest) {
+  for (const char *io_backend : {"mmap", "pread"}) {
+    CheckRestoredState<TFRecordLoader>(TFRecordSpec(tfrecord_path)
+                                       .AddArg("random_shuffle", true)
+                                       .AddArg("initial_fill", 16)
+                                       .AddArg("shuffle_block_size", 8)
+                                       .AddArg("io_backend", std::string(io_backend)), 27);
+  }
+}
+
+TYPED_TEST(DataLoadStoreTest, TFRecordLoaderCompressedTest) {
+  auto expected = ReadAllRecords(TFRecordSpec(tfrecord_path));
+
+  std::ifstream fin(tfrecord_path, std::ios::binary);
+  std::vector<char> content((std::istreambuf_iterator<char>(fin)),
+                            std::istreambuf_iterator<char>());
+
+  std::string gzip_path = TempPath();
+  gzFile gz = gzopen(gzip_path.c_str(), "wb");
+  ASSERT_NE(gz, nullptr);
+  ASSERT_EQ(gzwrite(gz, content.data(), content.size()), static_cast<int>(content.size()));
+  gzclose(gz);
+  EXPECT_EQ(ReadAllRecords(TFRecordSpec(gzip_path, "gzip")), expected);
+  // seeking back would decompress the file from the start for every block
+  EXPECT_THROW(TFRecordLoader(TFRecordSpec(gzip_path, "gzip").AddArg("shuffle_block_size", 4)),
+               std::runtime_error);
+
+  std::string zlib_path = TempPath();
+  uLongf zlib_size = compressBound(content.size());
+  std::vector<Bytef> zlib_content(zlib_size);
+  ASSERT_EQ(compress(zlib_content.data(), &zlib_size,
+                     reinterpret_cast<const Bytef*>(content.data()), content.size()), Z_OK);
+  std::ofstream(zlib_path, std::ios::binary).write(
+      reinterpret_cast<const char*>(zlib_content.data()), zlib_size);
+  EXPECT_EQ(ReadAllRecords(TFRecordSpec(zlib_path, "zlib")), expected);
+
+  std::remove(gzip_path.c_str());
+  std::remove(zlib_path.c_str());
+}
+
+#endif  // DALI_BUILD_PROTO3
+
 #if 0
 TYPED_TEST(DataLoadStoreTest, CachedLMDBTest) {
   shared_ptr<dali::LMDBLoader> reader(
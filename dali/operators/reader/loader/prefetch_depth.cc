@@ -0,0 +1,81 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+
+#include "dali/core/error_handling.h"
+#include "dali/operators/reader/loader/prefetch_depth.h"
+
+namespace dali {
+
+constexpr int PrefetchDepthController::kWindow;
+constexpr int PrefetchDepthController::kStallPermille;
+constexpr int PrefetchDepthController::kMinCalmWindows;
+constexpr int PrefetchDepthController::kMaxCalmWindows;
+
+PrefetchDepthController::PrefetchDepthController(int initial_depth, int max_depth,
+                                                 size_t memory_budget)
+    : depth_(initial_depth), max_depth_(max_depth), memory_budget_(memory_budget) {
+  DALI_ENFORCE(initial_depth > 0, "prefetch_queue_depth needs to be greater than 0");
+  DALI_ENFORCE(max_depth >= initial_depth,
+               "max_prefetch_queue_depth can't be less than prefetch_queue_depth");
+}
+
+void PrefetchDepthController::AddBatchBytes(size_t bytes) {
+  batch_bytes_ = std::max(batch_bytes_, bytes);
+}
+
+bool PrefetchDepthController::FitsBudget(int depth) const {
+  return memory_budget_ == 0 || depth * batch_bytes_ <= memory_budget_;
+}
+
+bool PrefetchDepthController::BatchConsumed(int64_t now_ns) {
+  if (window_start_ns_ < 0) {
+    // the first batch includes the start-up of the reader
+    window_start_ns_ = now_ns;
+    consumer_wait_ns_ = producer_idle_ns_ = 0;
+    return false;
+  }
+  if (++window_batches_ < kWindow)
+    return false;
+
+  int64_t stall_ns = (now_ns - window_start_ns_) * kStallPermille / 1000;
+  bool stalled = consumer_wait_ns_ > stall_ns;
+  bool producer_idle = producer_idle_ns_ > stall_ns;
+  window_start_ns_ = now_ns;
+  window_batches_ = 0;
+  consumer_wait_ns_ = producer_idle_ns_ = 0;
+
+  int old_depth = depth_;
+  if (!FitsBudget(depth_)) {
+    while (depth_ > 1 && !FitsBudget(depth_))
+      depth_--;
+    calm_windows_ = 0;
+  } else if (stalled) {
+    calm_windows_ = 0;
+    if (producer_idle && depth_ < max_depth_ && FitsBudget(depth_ + 1)) {
+      depth_++;
+      if (shrunk_last_)
+        calm_windows_to_shrink_ = std::min(2 * calm_windows_to_shrink_, kMaxCalmWindows);
+      shrunk_last_ = false;
+    }
+  } else if (++calm_windows_ >= calm_windows_to_shrink_ && depth_ > 1) {
+    depth_--;
+    calm_windows_ = 0;
+    shrunk_last_ = true;
+  }
+  return depth_ != old_depth;
+}
+
+}  // namespace dali
@@ -0,0 +1,94 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_OPERATORS_READER_LOADER_PREFETCH_DEPTH_H_
+#define DALI_OPERATORS_READER_LOADER_PREFETCH_DEPTH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "dali/core/api_helper.h"
+
+namespace dali {
+
+/**
+ * @brief Picks the depth of the prefetch queue of a reader from the time the consumer waits
+ *        for the batches and the time the prefetch thread waits for a free slot.
+ *
+ * The times are summed over a window of consumed batches. The depth grows when the consumer
+ * waited while the producer was idle for a part of the window too, i.e. the producer keeps up
+ * on average but the reads are uneven. Deeper queue doesn't help when the producer is busy
+ * all the time, so the depth stays. After a few windows without waiting the depth shrinks,
+ * and each time it has to grow back right after shrinking, it waits twice as long before
+ * shrinking again.
+ *
+ * The depth never exceeds `max_depth`, nor what fits in `memory_budget` bytes (if non-zero)
+ * with batches of the biggest size seen.
+ *
+ * Not thread safe, the reader calls it with its queue locked.
+ */
+class DLL_PUBLIC PrefetchDepthController {
+ public:
+  DLL_PUBLIC PrefetchDepthController(int initial_depth, int max_depth, size_t memory_budget);
+
+  int depth() const {
+    return depth_;
+  }
+
+  void AddConsumerWait(int64_t time_ns) {
+    consumer_wait_ns_ += time_ns;
+  }
+
+  void AddProducerIdle(int64_t time_ns) {
+    producer_idle_ns_ += time_ns;
+  }
+
+  DLL_PUBLIC void AddBatchBytes(size_t bytes);
+
+  /**
+   * @brief Counts a consumed batch and, at the end of a window, updates the depth.
+   *
+   * @param now_ns current time, as given by `stats_now_ns`
+   * @return whether the depth changed
+   */
+  DLL_PUBLIC bool BatchConsumed(int64_t now_ns);
+
+  // Number of consumed batches the decision is based on
+  static constexpr int kWindow = 16;
+  // Part of the window the consumer has to wait to count as a stall
+  static constexpr int kStallPermille = 20;
+  static constexpr int kMinCalmWindows = 4;
+  static constexpr int kMaxCalmWindows = 64;
+
+ private:
+  bool FitsBudget(int depth) const;
+
+  int depth_;
+  const int max_depth_;
+  const size_t memory_budget_;
+  size_t batch_bytes_ = 0;
+
+  int64_t window_start_ns_ = -1;
+  int window_batches_ = 0;
+  int64_t consumer_wait_ns_ = 0;
+  int64_t producer_idle_ns_ = 0;
+
+  int calm_windows_ = 0;
+  int calm_windows_to_shrink_ = kMinCalmWindows;
+  bool shrunk_last_ = false;
+};
+
+}  // namespace dali
+
+#endif  // DALI_OPERATORS_READER_LOADER_PREFETCH_DEPTH_H_
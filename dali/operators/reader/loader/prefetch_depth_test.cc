@@ -0,0 +1,122 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+#include "dali/operators/reader/loader/prefetch_depth.h"
+
+namespace dali {
+
+namespace {
+
+constexpr int64_t kBatchTime = 1000000;
+
+/**
+ * Consumes a window of batches, 1 ms each, with the consumer waiting and the producer idle
+ * for the given part (in percent) of that time
+ */
+void RunWindow(PrefetchDepthController &controller, int64_t &now,
+               int wait_percent, int idle_percent) {
+  for (int i = 0; i < PrefetchDepthController::kWindow; i++) {
+    controller.AddConsumerWait(kBatchTime * wait_percent / 100);
+    controller.AddProducerIdle(kBatchTime * idle_percent / 100);
+    now += kBatchTime;
+    controller.BatchConsumed(now);
+  }
+}
+
+PrefetchDepthController Started(int initial_depth, int max_depth, size_t budget, int64_t &now) {
+  PrefetchDepthController controller(initial_depth, max_depth, budget);
+  controller.BatchConsumed(now);
+  return controller;
+}
+
+}  // namespace
+
+TEST(PrefetchDepthController, GrowsOnJitter) {
+  int64_t now = 0;
+  auto controller = Started(1, 3, 0, now);
+  RunWindow(controller, now, 10, 30);
+  EXPECT_EQ(controller.depth(), 2);
+  RunWindow(controller, now, 10, 30);
+  RunWindow(controller, now, 10, 30);
+  EXPECT_EQ(controller.depth(), 3);
+}
+
+TEST(PrefetchDepthController, KeepsDepthWhenProducerBound) {
+  int64_t now = 0;
+  auto controller = Started(2, 8, 0, now);
+  // the producer is always busy, a deeper queue would only use more memory
+  for (int i = 0; i < 10; i++)
+    RunWindow(controller, now, 50, 0);
+  EXPECT_EQ(controller.depth(), 2);
+}
+
+TEST(PrefetchDepthController, ShrinksWhenCalm) {
+  int64_t now = 0;
+  auto controller = Started(3, 8, 0, now);
+  for (int i = 0; i < PrefetchDepthController::kMinCalmWindows - 1; i++)
+    RunWindow(controller, now, 0, 80);
+  EXPECT_EQ(controller.depth(), 3);
+  RunWindow(controller, now, 0, 80);
+  EXPECT_EQ(controller.depth(), 2);
+  // small waits don't count
+  for (int i = 0; i < PrefetchDepthController::kMinCalmWindows; i++)
+    RunWindow(controller, now, 1, 80);
+  EXPECT_EQ(controller.depth(), 1);
+  for (int i = 0; i < PrefetchDepthController::kMinCalmWindows; i++)
+    RunWindow(controller, now, 0, 80);
+  EXPECT_EQ(controller.depth(), 1);
+}
+
+TEST(PrefetchDepthController, BacksOffAfterGrowingBack) {
+  int64_t now = 0;
+  auto controller = Started(2, 8, 0, now);
+  for (int i = 0; i < PrefetchDepthController::kMinCalmWindows; i++)
+    RunWindow(controller, now, 0, 80);
+  EXPECT_EQ(controller.depth(), 1);
+  RunWindow(controller, now, 10, 30);
+  EXPECT_EQ(controller.depth(), 2);
+  // shrinking again takes twice as long
+  for (int i = 0; i < 2 * PrefetchDepthController::kMinCalmWindows - 1; i++)
+    RunWindow(controller, now, 0, 80);
+  EXPECT_EQ(controller.depth(), 2);
+  RunWindow(controller, now, 0, 80);
+  EXPECT_EQ(controller.depth(), 1);
+}
+
+TEST(PrefetchDepthController, MemoryBudget) {
+  int64_t now = 0;
+  auto controller = Started(2, 8, 1000, now);
+  controller.AddBatchBytes(300);
+  for (int i = 0; i < 5; i++)
+    RunWindow(controller, now, 10, 30);
+  EXPECT_EQ(controller.depth(), 3);
+
+  // the batches got bigger
+  controller.AddBatchBytes(400);
+  RunWindow(controller, now, 10, 30);
+  EXPECT_EQ(controller.depth(), 2);
+  controller.AddBatchBytes(2000);
+  RunWindow(controller, now, 10, 30);
+  EXPECT_EQ(controller.depth(), 1);
+}
+
+TEST(PrefetchDepthController, InvalidDepth) {
+  EXPECT_THROW(PrefetchDepthController(0, 4, 0), std::runtime_error);
+  EXPECT_THROW(PrefetchDepthController(4, 2, 0), std::runtime_error);
+}
+
+}  // namespace dali
@@ -34,7 +34,8 @@ class RecordIOLoader : public IndexedFileLoader {
   ~RecordIOLoader() override {}
 
   void ReadIndexFile(const std::vector<std::string>& index_uris) override {
-    std::vector<size_t> file_offsets;
+    std::vector<int64> &file_offsets = file_offsets_;
+    file_offsets.clear();
     file_offsets.push_back(0);
     for (std::string& path : uris_) {
       auto tmp = FileStream::Open(path, read_ahead_);
@@ -44,59 +45,99 @@ class RecordIOLoader : public IndexedFileLoader {
     DALI_ENFORCE(index_uris.size() == 1,
         "RecordIOReader supports only a single index file");
     const std::string& path = index_uris[0];
+    // offsets in the index refer to the concatenation of all the record files
+    indices_.SetFileOffsets({file_offsets.begin(), file_offsets.end() - 1});
+    if (IsBinaryIndexFile(path)) {
+      indices_.MapBinaryIndexFile(path, 0);
+      return;
+    }
     std::ifstream index_file(path);
     DALI_ENFORCE(index_file.good(),
         "Could not open RecordIO index file. Provided path: \"" + path + "\"");
-    std::vector<size_t> temp;
-    size_t index, offset, prev_offset = -1;
+    std::vector<int64> temp;
+    int64 index, offset;
     while (index_file >> index >> offset) {
       temp.push_back(offset);
     }
+    DALI_ENFORCE(!temp.empty(), "RecordIO index file " + path + " is empty");
     std::sort(temp.begin(), temp.end());
-    size_t file_offset_index = 0;
-    for (size_t i = 0; i < temp.size() - 1; ++i) {
-      if (temp[i] >= file_offsets[file_offset_index + 1]) {
-        ++file_offset_index;
-      }
+    temp.push_back(file_offsets.back());
+    for (size_t i = 0; i + 1 < temp.size(); ++i) {
       int64 size = temp[i + 1] - temp[i];
       // skip 0 sized images
       if (size) {
-        indices_.push_back(std::make_tuple(temp[i] - file_offsets[file_offset_index],
-                                          size, file_offset_index));
+        indices_.push_back(std::make_tuple(temp[i], size, 0));
       }
     }
-    int64 size = file_offsets.back() - temp.back();
-    // skip 0 sized images
-    if (size) {
-      indices_.push_back(std::make_tuple(temp.back() - file_offsets[file_offset_index],
-                                        size, file_offset_index));
-    }
     index_file.close();
   }
 
+  ReadWork PrepareReadSample(Tensor<CPUBackend>& tensor) override {
+    if (io_backend_ == IOBackend::MMAP) {
+      // Records may span over two files, so with mmap they are always read sequentially
+      ReadSample(tensor);
+      return {};
+    }
+    MoveToNextShard(current_index_);
+
+    int64 seek_pos, size;
+    size_t file_index;
+    std::tie(seek_pos, size, file_index) = indices_[ShuffledIndex(current_index_)];
+    ++current_index_;
+
+    DALIMeta meta;
+    if (!PrepareSampleMeta(tensor, seek_pos, file_index, meta)) {
+      return {};
+    }
+
+    if (tensor.shares_data()) {
+      tensor.Reset();
+    }
+    tensor.set_type(TypeInfo::Create<uint8_t>());
+    tensor.Resize({size});
+    tensor.SetMeta(meta);
+    AddToSampleCache(meta.GetSourceInfo(), tensor);
+
+    // queue one read per file the record spans over
+    uint8_t *dst = tensor.mutable_data<uint8_t>();
+    int64 pos = seek_pos;
+    for (size_t f = file_index; size > 0; f++, pos = 0) {
+      DALI_ENFORCE(f < uris_.size(), "Incomplete or corrupted record files");
+      int64 n = std::min<int64>(size, file_offsets_[f + 1] - file_offsets_[f] - pos);
+      if (n > 0) {
+        GetBatchFileReader().Enqueue(uris_[f], pos, n, dst);
+        dst += n;
+        size -= n;
+      }
+    }
+    return {};
+  }
+
   void ReadSample(Tensor<CPUBackend>& tensor) override {
+    if (io_backend_ != IOBackend::MMAP) {
+      ReadSampleSync(tensor);
+      return;
+    }
     // if we moved to next shard wrap up
     MoveToNextShard(current_index_);
 
     int64 seek_pos, size;
     size_t file_index;
-    std::tie(seek_pos, size, file_index) = indices_[current_index_];
+    size_t sample_idx = ShuffledIndex(current_index_);
+    std::tie(seek_pos, size, file_index) = indices_[sample_idx];
 
     ++current_index_;
 
-    std::string image_key = uris_[file_index] + " at index " + to_string(seek_pos);
-    DALIMeta meta;
-    meta.SetSourceInfo(image_key);
-    meta.SetSkipSample(false);
+    // jump to another block of the block shuffle
+    if (sample_idx != next_sample_idx_) {
+      SwitchFile(file_index);
+      should_seek_ = true;
+    }
+    next_sample_idx_ = sample_idx + 1;
 
-    // if image is cached, skip loading
-    if (ShouldSkipImage(image_key)) {
-      meta.SetSkipSample(true);
+    DALIMeta meta;
+    if (!PrepareSampleMeta(tensor, seek_pos, file_index, meta)) {
       should_seek_ = true;
-      tensor.Reset();
-      tensor.SetMeta(meta);
-      tensor.set_type(TypeInfo::Create<uint8_t>());
-      tensor.Resize({0});
       return;
     }
 
@@ -108,19 +149,23 @@ class RecordIOLoader : public IndexedFileLoader {
     shared_ptr<void> p = nullptr;
     int64 n_read = 0;
     bool use_read = copy_read_data_;
-    if (use_read) {
+    // the tensor may share a buffer of the sample cache, which must not be overwritten
+    auto prepare_read = [&]() {
+      if (tensor.shares_data()) {
+        tensor.Reset();
+      }
+      tensor.set_type(TypeInfo::Create<uint8_t>());
       tensor.Resize({size});
+    };
+    if (use_read) {
+      prepare_read();
     }
     while (p == nullptr && n_read < size) {
       if (!use_read) {
         p = current_file_->Get(size);
         // file is divided between two files, we need to fallback to read here
         if (p == nullptr) {
-          if (tensor.shares_data()) {
-            tensor.Reset();
-          }
-          tensor.Resize({size});
-          tensor.set_type(TypeInfo::Create<uint8_t>());
+          prepare_read();
           use_read = true;
         } else {
           n_read = size;
@@ -142,10 +187,13 @@ class RecordIOLoader : public IndexedFileLoader {
       }
     }
     tensor.SetMeta(meta);
+    AddToSampleCache(meta.GetSourceInfo(), tensor);
   }
 
  private:
   bool should_seek_ = false;
+  // offsets of the record files in the concatenated record stream
+  std::vector<int64> file_offsets_;
 };
 
 }  // namespace dali
@@ -0,0 +1,118 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "dali/core/error_handling.h"
+#include "dali/operators/reader/loader/sample_cache.h"
+
+namespace dali {
+
+SampleCache::Policy SampleCache::ParsePolicy(const std::string &policy) {
+  if (policy == "lru")
+    return Policy::LRU;
+  if (policy == "fill")
+    return Policy::FILL;
+  DALI_FAIL("Unknown sample cache policy `" + policy + "`, expected `lru` or `fill`");
+}
+
+std::shared_ptr<const uint8_t> SampleCache::Get(const std::string &key, size_t &size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  auto &entry = it->second;
+  if (policy_ == Policy::LRU)
+    lru_.splice(lru_.begin(), lru_, entry.lru_pos);
+  size = entry.size;
+  return entry.data;
+}
+
+void SampleCache::Add(const std::string &key, const void *data, size_t size) {
+  // samples bigger than the whole cache would only flush it
+  if (size > capacity_)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.count(key))
+      return;
+    if (policy_ == Policy::FILL && size_ + size > capacity_)
+      return;
+  }
+
+  // copy outside of the lock, the readers of other samples don't have to wait for it
+  std::shared_ptr<uint8_t> copy(new uint8_t[size], std::default_delete<uint8_t[]>());
+  std::memcpy(copy.get(), data, size);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.count(key))
+    return;
+  if (policy_ == Policy::FILL && size_ + size > capacity_)
+    return;
+  while (size_ + size > capacity_) {
+    auto victim = entries_.find(*lru_.back());
+    size_ -= victim->second.size;
+    lru_.pop_back();
+    entries_.erase(victim);
+    evictions_++;
+  }
+  auto it = entries_.emplace(key, Entry{std::move(copy), size, {}}).first;
+  lru_.push_front(&it->first);
+  it->second.lru_pos = lru_.begin();
+  size_ += size;
+}
+
+SampleCacheStats SampleCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  SampleCacheStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evictions = evictions_;
+  stats.num_entries = entries_.size();
+  stats.size_bytes = size_;
+  stats.capacity_bytes = capacity_;
+  return stats;
+}
+
+std::shared_ptr<SampleCache> SampleCacheRegistry::Get(const std::string &name,
+                                                      size_t capacity_bytes,
+                                                      SampleCache::Policy policy) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto cache = caches_[name].lock();
+  if (!cache) {
+    cache = std::make_shared<SampleCache>(capacity_bytes, policy);
+    caches_[name] = cache;
+    return cache;
+  }
+  DALI_ENFORCE(cache->capacity() == capacity_bytes && cache->policy() == policy,
+      "Sample cache `" + name + "` was already created with other parameters");
+  return cache;
+}
+
+SampleCacheStats SampleCacheRegistry::GetStats(const std::string &name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = caches_.find(name);
+  std::shared_ptr<SampleCache> cache;
+  if (it != caches_.end())
+    cache = it->second.lock();
+  DALI_ENFORCE(cache != nullptr, "Sample cache `" + name + "` does not exist");
+  return cache->GetStats();
+}
+
+}  // namespace dali
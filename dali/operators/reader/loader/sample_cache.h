@@ -0,0 +1,129 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_OPERATORS_READER_LOADER_SAMPLE_CACHE_H_
+#define DALI_OPERATORS_READER_LOADER_SAMPLE_CACHE_H_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "dali/core/api_helper.h"
+#include "dali/core/common.h"
+
+namespace dali {
+
+struct SampleCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  int64_t evictions = 0;
+  int64_t num_entries = 0;
+  int64_t size_bytes = 0;
+  int64_t capacity_bytes = 0;
+};
+
+/**
+ * @brief Host memory cache of the encoded samples read by the loaders, keyed by the source
+ *        of the sample (path, offset or database key).
+ *
+ * Cached samples are immutable, the loaders share them with their outputs instead of copying.
+ * Evicted samples stay alive until the last output referring to them is released.
+ * Thread safe.
+ */
+class DLL_PUBLIC SampleCache {
+ public:
+  enum class Policy {
+    // evicts the least recently used samples to make room for the new ones
+    LRU,
+    // adds samples until the cache is full, never evicts
+    FILL
+  };
+
+  DLL_PUBLIC static Policy ParsePolicy(const std::string &policy);
+
+  SampleCache(size_t capacity_bytes, Policy policy)
+  : capacity_(capacity_bytes), policy_(policy) {}
+
+  /**
+   * @brief Returns the cached sample and its size, nullptr if the sample is not cached
+   */
+  DLL_PUBLIC std::shared_ptr<const uint8_t> Get(const std::string &key, size_t &size);
+
+  /**
+   * @brief Copies the sample to the cache, if it fits according to the policy
+   */
+  DLL_PUBLIC void Add(const std::string &key, const void *data, size_t size);
+
+  DLL_PUBLIC SampleCacheStats GetStats() const;
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+  Policy policy() const {
+    return policy_;
+  }
+
+ private:
+  struct Entry {
+    std::shared_ptr<const uint8_t> data;
+    size_t size;
+    // position in lru_, the most recently used samples are at the front
+    std::list<const std::string*>::iterator lru_pos;
+  };
+
+  const size_t capacity_;
+  const Policy policy_;
+  size_t size_ = 0;
+  int64_t hits_ = 0, misses_ = 0, evictions_ = 0;
+  std::unordered_map<std::string, Entry> entries_;
+  std::list<const std::string*> lru_;
+  mutable std::mutex mutex_;
+};
+
+/**
+ * @brief Gives the loaders of all pipelines in the process access to the same cache,
+ *        when they use the same cache name.
+ */
+class DLL_PUBLIC SampleCacheRegistry {
+ public:
+  DLL_PUBLIC static SampleCacheRegistry &Instance() {
+    static SampleCacheRegistry instance;
+    return instance;
+  }
+
+  /**
+   * @brief Returns the cache called `name`, creating it if it doesn't exist.
+   *        Fails if the cache exists with other parameters.
+   */
+  DLL_PUBLIC std::shared_ptr<SampleCache> Get(const std::string &name, size_t capacity_bytes,
+                                              SampleCache::Policy policy);
+
+  /**
+   * @brief Returns the statistics of the cache called `name`, fails if it doesn't exist
+   */
+  DLL_PUBLIC SampleCacheStats GetStats(const std::string &name);
+
+ private:
+  std::mutex mutex_;
+  std::map<std::string, std::weak_ptr<SampleCache>> caches_;
+};
+
+}  // namespace dali
+
+#endif  // DALI_OPERATORS_READER_LOADER_SAMPLE_CACHE_H_
@@ -0,0 +1,114 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "dali/core/error_handling.h"
+#include "dali/operators/reader/loader/sample_cache.h"
+
+namespace dali {
+
+namespace {
+
+bool IsCached(SampleCache &cache, const std::string &key) {
+  size_t size;
+  return cache.Get(key, size) != nullptr;
+}
+
+}  // namespace
+
+TEST(SampleCache, GetAndAdd) {
+  SampleCache cache(100, SampleCache::Policy::LRU);
+  std::string data = "encoded sample";
+  size_t size = 0;
+  EXPECT_EQ(cache.Get("a", size), nullptr);
+  cache.Add("a", data.data(), data.size());
+  auto cached = cache.Get("a", size);
+  ASSERT_NE(cached, nullptr);
+  ASSERT_EQ(size, data.size());
+  EXPECT_EQ(std::memcmp(cached.get(), data.data(), size), 0);
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.num_entries, 1);
+  EXPECT_EQ(stats.size_bytes, static_cast<int64_t>(data.size()));
+  EXPECT_EQ(stats.capacity_bytes, 100);
+}
+
+TEST(SampleCache, LRUEviction) {
+  SampleCache cache(100, SampleCache::Policy::LRU);
+  std::vector<uint8_t> data(40, 1);
+  cache.Add("a", data.data(), 40);
+  cache.Add("b", data.data(), 40);
+  size_t size;
+  auto a = cache.Get("a", size);
+  // "b" is the least recently used
+  cache.Add("c", data.data(), 40);
+  EXPECT_TRUE(IsCached(cache, "a"));
+  EXPECT_FALSE(IsCached(cache, "b"));
+  EXPECT_TRUE(IsCached(cache, "c"));
+  EXPECT_EQ(cache.GetStats().evictions, 1);
+
+  // bigger than the whole cache, not added and nothing evicted
+  std::vector<uint8_t> big(101);
+  cache.Add("big", big.data(), big.size());
+  EXPECT_FALSE(IsCached(cache, "big"));
+  EXPECT_EQ(cache.GetStats().num_entries, 2);
+
+  // make room for a big sample
+  std::vector<uint8_t> data90(90, 2);
+  cache.Add("d", data90.data(), data90.size());
+  EXPECT_FALSE(IsCached(cache, "a"));
+  EXPECT_FALSE(IsCached(cache, "c"));
+  EXPECT_TRUE(IsCached(cache, "d"));
+  EXPECT_EQ(cache.GetStats().size_bytes, 90);
+  // evicted samples stay valid while referenced
+  EXPECT_EQ(a.get()[39], 1);
+}
+
+TEST(SampleCache, FillPolicy) {
+  SampleCache cache(100, SampleCache::Policy::FILL);
+  std::vector<uint8_t> data(40, 1);
+  cache.Add("a", data.data(), 40);
+  cache.Add("b", data.data(), 40);
+  cache.Add("c", data.data(), 40);
+  cache.Add("d", data.data(), 20);
+  EXPECT_TRUE(IsCached(cache, "a"));
+  EXPECT_TRUE(IsCached(cache, "b"));
+  EXPECT_FALSE(IsCached(cache, "c"));
+  EXPECT_TRUE(IsCached(cache, "d"));
+  EXPECT_EQ(cache.GetStats().evictions, 0);
+  EXPECT_THROW(SampleCache::ParsePolicy("random"), DALIException);
+}
+
+TEST(SampleCache, Registry) {
+  auto &registry = SampleCacheRegistry::Instance();
+  auto cache = registry.Get("SampleCacheTest", 1000, SampleCache::Policy::LRU);
+  EXPECT_EQ(registry.Get("SampleCacheTest", 1000, SampleCache::Policy::LRU), cache);
+  EXPECT_THROW(registry.Get("SampleCacheTest", 2000, SampleCache::Policy::LRU), DALIException);
+  EXPECT_NE(registry.Get("SampleCacheTest2", 1000, SampleCache::Policy::LRU), cache);
+
+  std::string data = "x";
+  cache->Add("a", data.data(), data.size());
+  EXPECT_EQ(registry.GetStats("SampleCacheTest").num_entries, 1);
+
+  cache.reset();
+  EXPECT_THROW(registry.GetStats("SampleCacheTest"), DALIException);
+}
+
+}  // namespace dali
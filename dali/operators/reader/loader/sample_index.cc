@@ -0,0 +1,85 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "dali/core/error_handling.h"
+#include "dali/operators/reader/loader/sample_index.h"
+
+namespace dali {
+
+bool IsBinaryIndexFile(const std::string &path) {
+  std::ifstream f(path, std::ios::binary);
+  char magic[sizeof(kBinaryIndexMagic)];
+  if (!f.read(magic, sizeof(magic)))
+    return false;
+  return std::memcmp(magic, kBinaryIndexMagic, sizeof(magic)) == 0;
+}
+
+void WriteBinaryIndexFile(const std::string &path, const IndexEntry *entries,
+                          size_t num_entries) {
+  std::ofstream f(path, std::ios::binary);
+  DALI_ENFORCE(f.good(), "Failed to open file " + path);
+  uint64_t n = num_entries;
+  f.write(kBinaryIndexMagic, sizeof(kBinaryIndexMagic));
+  f.write(reinterpret_cast<const char*>(&n), sizeof(n));
+  f.write(reinterpret_cast<const char*>(entries), num_entries * sizeof(IndexEntry));
+  DALI_ENFORCE(f.good(), "Failed to write the index file " + path);
+}
+
+void SampleIndex::MapBinaryIndexFile(const std::string &path, size_t file_index) {
+  int fd = open(path.c_str(), O_RDONLY);
+  DALI_ENFORCE(fd >= 0, "Failed to open file " + path + ": " + std::strerror(errno));
+  struct stat s;
+  if (fstat(fd, &s) != 0) {
+    close(fd);
+    DALI_FAIL("Failed to stat file " + path + ": " + std::strerror(errno));
+  }
+  size_t file_size = s.st_size;
+  if (file_size < kBinaryIndexHeaderSize) {
+    close(fd);
+    DALI_FAIL("Truncated index file " + path);
+  }
+  void *p = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+  DALI_ENFORCE(p != MAP_FAILED, "Failed to map file " + path + ": " + std::strerror(errno));
+  std::shared_ptr<void> mapping(p, [file_size](void *ptr) { munmap(ptr, file_size); });
+
+  const char *data = static_cast<const char*>(p);
+  DALI_ENFORCE(std::memcmp(data, kBinaryIndexMagic, sizeof(kBinaryIndexMagic)) == 0,
+      "Not a binary index file " + path);
+  uint64_t num_entries;
+  std::memcpy(&num_entries, data + sizeof(kBinaryIndexMagic), sizeof(num_entries));
+  DALI_ENFORCE(file_size == kBinaryIndexHeaderSize + num_entries * sizeof(IndexEntry),
+      "Size of the index file " + path + " doesn't match the number of entries");
+  if (num_entries == 0)
+    return;
+
+  auto &segment = AddSegment(file_index);
+  segment.mapped = reinterpret_cast<const IndexEntry*>(data + kBinaryIndexHeaderSize);
+  segment.count = num_entries;
+  segment.mapping = std::move(mapping);
+  size_ += num_entries;
+}
+
+}  // namespace dali
@@ -0,0 +1,159 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_OPERATORS_READER_LOADER_SAMPLE_INDEX_H_
+#define DALI_OPERATORS_READER_LOADER_SAMPLE_INDEX_H_
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "dali/core/api_helper.h"
+#include "dali/core/common.h"
+
+namespace dali {
+
+/**
+ * @brief Location of a single sample in the data files
+ */
+struct IndexEntry {
+  int64 offset;
+  int64 size;
+};
+
+/**
+ * @brief Binary index file layout, all values are little endian:
+ *
+ *   char     magic[8]     "DALIIDX1"
+ *   uint64   num_entries
+ *   IndexEntry entries[num_entries]
+ *
+ * The files are produced from the text indices by the `idx2bin` script.
+ */
+constexpr char kBinaryIndexMagic[8] = {'D', 'A', 'L', 'I', 'I', 'D', 'X', '1'};
+constexpr size_t kBinaryIndexHeaderSize = sizeof(kBinaryIndexMagic) + sizeof(uint64_t);
+
+DLL_PUBLIC bool IsBinaryIndexFile(const std::string &path);
+
+DLL_PUBLIC void WriteBinaryIndexFile(const std::string &path, const IndexEntry *entries,
+                                     size_t num_entries);
+
+/**
+ * @brief Table of the sample locations used by the indexed readers.
+ *
+ * The entries are either owned, when read from a text index or built by the loader, or
+ * they point directly to a memory mapped binary index. The mappings are shared, read-only
+ * and backed by the page cache, so all the readers on a node use a single copy of the index
+ * and opening it doesn't depend on its size.
+ */
+class DLL_PUBLIC SampleIndex {
+ public:
+  // offset, size and index of the data file
+  using Entry = std::tuple<int64, int64, size_t>;
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  Entry operator[](size_t idx) const {
+    const Segment *segment = &segments_[0];
+    if (segments_.size() > 1) {
+      auto it = std::upper_bound(starts_.begin(), starts_.end(), idx);
+      segment = &segments_[it - starts_.begin() - 1];
+    }
+    const IndexEntry &e = segment->entries()[idx - segment->start];
+    if (file_offsets_.empty())
+      return Entry(e.offset, e.size, segment->file_index);
+    auto it = std::upper_bound(file_offsets_.begin(), file_offsets_.end(), e.offset);
+    size_t file_index = it - file_offsets_.begin() - 1;
+    return Entry(e.offset - file_offsets_[file_index], e.size, file_index);
+  }
+
+  /**
+   * @brief Appends an entry to the index
+   */
+  void push_back(const Entry &entry) {
+    size_t file_index = std::get<2>(entry);
+    if (segments_.empty() || segments_.back().mapping ||
+        segments_.back().file_index != file_index) {
+      AddSegment(file_index);
+    }
+    auto &segment = segments_.back();
+    segment.owned.push_back({std::get<0>(entry), std::get<1>(entry)});
+    segment.count++;
+    size_++;
+  }
+
+  /**
+   * @brief Appends the entries of a binary index file, mapping it into the memory
+   */
+  void MapBinaryIndexFile(const std::string &path, size_t file_index);
+
+  /**
+   * @brief Makes the entry offsets refer to the concatenation of the data files,
+   *        `offsets` holds the starting offset of every file.
+   *
+   * The entries are translated to the file index and the offset within it on access.
+   */
+  void SetFileOffsets(std::vector<int64> offsets) {
+    file_offsets_ = std::move(offsets);
+  }
+
+  void clear() {
+    segments_.clear();
+    starts_.clear();
+    file_offsets_.clear();
+    size_ = 0;
+  }
+
+ private:
+  struct Segment {
+    // taken from `owned` on access, so that the index can be copied and moved
+    const IndexEntry *entries() const {
+      return mapping ? mapped : owned.data();
+    }
+
+    const IndexEntry *mapped = nullptr;
+    size_t count = 0;
+    size_t start = 0;
+    size_t file_index = 0;
+    std::vector<IndexEntry> owned;
+    std::shared_ptr<void> mapping;
+  };
+
+  Segment &AddSegment(size_t file_index) {
+    segments_.emplace_back();
+    starts_.push_back(size_);
+    auto &segment = segments_.back();
+    segment.start = size_;
+    segment.file_index = file_index;
+    return segment;
+  }
+
+  std::vector<Segment> segments_;
+  // index of the first entry of every segment
+  std::vector<size_t> starts_;
+  std::vector<int64> file_offsets_;
+  size_t size_ = 0;
+};
+
+}  // namespace dali
+
+#endif  // DALI_OPERATORS_READER_LOADER_SAMPLE_INDEX_H_
@@ -0,0 +1,123 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "dali/core/error_handling.h"
+#include "dali/operators/reader/loader/sample_index.h"
+
+namespace dali {
+
+class SampleIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = "/tmp/dali_sample_index_" + std::to_string(getpid()) + ".bin";
+  }
+
+  void TearDown() override {
+    std::remove(path_.c_str());
+  }
+
+  std::string path_;
+};
+
+TEST_F(SampleIndexTest, OwnedEntries) {
+  SampleIndex index;
+  EXPECT_TRUE(index.empty());
+  index.push_back(std::make_tuple(0, 10, 0));
+  index.push_back(std::make_tuple(10, 20, 0));
+  index.push_back(std::make_tuple(0, 5, 1));
+  index.push_back(std::make_tuple(5, 7, 3));
+  ASSERT_EQ(index.size(), 4u);
+  EXPECT_EQ(index[0], SampleIndex::Entry(0, 10, 0));
+  EXPECT_EQ(index[1], SampleIndex::Entry(10, 20, 0));
+  EXPECT_EQ(index[2], SampleIndex::Entry(0, 5, 1));
+  EXPECT_EQ(index[3], SampleIndex::Entry(5, 7, 3));
+}
+
+TEST_F(SampleIndexTest, MappedEntries) {
+  std::vector<IndexEntry> entries;
+  for (int i = 0; i < 1000; i++)
+    entries.push_back({i * 100, 100 - i % 7});
+  WriteBinaryIndexFile(path_, entries.data(), entries.size());
+  ASSERT_TRUE(IsBinaryIndexFile(path_));
+
+  SampleIndex index;
+  index.push_back(std::make_tuple(0, 16, 0));
+  index.MapBinaryIndexFile(path_, 1);
+  index.push_back(std::make_tuple(8, 16, 2));
+  ASSERT_EQ(index.size(), entries.size() + 2);
+  EXPECT_EQ(index[0], SampleIndex::Entry(0, 16, 0));
+  for (size_t i = 0; i < entries.size(); i++) {
+    EXPECT_EQ(index[i + 1], SampleIndex::Entry(entries[i].offset, entries[i].size, 1));
+  }
+  EXPECT_EQ(index[entries.size() + 1], SampleIndex::Entry(8, 16, 2));
+}
+
+TEST_F(SampleIndexTest, CopyAndMove) {
+  IndexEntry entry = {24, 8};
+  WriteBinaryIndexFile(path_, &entry, 1);
+  SampleIndex index;
+  index.push_back(std::make_tuple(0, 10, 0));
+  index.MapBinaryIndexFile(path_, 1);
+  index.push_back(std::make_tuple(10, 20, 2));
+
+  std::vector<SampleIndex> indices;
+  indices.push_back(index);
+  indices.push_back(std::move(index));
+  indices.resize(100);  // moves the elements
+  index.clear();
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(indices[i].size(), 3u);
+    EXPECT_EQ(indices[i][0], SampleIndex::Entry(0, 10, 0));
+    EXPECT_EQ(indices[i][1], SampleIndex::Entry(24, 8, 1));
+    EXPECT_EQ(indices[i][2], SampleIndex::Entry(10, 20, 2));
+  }
+}
+
+TEST_F(SampleIndexTest, FileOffsets) {
+  SampleIndex index;
+  for (int64 offset : {0, 40, 100, 130, 250})
+    index.push_back(std::make_tuple(offset, 10, 0));
+  // the second file is empty
+  index.SetFileOffsets({0, 100, 100, 200});
+  EXPECT_EQ(index[0], SampleIndex::Entry(0, 10, 0));
+  EXPECT_EQ(index[1], SampleIndex::Entry(40, 10, 0));
+  EXPECT_EQ(index[2], SampleIndex::Entry(0, 10, 2));
+  EXPECT_EQ(index[3], SampleIndex::Entry(30, 10, 2));
+  EXPECT_EQ(index[4], SampleIndex::Entry(50, 10, 3));
+}
+
+TEST_F(SampleIndexTest, InvalidFile) {
+  {
+    std::ofstream f(path_);
+    f << "0 100\n100 200\n";
+  }
+  EXPECT_FALSE(IsBinaryIndexFile(path_));
+  SampleIndex index;
+  EXPECT_THROW(index.MapBinaryIndexFile(path_, 0), DALIException);
+
+  IndexEntry entry = {0, 100};
+  WriteBinaryIndexFile(path_, &entry, 1);
+  EXPECT_EQ(truncate(path_.c_str(), kBinaryIndexHeaderSize + sizeof(entry) - 1), 0);
+  EXPECT_THROW(index.MapBinaryIndexFile(path_, 0), DALIException);
+  EXPECT_TRUE(index.empty());
+}
+
+}  // namespace dali
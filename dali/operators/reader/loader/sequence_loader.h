@@ -77,6 +77,13 @@ struct TensorSequence {
   std::vector<Tensor<CPUBackend>> tensors;
 };
 
+inline size_t LoadTargetBytes(const TensorSequence &target) {
+  size_t bytes = 0;
+  for (auto &tensor : target.tensors)
+    bytes += tensor.nbytes();
+  return bytes;
+}
+
 // TODO(klecki) consider using FileLoader as base class
 // TODO(klecki) ?? allow for more high level grouping of sequences:
 //              we should probably make sure that other Loaders read
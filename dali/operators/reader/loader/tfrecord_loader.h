@@ -0,0 +1,156 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_OPERATORS_READER_LOADER_TFRECORD_LOADER_H_
+#define DALI_OPERATORS_READER_LOADER_TFRECORD_LOADER_H_
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "dali/core/common.h"
+#include "dali/core/error_handling.h"
+#include "dali/operators/reader/loader/indexed_file_loader.h"
+#include "dali/util/compressed_file.h"
+#include "dali/util/crc32c.h"
+
+namespace dali {
+
+/**
+ * @brief Reads TFRecord files, which may be GZIP or ZLIB compressed.
+ *
+ * The index files are optional. Without them, the records are located by walking the headers of
+ * all the files when the metadata is prepared. If an index path is given, but the file doesn't
+ * exist yet, the index is built and saved there for the following runs.
+ * For compressed files the offsets in the index refer to the decompressed data.
+ */
+class TFRecordLoader : public IndexedFileLoader {
+ public:
+  explicit TFRecordLoader(const OpSpec& options)
+    : IndexedFileLoader(options),
+      compression_(ParseCompression(options.GetArgument<std::string>("compression"))),
+      verify_crc_(options.GetArgument<bool>("verify_crc")) {
+    // Seeking back in a compressed file decompresses it again from the start, so jumping
+    // between the blocks would decompress the files over and over in every epoch
+    DALI_ENFORCE(compression_ == Compression::NONE || shuffle_block_size_ == 0,
+                 "`shuffle_block_size` is not supported for compressed TFRecord files.");
+    if (compression_ != Compression::NONE && io_backend_ != IOBackend::MMAP) {
+      DALI_WARN("Compressed TFRecord files are always read through the decompressor, "
+                "`io_backend` is ignored.");
+    }
+  }
+
+  ~TFRecordLoader() override {}
+
+  ReadWork PrepareReadSample(Tensor<CPUBackend>& tensor) override {
+    if (compression_ != Compression::NONE) {
+      // the stream can only be decompressed sequentially, so the samples are read in order
+      ReadSample(tensor);
+      return {};
+    }
+    return IndexedFileLoader::PrepareReadSample(tensor);
+  }
+
+  void ReadIndexFile(const std::vector<std::string>& index_uris) override {
+    DALI_ENFORCE(index_uris.empty() || index_uris.size() == uris_.size(),
+        "Number of index files needs to match the number of data files");
+    for (size_t i = 0; i < uris_.size(); ++i) {
+      if (!index_uris.empty() && LoadIndexFile(index_uris[i], i))
+        continue;
+      size_t first = indices_.size();
+      BuildIndex(uris_[i], i);
+      if (!index_uris.empty())
+        SaveIndexFile(index_uris[i], first);
+    }
+  }
+
+ protected:
+  std::unique_ptr<FileStream> OpenFile(const std::string &uri) override {
+    if (compression_ == Compression::NONE)
+      return IndexedFileLoader::OpenFile(uri);
+    return std::unique_ptr<FileStream>(new CompressedFileStream(uri, compression_));
+  }
+
+  bool ReadsInBatches() const override {
+    return compression_ == Compression::NONE && IndexedFileLoader::ReadsInBatches();
+  }
+
+ private:
+  // Walks the record headers: 8 bytes of length, 4 bytes of its CRC, data, 4 bytes of data CRC
+  void BuildIndex(const std::string &uri, size_t file_index) {
+    TimeRange tr("[TFRecord] Building index", TimeRange::kBlue1);
+    auto file = OpenFile(uri);
+    const size_t file_size = compression_ == Compression::NONE ? file->Size() : 0;
+    int64 pos = 0;
+    uint8_t header[sizeof(uint64_t) + sizeof(uint32_t)];
+    while (compression_ != Compression::NONE || static_cast<size_t>(pos) < file_size) {
+      size_t n = file->Read(header, sizeof(header));
+      if (n == 0)
+        break;
+      DALI_ENFORCE(n == sizeof(header), "Truncated TFRecord file " + uri);
+      uint64_t length;
+      std::memcpy(&length, header, sizeof(length));
+      if (verify_crc_) {
+        uint32_t crc;
+        std::memcpy(&crc, header + sizeof(length), sizeof(crc));
+        DALI_ENFORCE(MaskedCrc32c(header, sizeof(length)) == crc,
+            "Corrupted record length at " + to_string(pos) + " in TFRecord file " + uri);
+      }
+      int64 size = sizeof(header) + length + sizeof(uint32_t);
+      if (compression_ == Compression::NONE) {
+        DALI_ENFORCE(static_cast<size_t>(pos + size) <= file_size,
+            "Truncated TFRecord file " + uri);
+      }
+      indices_.push_back(std::make_tuple(pos, size, file_index));
+      pos += size;
+      if (compression_ != Compression::NONE || static_cast<size_t>(pos) < file_size)
+        file->Seek(pos);
+    }
+    file->Close();
+    LOG_LINE << "TFRecord file " << uri << " has "
+             << indices_.size() << " records in total" << std::endl;
+  }
+
+  void SaveIndexFile(const std::string &index_uri, size_t first) {
+    // best effort, the index location may be read-only
+    std::string tmp_path = index_uri + ".tmp" + std::to_string(getpid());
+    {
+      std::ofstream fout(tmp_path);
+      if (!fout.good())
+        return;
+      for (size_t i = first; i < indices_.size(); i++) {
+        fout << std::get<0>(indices_[i]) << ' ' << std::get<1>(indices_[i]) << '\n';
+      }
+      if (!fout.good()) {
+        fout.close();
+        std::remove(tmp_path.c_str());
+        return;
+      }
+    }
+    if (std::rename(tmp_path.c_str(), index_uri.c_str()) != 0)
+      std::remove(tmp_path.c_str());
+  }
+
+  Compression compression_;
+  bool verify_crc_;
+};
+
+}  // namespace dali
+
+#endif  // DALI_OPERATORS_READER_LOADER_TFRECORD_LOADER_H_
@@ -30,7 +30,10 @@ DALI_SCHEMA(MXNetReader)
       R"code(List (of length 1) containing a path to index (.idx) file.
 It is generated by the MXNet's `im2rec.py` script
 together with RecordIO file. It can also be
-generated using `rec2idx` script distributed with DALI.)code",
+generated using `rec2idx` script distributed with DALI.
+The index may also be converted to the binary format with the `idx2bin` script distributed with
+DALI. Binary indices are memory mapped instead of parsed, which makes the startup faster
+and lets all the readers on a node share a single copy of the index.)code",
       DALI_STRING_VEC)
   .AddParent("LoaderBase");
 
@@ -15,32 +15,74 @@
 #ifndef DALI_OPERATORS_READER_PARSER_CAFFE_PARSER_H_
 #define DALI_OPERATORS_READER_PARSER_CAFFE_PARSER_H_
 
+#include <memory>
+
 #include "dali/operators/reader/parser/parser.h"
-#include "dali/operators/reader/parser/caffe.pb.h"
+#include "dali/operators/reader/parser/proto_wire.h"
 
 namespace dali {
 
+/**
+ * @brief Extracts the image and the label from a serialized caffe::Datum.
+ *
+ * Only the `data` and `label` fields are used, so instead of parsing the whole message
+ * the fields are located directly in the wire format. If the input shares immutable
+ * memory (LMDBLoader with `zero_copy`), the image output points into it, without any copy.
+ */
 class CaffeParser : public Parser<Tensor<CPUBackend>> {
  public:
   explicit CaffeParser(const OpSpec& spec) :
     Parser(spec) {}
 
   void Parse(const Tensor<CPUBackend>& data, SampleWorkspace* ws) override {
-    caffe::Datum datum;
-    // DALI_ENFORCE(datum.ParseFromString(string(reinterpret_cast<const char*>(data), size)));
-    DALI_ENFORCE(datum.ParseFromArray(data.raw_data(), data.size()));
+    // caffe::Datum field numbers, see proto/caffe.proto
+    const uint32_t kDataField = 4;
+    const uint32_t kLabelField = 5;
+
+    const uint8_t *datum = static_cast<const uint8_t*>(data.raw_data());
+    const uint8_t *image_data = nullptr;
+    size_t image_size = 0;
+    int label_value = 0;
+
+    ProtoWireReader reader(datum, data.nbytes());
+    uint32_t field;
+    WireType type;
+    // as in protobuf, when a field is repeated in the message, the last value wins
+    while (reader.NextField(field, type)) {
+      if (field == kDataField && type == WireType::LENGTH_DELIMITED) {
+        image_data = reader.ReadBytes(image_size);
+      } else if (field == kLabelField && type == WireType::VARINT) {
+        label_value = static_cast<int32_t>(reader.ReadVarint());
+      } else {
+        reader.Skip(type);
+      }
+    }
 
     auto& image = ws->Output<CPUBackend>(0);
     auto& label = ws->Output<CPUBackend>(1);
 
     // copy label
     label.Resize({1});
-    label.mutable_data<int>()[0] = datum.label();
+    label.mutable_data<int>()[0] = label_value;
 
-    // copy image
-    image.Resize({static_cast<Index>(datum.data().size())});
-    std::memcpy(image.mutable_data<uint8_t>(), datum.data().data(),
-                datum.data().size()*sizeof(uint8_t));
+    if (data.shares_data() && image_size > 0) {
+      // the input is a view of the database, which isn't modified until it is released
+      auto ptr = std::shared_ptr<void>(data.get_data_ptr(),
+                                       const_cast<uint8_t*>(image_data));
+      image.Reset();
+      image.ShareData(ptr, image_size, {static_cast<Index>(image_size)});
+      image.set_type(TypeInfo::Create<uint8_t>());
+    } else {
+      // copy image
+      if (image.shares_data()) {
+        image.Reset();
+      }
+      image.Resize({static_cast<Index>(image_size)});
+      auto *image_out = image.mutable_data<uint8_t>();
+      if (image_size > 0) {
+        std::memcpy(image_out, image_data, image_size * sizeof(uint8_t));
+      }
+    }
     image.SetSourceInfo(data.GetSourceInfo());
   }
 };
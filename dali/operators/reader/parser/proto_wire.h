@@ -0,0 +1,139 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_OPERATORS_READER_PARSER_PROTO_WIRE_H_
+#define DALI_OPERATORS_READER_PARSER_PROTO_WIRE_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "dali/core/error_handling.h"
+
+namespace dali {
+
+/**
+ * @brief Protobuf wire types, see https://developers.google.com/protocol-buffers/docs/encoding
+ */
+enum class WireType : uint8_t {
+  VARINT = 0,
+  FIXED64 = 1,
+  LENGTH_DELIMITED = 2,
+  START_GROUP = 3,
+  END_GROUP = 4,
+  FIXED32 = 5
+};
+
+/**
+ * @brief Walks over the fields of a serialized protobuf message without building
+ *        the message object.
+ *
+ * Length delimited fields (bytes, strings, embedded messages, packed repeated fields) are
+ * returned as pointers into the serialized data, so nothing is copied.
+ */
+class ProtoWireReader {
+ public:
+  ProtoWireReader(const uint8_t *data, size_t size) : pos_(data), end_(data + size) {}
+
+  bool Done() const {
+    return pos_ >= end_;
+  }
+
+  /**
+   * @brief Reads the key of the next field. Returns false at the end of the message.
+   */
+  bool NextField(uint32_t &field, WireType &type) {
+    if (Done())
+      return false;
+    uint64_t key = ReadVarint();
+    field = static_cast<uint32_t>(key >> 3);
+    type = static_cast<WireType>(key & 7);
+    DALI_ENFORCE(field != 0, "Invalid protobuf field number 0");
+    return true;
+  }
+
+  uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      DALI_ENFORCE(pos_ < end_, "Truncated protobuf varint");
+      uint8_t byte = *pos_++;
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return value;
+    }
+    DALI_FAIL("Malformed protobuf varint");
+  }
+
+  uint32_t ReadFixed32() {
+    uint32_t value;
+    Read(&value, sizeof(value));
+    return value;
+  }
+
+  uint64_t ReadFixed64() {
+    uint64_t value;
+    Read(&value, sizeof(value));
+    return value;
+  }
+
+  /**
+   * @brief Reads a length delimited field, returns the pointer to its payload
+   */
+  const uint8_t *ReadBytes(size_t &size) {
+    uint64_t len = ReadVarint();
+    DALI_ENFORCE(len <= static_cast<uint64_t>(end_ - pos_), "Truncated protobuf field");
+    const uint8_t *ptr = pos_;
+    pos_ += len;
+    size = len;
+    return ptr;
+  }
+
+  /**
+   * @brief Skips the value of a field of the given type
+   */
+  void Skip(WireType type) {
+    size_t size;
+    switch (type) {
+      case WireType::VARINT:
+        ReadVarint();
+        break;
+      case WireType::FIXED64:
+        ReadFixed64();
+        break;
+      case WireType::LENGTH_DELIMITED:
+        ReadBytes(size);
+        break;
+      case WireType::FIXED32:
+        ReadFixed32();
+        break;
+      default:
+        DALI_FAIL("Unsupported protobuf wire type: " +
+                  std::to_string(static_cast<int>(type)));
+    }
+  }
+
+ private:
+  void Read(void *dst, size_t size) {
+    DALI_ENFORCE(size <= static_cast<size_t>(end_ - pos_), "Truncated protobuf field");
+    std::memcpy(dst, pos_, size);
+    pos_ += size;
+  }
+
+  const uint8_t *pos_;
+  const uint8_t *end_;
+};
+
+}  // namespace dali
+
+#endif  // DALI_OPERATORS_READER_PARSER_PROTO_WIRE_H_
@@ -0,0 +1,91 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "dali/operators/reader/parser/proto_wire.h"
+#include "dali/operators/reader/parser/caffe.pb.h"
+
+namespace dali {
+
+namespace {
+
+void ScanDatum(const std::string &serialized, std::string &data, int &label) {
+  ProtoWireReader reader(reinterpret_cast<const uint8_t*>(serialized.data()), serialized.size());
+  uint32_t field;
+  WireType type;
+  label = 0;
+  data.clear();
+  while (reader.NextField(field, type)) {
+    if (field == 4 && type == WireType::LENGTH_DELIMITED) {
+      size_t size;
+      const uint8_t *ptr = reader.ReadBytes(size);
+      data.assign(reinterpret_cast<const char*>(ptr), size);
+    } else if (field == 5 && type == WireType::VARINT) {
+      label = static_cast<int32_t>(reader.ReadVarint());
+    } else {
+      reader.Skip(type);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(ProtoWireReader, CaffeDatum) {
+  caffe::Datum datum;
+  datum.set_channels(3);
+  datum.set_height(480);
+  datum.set_width(640);
+  datum.set_data(std::string("\xff\xd8\x00\x01jpeg", 8));
+  datum.set_label(-7);
+  datum.add_float_data(0.5f);
+  datum.add_float_data(1.5f);
+  datum.set_encoded(true);
+  std::string serialized;
+  ASSERT_TRUE(datum.SerializeToString(&serialized));
+
+  std::string data;
+  int label;
+  ScanDatum(serialized, data, label);
+  EXPECT_EQ(data, datum.data());
+  EXPECT_EQ(label, datum.label());
+}
+
+TEST(ProtoWireReader, MissingFields) {
+  caffe::Datum datum;
+  datum.set_channels(1);
+  std::string serialized;
+  ASSERT_TRUE(datum.SerializeToString(&serialized));
+
+  std::string data = "x";
+  int label = 1;
+  ScanDatum(serialized, data, label);
+  EXPECT_TRUE(data.empty());
+  EXPECT_EQ(label, 0);
+}
+
+TEST(ProtoWireReader, Truncated) {
+  caffe::Datum datum;
+  datum.set_data(std::string(100, 'a'));
+  std::string serialized;
+  ASSERT_TRUE(datum.SerializeToString(&serialized));
+  serialized.resize(serialized.size() - 1);
+
+  std::string data;
+  int label;
+  EXPECT_THROW(ScanDatum(serialized, data, label), DALIException);
+}
+
+}  // namespace dali
@@ -16,6 +16,7 @@
 #include <memory>
 
 #include "dali/operators/reader/parser/sequence_parser.h"
+#include "dali/core/tensor_shape_print.h"
 #include "dali/image/image_factory.h"
 
 namespace dali {
@@ -26,50 +27,36 @@ void SequenceParser::Parse(const TensorSequence& data, SampleWorkspace* ws) {
   sequence.set_type(TypeInfo::Create<uint8_t>());
   Index seq_length = data.tensors.size();
 
-  // Decode first frame, obtain it's size and allocate output
-  {
-    auto file_name = data.tensors[0].GetSourceInfo();
-    std::unique_ptr<Image> img;
-
-    try {
-      img = ImageFactory::CreateImage(
-        data.tensors[0].data<uint8_t>(), data.tensors[0].size(), image_type_);
-      img->Decode();
-    } catch (std::exception &e) {
-      DALI_FAIL(e.what() + " File: " + file_name);
-    }
-    const auto decoded = img->GetImage();
-
-    const auto shape = img->GetShape();
-    const Index h = shape[0];
-    const Index w = shape[1];
-    const Index c = shape[2];
-    const auto frame_size = volume(shape);
-
-    // Calculate shape of sequence tensor, that is Frames x (Frame Shape)
-    auto seq_shape = std::vector<Index>{seq_length, h, w, c};
-    sequence.Resize(seq_shape);
-    // Take a view tensor for first frame and copy it to target sequence
-    auto view_0 = sequence.SubspaceTensor(0);
-    std::memcpy(view_0.raw_mutable_data(), decoded.get(), frame_size);
-  }
-
-  // Decode and copy rest of the frames
-  for (Index frame = 1; frame < seq_length; frame++) {
-    auto view_tensor = sequence.SubspaceTensor(frame);
+  // The frames are decoded straight into the sequence tensor. The first one
+  // determines the frame shape and allocates the output.
+  Image::Shape frame_shape;
+  // The decoder may ask for the output more than once and the first shape it asks for is only
+  // tentative (e.g. before the EXIF orientation is applied), so the frames that don't match
+  // go here and only the final shape is checked
+  std::vector<uint8_t> mismatched_frame;
+  for (Index frame = 0; frame < seq_length; frame++) {
     auto file_name = data.tensors[frame].GetSourceInfo();
     std::unique_ptr<Image> img;
     try {
       img = ImageFactory::CreateImage(data.tensors[frame].data<uint8_t>(),
                                       data.tensors[frame].size(), image_type_);
-      img->Decode();
+      auto decoded_shape = img->DecodeTo([&](const Image::Shape &shape) {
+        if (frame == 0) {
+          // Calculate shape of sequence tensor, that is Frames x (Frame Shape)
+          frame_shape = shape;
+          sequence.Resize(std::vector<Index>{seq_length, shape[0], shape[1], shape[2]});
+        } else if (shape != frame_shape) {
+          mismatched_frame.resize(volume(shape));
+          return mismatched_frame.data();
+        }
+        return sequence.mutable_data<uint8_t>() + frame * volume(frame_shape);
+      });
+      DALI_ENFORCE(decoded_shape == frame_shape,
+                   "Frames do not match in dimensions: " + to_string(decoded_shape) + " vs " +
+                   to_string(frame_shape));
     } catch (std::exception &e) {
       DALI_FAIL(e.what() + " File: " + file_name);
     }
-    img->GetImage(view_tensor.mutable_data<uint8_t>());
-    DALI_ENFORCE(view_tensor.shares_data(),
-                 "Buffer view was invalidated after image decoding, frames do not match in "
-                 "dimensions");
   }
 }
 
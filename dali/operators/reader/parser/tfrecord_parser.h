@@ -17,27 +17,41 @@
 
 #ifdef DALI_BUILD_PROTO3
 
-#include <vector>
-#include <string>
-#include <exception>
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include "dali/core/common.h"
+#include "dali/core/small_vector.h"
 #include "dali/pipeline/operator/argument.h"
 #include "dali/pipeline/operator/op_spec.h"
 #include "dali/operators/reader/parser/parser.h"
+#include "dali/operators/reader/parser/proto_wire.h"
 #include "dali/operators/reader/parser/tf_feature.h"
-#include "dali/operators/reader/parser/example.pb.h"
+#include "dali/util/crc32c.h"
 
 namespace dali {
 
+/**
+ * @brief Extracts the requested features from a TFRecord holding a tensorflow.Example.
+ *
+ * The Example isn't materialized, the features are located directly in the protobuf wire
+ * format and decoded straight into the outputs. If the record is a view of immutable memory
+ * (memory mapped file), bytes features point into it instead of being copied.
+ */
 class TFRecordParser : public Parser<Tensor<CPUBackend>> {
  public:
   using FeatureType = TFUtil::FeatureType;
   using Feature = TFUtil::Feature;
 
   explicit TFRecordParser(const OpSpec& spec) :
-    Parser<Tensor<CPUBackend>>(spec) {
+    Parser<Tensor<CPUBackend>>(spec),
+    verify_crc_(spec.GetArgument<bool>("verify_crc")) {
     feature_names_ = spec.GetRepeatedArgument<string>("feature_names");
     features_ = spec.GetRepeatedArgument<Feature>("features");
     DALI_ENFORCE(feature_names_.size() == features_.size(),
@@ -47,20 +61,36 @@ class TFRecordParser : public Parser<Tensor<CPUBackend>> {
   }
 
   void Parse(const Tensor<CPUBackend>& data, SampleWorkspace* ws) override {
-    tensorflow::Example example;
-
     uint64_t length;
     uint32_t crc;
 
     const uint8_t* raw_data = data.data<uint8_t>();
+    DALI_ENFORCE(static_cast<size_t>(data.nbytes()) >= sizeof(length) + sizeof(crc),
+        "Error while parsing TFRecord: invalid TFRecord file!");
 
     std::memcpy(&length, raw_data, sizeof(length));
 
     // Omit length and crc
     raw_data = raw_data + sizeof(length) + sizeof(crc);
+    DALI_ENFORCE(length <= data.nbytes() - sizeof(length) - sizeof(crc),
+        "Error while parsing TFRecord: invalid TFRecord file!");
+
+    if (verify_crc_) {
+      const uint8_t* header = data.data<uint8_t>();
+      std::memcpy(&crc, header + sizeof(length), sizeof(crc));
+      DALI_ENFORCE(MaskedCrc32c(header, sizeof(length)) == crc,
+          "Corrupted length of the TFRecord " + data.GetSourceInfo());
+      DALI_ENFORCE(length + sizeof(crc) <= data.nbytes() - sizeof(length) - sizeof(crc),
+          "Error while parsing TFRecord: invalid TFRecord file!");
+      std::memcpy(&crc, raw_data + length, sizeof(crc));
+      DALI_ENFORCE(MaskedCrc32c(raw_data, length) == crc,
+          "Corrupted data of the TFRecord " + data.GetSourceInfo());
+    }
+
+    SmallVector<Span, 8> encoded_features;
+    encoded_features.resize(features_.size());
     try {
-      DALI_ENFORCE(example.ParseFromArray(raw_data, length),
-          "Error in parsing - invalid TFRecord file!");
+      FindFeatures(raw_data, length, encoded_features);
     } catch (std::exception& e) {
       std::string str = "Error while parsing TFRecord: " + std::string(e.what());
       DALI_FAIL(str);
@@ -69,8 +99,11 @@ class TFRecordParser : public Parser<Tensor<CPUBackend>> {
     for (size_t i = 0; i < features_.size(); ++i) {
       auto& output = ws->Output<CPUBackend>(i);
       Feature& f = features_[i];
-      std::string& name = feature_names_[i];
-      auto& encoded_feature = example.features().feature().at(name);
+      DALI_ENFORCE(encoded_features[i].data != nullptr,
+          "Feature \"" + feature_names_[i] + "\" not found in the TFRecord");
+      if (output.shares_data()) {
+        output.Reset();
+      }
       if (f.HasShape() && f.GetType() != FeatureType::string) {
         if (f.Shape().empty()) {
           output.Resize({1});
@@ -80,29 +113,16 @@ class TFRecordParser : public Parser<Tensor<CPUBackend>> {
       }
       switch (f.GetType()) {
         case FeatureType::int64:
-          if (!f.HasShape()) {
-            output.Resize(InferShape(f, encoded_feature.int64_list().value().size()));
-          }
-          std::memcpy(output.mutable_data<int64_t>(),
-              encoded_feature.int64_list().value().data(),
-              encoded_feature.int64_list().value().size()*sizeof(int64_t));
+          ParseList<int64_t>(encoded_features[i], kInt64ListField, f, output);
           break;
         case FeatureType::string:
           if (!f.HasShape() || volume(f.Shape()) > 1) {
             DALI_FAIL("Tensors of strings are not supported.");
           }
-          output.Resize({static_cast<Index>(encoded_feature.bytes_list().value(0).size())});
-          std::memcpy(output.mutable_data<uint8_t>(),
-              encoded_feature.bytes_list().value(0).c_str(),
-              encoded_feature.bytes_list().value(0).size()*sizeof(uint8_t));
+          ParseBytes(data, encoded_features[i], output);
           break;
         case FeatureType::float32:
-          if (!f.HasShape()) {
-            output.Resize(InferShape(f, encoded_feature.float_list().value().size()));
-          }
-          std::memcpy(output.mutable_data<float>(),
-              encoded_feature.float_list().value().data(),
-              encoded_feature.float_list().value().size()*sizeof(float));
+          ParseList<float>(encoded_features[i], kFloatListField, f, output);
           break;
       }
       output.SetSourceInfo(data.GetSourceInfo());
@@ -112,6 +132,189 @@ class TFRecordParser : public Parser<Tensor<CPUBackend>> {
  private:
   std::vector<std::string> feature_names_;
   std::vector<Feature> features_;
+  bool verify_crc_;
+
+  struct Span {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+  };
+
+  // Field numbers, see proto/example.proto and proto/feature.proto
+  static constexpr uint32_t kFeaturesField = 1;         // Example.features
+  static constexpr uint32_t kFeatureMapField = 1;       // Features.feature
+  static constexpr uint32_t kMapKeyField = 1;
+  static constexpr uint32_t kMapValueField = 2;
+  static constexpr uint32_t kBytesListField = 1;        // Feature.bytes_list
+  static constexpr uint32_t kFloatListField = 2;        // Feature.float_list
+  static constexpr uint32_t kInt64ListField = 3;        // Feature.int64_list
+  static constexpr uint32_t kListValueField = 1;        // *List.value
+
+  /**
+   * @brief Locates the encoded tensorflow.Feature messages of the requested features.
+   *        As in protobuf, if a key repeats, the last entry wins.
+   */
+  void FindFeatures(const uint8_t *example, size_t size, SmallVector<Span, 8> &found) const {
+    ProtoWireReader example_reader(example, size);
+    uint32_t field;
+    WireType type;
+    while (example_reader.NextField(field, type)) {
+      if (field != kFeaturesField || type != WireType::LENGTH_DELIMITED) {
+        example_reader.Skip(type);
+        continue;
+      }
+      Span features;
+      features.data = example_reader.ReadBytes(features.size);
+      ProtoWireReader features_reader(features.data, features.size);
+      while (features_reader.NextField(field, type)) {
+        if (field != kFeatureMapField || type != WireType::LENGTH_DELIMITED) {
+          features_reader.Skip(type);
+          continue;
+        }
+        Span entry, key, value;
+        entry.data = features_reader.ReadBytes(entry.size);
+        ProtoWireReader entry_reader(entry.data, entry.size);
+        while (entry_reader.NextField(field, type)) {
+          if (field == kMapKeyField && type == WireType::LENGTH_DELIMITED) {
+            key.data = entry_reader.ReadBytes(key.size);
+          } else if (field == kMapValueField && type == WireType::LENGTH_DELIMITED) {
+            value.data = entry_reader.ReadBytes(value.size);
+          } else {
+            entry_reader.Skip(type);
+          }
+        }
+        int idx = FindFeatureName(key);
+        if (idx >= 0) {
+          // a missing value is an empty Feature, use a valid pointer to mark it as found
+          found[idx] = value.data ? value : Span{entry.data, 0};
+        }
+      }
+    }
+  }
+
+  int FindFeatureName(const Span &key) const {
+    for (size_t i = 0; i < feature_names_.size(); i++) {
+      const auto &name = feature_names_[i];
+      if (name.size() == key.size && std::memcmp(name.data(), key.data, key.size) == 0)
+        return i;
+    }
+    return -1;
+  }
+
+  /**
+   * @brief Returns the list message of the given kind from the encoded Feature.
+   *        If the Feature holds another kind, the list is empty.
+   */
+  static Span FindList(const Span &feature, uint32_t list_field) {
+    ProtoWireReader reader(feature.data, feature.size);
+    Span list;
+    uint32_t field;
+    WireType type;
+    while (reader.NextField(field, type)) {
+      if (type == WireType::LENGTH_DELIMITED &&
+          field >= kBytesListField && field <= kInt64ListField) {
+        // `kind` is a oneof, the last one set wins
+        Span s;
+        s.data = reader.ReadBytes(s.size);
+        list = field == list_field ? s : Span();
+      } else {
+        reader.Skip(type);
+      }
+    }
+    return list;
+  }
+
+  static int64_t ReadValue(ProtoWireReader &reader, int64_t *) {
+    return static_cast<int64_t>(reader.ReadVarint());
+  }
+
+  static float ReadValue(ProtoWireReader &reader, float *) {
+    uint32_t bits = reader.ReadFixed32();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  /**
+   * @brief Decodes the values of Int64List or FloatList, both packed and unpacked.
+   *        With `out` == nullptr the values are only counted.
+   */
+  template <typename T>
+  static size_t DecodeList(const Span &list, T *out, size_t capacity) {
+    const WireType value_type = std::is_same<T, float>::value ? WireType::FIXED32
+                                                              : WireType::VARINT;
+    size_t count = 0;
+    auto store = [&](ProtoWireReader &reader) {
+      T value = ReadValue(reader, static_cast<T*>(nullptr));
+      if (out) {
+        DALI_ENFORCE(count < capacity, "Feature has more values than its shape allows");
+        out[count] = value;
+      }
+      count++;
+    };
+    ProtoWireReader reader(list.data, list.size);
+    uint32_t field;
+    WireType type;
+    while (reader.NextField(field, type)) {
+      if (field != kListValueField) {
+        reader.Skip(type);
+      } else if (type == WireType::LENGTH_DELIMITED) {
+        Span packed;
+        packed.data = reader.ReadBytes(packed.size);
+        ProtoWireReader packed_reader(packed.data, packed.size);
+        while (!packed_reader.Done())
+          store(packed_reader);
+      } else if (type == value_type) {
+        store(reader);
+      } else {
+        reader.Skip(type);
+      }
+    }
+    return count;
+  }
+
+  template <typename T>
+  void ParseList(const Span &feature, uint32_t list_field, Feature &f,
+                 Tensor<CPUBackend> &output) {
+    Span list = FindList(feature, list_field);
+    if (!f.HasShape()) {
+      size_t count = DecodeList<T>(list, nullptr, 0);
+      output.Resize(InferShape(f, count));
+    }
+    DecodeList<T>(list, output.mutable_data<T>(), output.size());
+  }
+
+  void ParseBytes(const Tensor<CPUBackend> &data, const Span &feature,
+                  Tensor<CPUBackend> &output) {
+    Span list = FindList(feature, kBytesListField);
+    Span value;
+    bool found = false;
+    ProtoWireReader reader(list.data, list.size);
+    uint32_t field;
+    WireType type;
+    // only the first value is used
+    while (!found && reader.NextField(field, type)) {
+      if (field == kListValueField && type == WireType::LENGTH_DELIMITED) {
+        value.data = reader.ReadBytes(value.size);
+        found = true;
+      } else {
+        reader.Skip(type);
+      }
+    }
+    DALI_ENFORCE(found, "Bytes feature has no value");
+
+    if (data.shares_data() && value.size > 0) {
+      // the record is a view of a memory mapped file, which isn't modified
+      auto ptr = std::shared_ptr<void>(data.get_data_ptr(), const_cast<uint8_t*>(value.data));
+      output.ShareData(ptr, value.size, {static_cast<Index>(value.size)});
+      output.set_type(TypeInfo::Create<uint8_t>());
+    } else {
+      output.Resize({static_cast<Index>(value.size)});
+      auto *out = output.mutable_data<uint8_t>();
+      if (value.size > 0) {
+        std::memcpy(out, value.data, value.size * sizeof(uint8_t));
+      }
+    }
+  }
 
   std::vector<Index> InferShape(Feature& feature, size_t feature_size) {
     if (feature.HasPartialShape()) {
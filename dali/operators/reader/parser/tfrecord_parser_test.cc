@@ -0,0 +1,145 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef DALI_BUILD_PROTO3
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dali/operators/reader/parser/tfrecord_parser.h"
+#include "dali/operators/reader/parser/example.pb.h"
+#include "dali/pipeline/workspace/sample_workspace.h"
+#include "dali/util/crc32c.h"
+
+namespace dali {
+
+namespace {
+
+// Wraps the serialized Example in the TFRecord framing
+std::vector<uint8_t> MakeRecord(const tensorflow::Example &example) {
+  std::string payload;
+  EXPECT_TRUE(example.SerializeToString(&payload));
+  uint64_t length = payload.size();
+  uint32_t length_crc = MaskedCrc32c(&length, sizeof(length));
+  uint32_t data_crc = MaskedCrc32c(payload.data(), payload.size());
+  std::vector<uint8_t> record(sizeof(length) + 4 + payload.size() + 4, 0);
+  std::memcpy(record.data(), &length, sizeof(length));
+  std::memcpy(record.data() + sizeof(length), &length_crc, 4);
+  std::memcpy(record.data() + sizeof(length) + 4, payload.data(), payload.size());
+  std::memcpy(record.data() + sizeof(length) + 4 + payload.size(), &data_crc, 4);
+  return record;
+}
+
+}  // namespace
+
+class TFRecordParserTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto &features = *example_.mutable_features()->mutable_feature();
+    auto *ints = features["ints"].mutable_int64_list();
+    for (int64_t v : {1ll, -2ll, 1ll << 40})
+      ints->add_value(v);
+    auto *floats = features["floats"].mutable_float_list();
+    for (float v : {0.5f, -1.25f, 3.f, 4.f})
+      floats->add_value(v);
+    features["image"].mutable_bytes_list()->add_value(std::string("\xff\xd8jpeg\x00", 7));
+    features["unused"].mutable_bytes_list()->add_value("unused");
+    record_ = MakeRecord(example_);
+  }
+
+  void Parse(bool share, bool verify_crc = true) {
+    Tensor<CPUBackend> input;
+    if (share) {
+      input.ShareData(record_.data(), record_.size(), {static_cast<Index>(record_.size())});
+    } else {
+      input.Resize({static_cast<Index>(record_.size())});
+      std::memcpy(input.mutable_data<uint8_t>(), record_.data(), record_.size());
+    }
+    input.set_type(TypeInfo::Create<uint8_t>());
+
+    std::vector<TFUtil::Feature> features = {
+      TFUtil::Feature(TFUtil::FeatureType::float32, {}, {2}),
+      TFUtil::Feature({1}, TFUtil::FeatureType::string, {}),
+      TFUtil::Feature(TFUtil::FeatureType::int64, {}),
+    };
+    std::vector<std::string> names = {"floats", "image", "ints"};
+    TFRecordParser parser(OpSpec("_TFRecordReader")
+                          .AddArg("feature_names", names)
+                          .AddArg("features", features)
+                          .AddArg("verify_crc", verify_crc));
+
+    SampleWorkspace ws;
+    for (size_t i = 0; i < features.size(); i++) {
+      outputs_[i] = std::make_shared<Tensor<CPUBackend>>();
+      ws.AddOutput(outputs_[i]);
+    }
+    parser.Parse(input, &ws);
+
+    image_shared_ = outputs_[1]->raw_data() >= static_cast<void*>(record_.data()) &&
+                    outputs_[1]->raw_data() < static_cast<void*>(record_.data() + record_.size());
+  }
+
+  void CheckOutputs() {
+    auto &features = example_.features().feature();
+    const auto &floats = features.at("floats").float_list().value();
+    ASSERT_EQ(outputs_[0]->shape(), TensorShape<>(2, 2));
+    for (int i = 0; i < floats.size(); i++)
+      EXPECT_EQ(outputs_[0]->data<float>()[i], floats[i]);
+
+    const auto &image = features.at("image").bytes_list().value(0);
+    ASSERT_EQ(outputs_[1]->size(), static_cast<Index>(image.size()));
+    EXPECT_EQ(std::memcmp(outputs_[1]->raw_data(), image.data(), image.size()), 0);
+
+    const auto &ints = features.at("ints").int64_list().value();
+    ASSERT_EQ(outputs_[2]->size(), ints.size());
+    for (int i = 0; i < ints.size(); i++)
+      EXPECT_EQ(outputs_[2]->data<int64_t>()[i], ints[i]);
+  }
+
+  tensorflow::Example example_;
+  std::vector<uint8_t> record_;
+  std::shared_ptr<Tensor<CPUBackend>> outputs_[3];
+  bool image_shared_ = false;
+};
+
+TEST_F(TFRecordParserTest, Copy) {
+  Parse(false);
+  CheckOutputs();
+  EXPECT_FALSE(image_shared_);
+}
+
+TEST_F(TFRecordParserTest, ZeroCopyBytes) {
+  Parse(true);
+  CheckOutputs();
+  EXPECT_TRUE(image_shared_);
+}
+
+TEST_F(TFRecordParserTest, CorruptedRecord) {
+  record_[record_.size() / 2] ^= 1;
+  EXPECT_THROW(Parse(false), DALIException);
+  EXPECT_NO_THROW(Parse(false, false));
+}
+
+TEST_F(TFRecordParserTest, MissingFeature) {
+  example_.mutable_features()->mutable_feature()->erase("ints");
+  record_ = MakeRecord(example_);
+  EXPECT_THROW(Parse(false), DALIException);
+}
+
+}  // namespace dali
+
+#endif  // DALI_BUILD_PROTO3
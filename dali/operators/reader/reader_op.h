@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <memory>
 #include <string>
 #include <thread>
@@ -25,6 +26,7 @@
 #include <unordered_map>
 
 #include "dali/operators/reader/loader/loader.h"
+#include "dali/operators/reader/loader/prefetch_depth.h"
 #include "dali/operators/reader/parser/parser.h"
 #include "dali/pipeline/operator/operator.h"
 
@@ -59,13 +61,21 @@ class DataReader : public Operator<Backend> {
         prefetched_batch_queue_(prefetch_queue_depth_),
         curr_batch_consumer_(0),
         curr_batch_producer_(0),
-        consumer_cycle_(false),
-        producer_cycle_(false),
+        queued_batches_(0),
         device_id_(-1),
         samples_processed_(0) {
           if (std::is_same<Backend, GPUBackend>::value) {
             device_id_ = spec.GetArgument<int>("device_id");
           }
+          if (spec.GetArgument<bool>("adaptive_prefetch")) {
+            int max_depth = spec.GetArgument<int>("max_prefetch_queue_depth");
+            int budget_mb = spec.GetArgument<int>("prefetch_memory_budget");
+            DALI_ENFORCE(budget_mb >= 0, "prefetch_memory_budget can't be negative");
+            depth_controller_.reset(new PrefetchDepthController(
+                prefetch_queue_depth_, max_depth, static_cast<size_t>(budget_mb) << 20));
+            // the slots are cheap, the memory is taken by the samples put in them
+            prefetched_batch_queue_.resize(max_depth);
+          }
         }
 
   ~DataReader() noexcept override {
@@ -82,25 +92,32 @@ class DataReader : public Operator<Backend> {
     // We actually prepare the next batch
     TimeRange tr("DataReader::Prefetch #" + to_string(curr_batch_producer_), TimeRange::kRed);
     auto &curr_batch = prefetched_batch_queue_[curr_batch_producer_];
-    curr_batch.reserve(Operator<Backend>::batch_size_);
-    curr_batch.clear();
-    for (int i = 0; i < Operator<Backend>::batch_size_; ++i) {
-      curr_batch.push_back(loader_->ReadOne(i == 0));
-    }
+    loader_->ReadBatch(curr_batch, Operator<Backend>::batch_size_);
   }
 
   // Main prefetch work loop
   void PrefetchWorker() {
     DeviceGuard g(device_id_);
+    Tracer::SetThreadName("DataReader prefetch " + this->spec_.name());
     ProducerWait();
     while (!finished_) {
+      size_t batch_bytes = 0;
       try {
         Prefetch();
+        if (checkpointing_) {
+          prefetched_states_[curr_batch_producer_] = loader_->SaveState();
+        }
+        if (depth_controller_) {
+          for (auto &sample : prefetched_batch_queue_[curr_batch_producer_]) {
+            if (sample)
+              batch_bytes += LoadTargetBytes(*sample);
+          }
+        }
       } catch (const std::exception& e) {
         ProducerStop(std::current_exception());
         return;
       }
-      ProducerAdvanceQueue();
+      ProducerAdvanceQueue(batch_bytes);
       ProducerWait();
     }
   }
@@ -141,6 +158,7 @@ class DataReader : public Operator<Backend> {
     Operator<Backend>::Run(ws);
 
     // Notify that we have consumed whole batch
+    RecordConsumedState();
     ConsumerAdvanceQueue();
   }
 
@@ -158,6 +176,7 @@ class DataReader : public Operator<Backend> {
     }
 
     // Notify we have consumed a batch
+    RecordConsumedState();
     ConsumerAdvanceQueue();
   }
 
@@ -165,6 +184,47 @@ class DataReader : public Operator<Backend> {
     return loader_->Size();
   }
 
+  bool HasState() const override {
+    return true;
+  }
+
+  void EnableCheckpointing() override {
+    DALI_ENFORCE(loader_->SupportsCheckpointing(),
+                 "Checkpointing is not supported by " + this->spec_.name() +
+                 " with the given arguments");
+    DALI_ENFORCE(!prefetch_thread_.joinable(),
+                 "Checkpointing has to be enabled before the first run");
+    checkpointing_ = true;
+    prefetched_states_.resize(prefetched_batch_queue_.size());
+    ResetStateHistory(loader_->SaveState());
+  }
+
+  /**
+   * @brief Returns the state of the loader after the first `iteration` batches were consumed.
+   *
+   * The batches prefetched so far are read again after restoring the state.
+   */
+  std::string SaveState(int64_t iteration) override {
+    DALI_ENFORCE(checkpointing_, "Checkpointing is not enabled for " + this->spec_.name());
+    std::lock_guard<std::mutex> lock(state_history_mutex_);
+    int64_t idx = iteration - state_history_begin_;
+    DALI_ENFORCE(idx >= 0 && idx < static_cast<int64_t>(state_history_.size()),
+                 make_string("The state of ", this->spec_.name(), " after ", iteration,
+                             " iterations is not available"));
+    // the iterations only move forward, so the older states won't be needed
+    state_history_.erase(state_history_.begin(), state_history_.begin() + idx);
+    state_history_begin_ = iteration;
+    return state_history_.front();
+  }
+
+  void RestoreState(const std::string &state) override {
+    DALI_ENFORCE(checkpointing_, "Checkpointing is not enabled for " + this->spec_.name());
+    DALI_ENFORCE(!prefetch_thread_.joinable(),
+                 "The state can only be restored before the first run");
+    loader_->RestoreState(state);
+    ResetStateHistory(state);
+  }
+
   LoadTarget& GetSample(int sample_idx) {
     return *prefetched_batch_queue_[curr_batch_consumer_][sample_idx];
   }
@@ -197,6 +257,10 @@ class DataReader : public Operator<Backend> {
         "Unexpected number of outputs");
       for (std::size_t i = 0; i < cached_outputs.size(); i++) {
         auto& output = ws->Output<CPUBackend>(i);
+        // zero-copy parsers may leave the output pointing to the previous sample
+        if (output.shares_data()) {
+          output.Reset();
+        }
         output.Copy(cached_outputs[i], 0);
       }
       return;
@@ -237,48 +301,87 @@ class DataReader : public Operator<Backend> {
     consumer_.notify_all();
   }
 
-  void ProducerAdvanceQueue() {
+  void ProducerAdvanceQueue(size_t batch_bytes = 0) {
     {
       std::lock_guard<std::mutex> lock(prefetch_access_mutex_);
-      AdvanceIndex(curr_batch_producer_, producer_cycle_);
+      AdvanceIndex(curr_batch_producer_);
+      queued_batches_++;
+      if (depth_controller_)
+        depth_controller_->AddBatchBytes(batch_bytes);
     }
     consumer_.notify_all();
   }
 
   void ProducerWait() {
     std::unique_lock<std::mutex> lock(prefetch_access_mutex_);
+    // the time the producer has to spare
+    bool idle = depth_controller_ && !finished_ && IsPrefetchQueueFull();
+    int64_t start = idle ? stats_now_ns() : 0;
     producer_.wait(lock, [&]() { return finished_ || !IsPrefetchQueueFull(); });
+    if (idle)
+      depth_controller_->AddProducerIdle(stats_now_ns() - start);
   }
 
   void ConsumerWait() {
     TimeRange tr("DataReader::ConsumerWait #" + to_string(curr_batch_consumer_),
                  TimeRange::kMagenta);
+    int64_t start = stats_now_ns();
     std::unique_lock<std::mutex> prefetch_lock(prefetch_access_mutex_);
     consumer_.wait(prefetch_lock, [this]() { return finished_ || !IsPrefetchQueueEmpty(); });
+    int64_t wait_time = stats_now_ns() - start;
+    this->stats().AddWait(wait_time);
+    if (depth_controller_)
+      depth_controller_->AddConsumerWait(wait_time);
     if (prefetch_error_) std::rethrow_exception(prefetch_error_);
   }
 
   void ConsumerAdvanceQueue() {
+    int shrunk_depth = 0;
     {
       std::lock_guard<std::mutex> lock(prefetch_access_mutex_);
-      AdvanceIndex(curr_batch_consumer_, consumer_cycle_);
+      AdvanceIndex(curr_batch_consumer_);
+      queued_batches_--;
+      if (depth_controller_ && depth_controller_->BatchConsumed(stats_now_ns())) {
+        int depth = depth_controller_->depth();
+        if (depth < prefetch_queue_depth_)
+          shrunk_depth = depth;
+        prefetch_queue_depth_ = depth;
+      }
     }
     producer_.notify_one();
+    if (shrunk_depth > 0)
+      loader_->TrimEmptyTensors(shrunk_depth);
   }
 
-  void AdvanceIndex(int& index, bool& cycle) {
-    index = (index + 1) % prefetch_queue_depth_;
-    if (index == 0) cycle = !cycle;
+  // Keeps the state of the loader after the batch being consumed
+  void RecordConsumedState() {
+    if (!checkpointing_)
+      return;
+    std::lock_guard<std::mutex> lock(state_history_mutex_);
+    state_history_.push_back(std::move(prefetched_states_[curr_batch_consumer_]));
+    if (state_history_.size() > kMaxStateHistory) {
+      state_history_.pop_front();
+      state_history_begin_++;
+    }
+  }
+
+  void ResetStateHistory(std::string state) {
+    std::lock_guard<std::mutex> lock(state_history_mutex_);
+    state_history_.clear();
+    state_history_.push_back(std::move(state));
+    state_history_begin_ = 0;
+  }
+
+  void AdvanceIndex(int& index) {
+    index = (index + 1) % prefetched_batch_queue_.size();
   }
 
   bool IsPrefetchQueueEmpty() {
-    return curr_batch_producer_ == curr_batch_consumer_
-           && consumer_cycle_ == producer_cycle_;
+    return queued_batches_ == 0;
   }
 
   bool IsPrefetchQueueFull() {
-    return curr_batch_producer_ == curr_batch_consumer_
-           && consumer_cycle_ != producer_cycle_;
+    return queued_batches_ >= prefetch_queue_depth_;
   }
 
   std::thread prefetch_thread_;
@@ -293,22 +396,38 @@ class DataReader : public Operator<Backend> {
   std::atomic<bool> finished_;
 
   // prefetched batch
+  // number of batches the prefetch thread may read ahead, changes with `adaptive_prefetch`
   int prefetch_queue_depth_;
   bool skip_cached_images_;
   using BatchQueueElement = std::vector<LoadTargetPtr>;
+  // ring buffer of the batches, big enough for the maximum depth
   std::vector<BatchQueueElement> prefetched_batch_queue_;
   int curr_batch_consumer_;
   int curr_batch_producer_;
-  bool consumer_cycle_;
-  bool producer_cycle_;
+  // batches read and not consumed yet, including the one being consumed
+  int queued_batches_;
   int device_id_;
 
+  // adjusts `prefetch_queue_depth_` with `adaptive_prefetch`, null otherwise
+  std::unique_ptr<PrefetchDepthController> depth_controller_;
+
   // keep track of how many samples have been processed over all threads.
   std::atomic<int> samples_processed_;
 
   // stores any catched exceptions in the prefetch worker
   std::exception_ptr prefetch_error_;
 
+  // whether the states of the loader are recorded for the checkpoints
+  bool checkpointing_ = false;
+  // states of the loader after reading each batch of the prefetch queue
+  std::vector<std::string> prefetched_states_;
+  // states after the recently consumed batches, the first one after
+  // `state_history_begin_` batches. The pipeline doesn't run that far ahead of its outputs.
+  static constexpr size_t kMaxStateHistory = 64;
+  std::mutex state_history_mutex_;
+  std::deque<std::string> state_history_;
+  int64_t state_history_begin_ = 0;
+
   // Loader
   std::unique_ptr<Loader<Backend, LoadTarget>> loader_;
 
@@ -14,8 +14,14 @@
 
 
 #include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <chrono>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
 #include <string>
 #include <thread>
 #include <utility>
@@ -28,6 +34,7 @@
 #include "dali/pipeline/workspace/sample_workspace.h"
 #include "dali/test/dali_test.h"
 #include "dali/test/dali_test_config.h"
+#include "dali/test/dali_test_decoder.h"
 
 namespace dali {
 
@@ -247,6 +254,87 @@ TYPED_TEST(ReaderTest, SequenceTest) {
   return;
 }
 
+TYPED_TEST(ReaderTest, SequenceMismatchedFrames) {
+  char tmpl[] = "/tmp/dali_sequence_XXXXXX";
+  ASSERT_NE(mkdtemp(tmpl), nullptr);
+  std::string root = tmpl;
+  ASSERT_EQ(mkdir((root + "/video").c_str(), 0755), 0);
+  // the frames are decoded straight into the sequence, which has the shape of the first one
+  std::vector<std::string> frames = {root + "/video/0.png", root + "/video/1.png"};
+  ASSERT_TRUE(cv::imwrite(frames[0], cv::Mat(16, 16, CV_8UC3, cv::Scalar(1, 2, 3))));
+  ASSERT_TRUE(cv::imwrite(frames[1], cv::Mat(16, 24, CV_8UC3, cv::Scalar(1, 2, 3))));
+
+  Pipeline pipe(1, 1, 0);
+  pipe.AddOperator(
+      OpSpec("SequenceReader")
+      .AddArg("file_root", root)
+      .AddArg("sequence_length", 2)
+      .AddArg("image_type", DALI_RGB)
+      .AddOutput("seq_out", "cpu"));
+  pipe.Build({{"seq_out", "cpu"}});
+
+  DeviceWorkspace ws;
+  std::string error;
+  try {
+    pipe.RunCPU();
+    pipe.RunGPU();
+    pipe.Outputs(&ws);
+  } catch (std::exception &e) {
+    error = e.what();
+  }
+  EXPECT_NE(error.find("Frames do not match in dimensions"), std::string::npos) << error;
+
+  for (auto &frame : frames)
+    std::remove(frame.c_str());
+  rmdir((root + "/video").c_str());
+  rmdir(root.c_str());
+}
+
+TYPED_TEST(ReaderTest, SequenceRotatedFrames) {
+  char tmpl[] = "/tmp/dali_sequence_XXXXXX";
+  ASSERT_NE(mkdtemp(tmpl), nullptr);
+  std::string root = tmpl;
+  ASSERT_EQ(mkdir((root + "/video").c_str(), 0755), 0);
+  // the header shape of every frame is transposed by the EXIF orientation when decoding
+  std::vector<std::vector<uint8_t>> jpegs = {RotatedJpeg(16, 24), RotatedJpeg(16, 24)};
+  std::vector<std::string> frames = {root + "/video/0.jpg", root + "/video/1.jpg"};
+  for (size_t i = 0; i < frames.size(); i++) {
+    std::ofstream file(frames[i], std::ios::binary);
+    file.write(reinterpret_cast<const char *>(jpegs[i].data()), jpegs[i].size());
+    ASSERT_TRUE(file.good());
+  }
+
+  Pipeline pipe(1, 1, 0);
+  pipe.AddOperator(
+      OpSpec("SequenceReader")
+      .AddArg("file_root", root)
+      .AddArg("sequence_length", 2)
+      .AddArg("image_type", DALI_YCbCr)
+      .AddOutput("seq_out", "cpu"));
+  pipe.Build({{"seq_out", "cpu"}});
+
+  DeviceWorkspace ws;
+  pipe.RunCPU();
+  pipe.RunGPU();
+  pipe.Outputs(&ws);
+  auto *sequence = ws.Output<CPUBackend>(0).AsTensor();
+  auto shape = sequence->shape();
+  ASSERT_EQ(shape.sample_dim(), 5);
+  ASSERT_EQ(shape[1], 2);
+  for (int frame = 0; frame < 2; frame++) {
+    Tensor<CPUBackend> reference;
+    this->DecodeImage(jpegs[frame].data(), jpegs[frame].size(), 3, DALI_YCbCr, &reference);
+    ASSERT_EQ(shape.last(3), reference.shape());
+    EXPECT_EQ(std::memcmp(sequence->template data<uint8_t>() + frame * reference.size(),
+                          reference.template data<uint8_t>(), reference.nbytes()), 0);
+  }
+
+  for (auto &frame : frames)
+    std::remove(frame.c_str());
+  rmdir((root + "/video").c_str());
+  rmdir(root.c_str());
+}
+
 class TestLoader : public Loader<CPUBackend, Tensor<CPUBackend>> {
  public:
   explicit TestLoader(const OpSpec& spec) :
@@ -395,4 +483,46 @@ TYPED_TEST(ReaderTest, ResetLoaderTestStickToShard2) {
   ASSERT_EQ(tl.current_index_, tl.Size() / 2);
 }
 
+TYPED_TEST(ReaderTest, CheckpointTest) {
+  auto make_pipe = []() {
+    auto pipe = std::make_unique<Pipeline>(8, 2, 0);
+    pipe->EnableCheckpointing();
+    pipe->AddOperator(
+        OpSpec("FileReader")
+        .AddArg("file_root", testing::dali_extra_path() + "/db/single/jpeg")
+        .AddArg("random_shuffle", true)
+        .AddArg("initial_fill", 32)
+        .AddOutput("data_out", "cpu")
+        .AddOutput("labels", "cpu"), "Reader");
+    pipe->Build({{"data_out", "cpu"}});
+    return pipe;
+  };
+  auto run = [](Pipeline &pipe, int iterations) {
+    std::vector<std::string> samples;
+    DeviceWorkspace ws;
+    for (int i = 0; i < iterations; ++i) {
+      pipe.RunCPU();
+      pipe.RunGPU();
+      pipe.Outputs(&ws);
+      auto &out = ws.Output<CPUBackend>(0);
+      for (size_t s = 0; s < out.ntensor(); ++s) {
+        samples.push_back(out.GetSourceInfo(s));
+      }
+    }
+    return samples;
+  };
+
+  auto pipe = make_pipe();
+  run(*pipe, 3);
+  // the reader is already a few batches ahead
+  auto checkpoint = pipe->GetCheckpoint();
+  auto expected = run(*pipe, 10);
+
+  auto restored = make_pipe();
+  restored->RestoreFromCheckpoint(checkpoint);
+  EXPECT_EQ(run(*restored, 10), expected);
+  EXPECT_THROW(restored->RestoreFromCheckpoint(checkpoint), std::runtime_error);
+  EXPECT_THROW(restored->EnableCheckpointing(), std::runtime_error);
+}
+
 };  // namespace dali
@@ -29,11 +29,23 @@ DALI_SCHEMA(_TFRecordReaderBase)
   .AddArg("path",
       R"code(List of paths to TFRecord files.)code",
       DALI_STRING_VEC)
-  .AddArg("index_path",
+  .AddOptionalArg("index_path",
       R"code(List of paths to index files (1 index file for every TFRecord file).
 Index files may be obtained from TFRecord files using
-`tfrecord2idx` script distributed with DALI.)code",
-      DALI_STRING_VEC);
+`tfrecord2idx` script distributed with DALI and converted to the binary format, which is memory
+mapped instead of parsed, with the `idx2bin` script.
+If not provided, the index is built when the reader starts, by walking through all the files.
+If an index file doesn't exist, it is built and saved there.
+For compressed files the index refers to the decompressed data.)code",
+      std::vector<std::string>{})
+  .AddOptionalArg("compression",
+      R"code(Compression of the TFRecord files: `none`, `gzip` or `zlib`. Compressed files are
+decompressed by a separate thread, ahead of the reads. Compressed files can only be read
+sequentially, so they can't be used with `shuffle_block_size`.)code",
+      std::string("none"))
+  .AddOptionalArg("verify_crc",
+      R"code(Verify the checksums of the records.)code",
+      false);
 
 DALI_SCHEMA(_TFRecordReader)
   .DocStr(R"code(Read sample data from a TensorFlow TFRecord file.)code")
@@ -58,6 +58,10 @@ class Resize : public Operator<Backend>
     return false;
   }
 
+  bool CanRunPerSample() const override {
+    return std::is_same<Backend, CPUBackend>::value;
+  }
+
   void RunImpl(Workspace<Backend> &ws) override;
   void SetupSharedSampleParams(Workspace<Backend> &ws) override;
 
@@ -39,6 +39,10 @@ class Cast : public Operator<Backend> {
     return false;
   }
 
+  bool CanRunPerSample() const override {
+    return std::is_same<Backend, CPUBackend>::value;
+  }
+
   void RunImpl(Workspace<Backend> &ws) override;
 
  private:
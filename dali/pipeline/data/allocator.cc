@@ -20,9 +20,10 @@ namespace dali {
 DALI_DEFINE_OPTYPE_REGISTRY(GPUAllocator, GPUAllocator);
 DALI_DEFINE_OPTYPE_REGISTRY(CPUAllocator, CPUAllocator);
 
-// Register GPU, CPU, and PinnedCPU allocators
+// Register GPU, CPU, PoolingCPU and PinnedCPU allocators
 DALI_REGISTER_GPU_ALLOCATOR(GPUAllocator, GPUAllocator);
 DALI_REGISTER_CPU_ALLOCATOR(CPUAllocator, CPUAllocator);
+DALI_REGISTER_CPU_ALLOCATOR(PoolingCPUAllocator, PoolingCPUAllocator);
 DALI_REGISTER_CPU_ALLOCATOR(PinnedCPUAllocator, PinnedCPUAllocator);
 
 }  // namespace dali
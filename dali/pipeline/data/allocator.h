@@ -15,7 +15,10 @@
 #ifndef DALI_PIPELINE_DATA_ALLOCATOR_H_
 #define DALI_PIPELINE_DATA_ALLOCATOR_H_
 
+#include <new>
+
 #include "dali/core/cuda_utils.h"
+#include "dali/core/host_pool.h"
 #include "dali/pipeline/operator/operator_factory.h"
 
 namespace dali {
@@ -78,6 +81,9 @@ DALI_DECLARE_OPTYPE_REGISTRY(GPUAllocator, GPUAllocator);
 
 /**
  * @brief Default CPU memory allocator.
+ *
+ * Goes through the `HostMemoryPool`, which doesn't pool the memory unless enabled
+ * (see `PoolingCPUAllocator`), but may back big buffers with huge pages.
  */
 class CPUAllocator : public AllocatorBase {
  public:
@@ -85,11 +91,13 @@ class CPUAllocator : public AllocatorBase {
   ~CPUAllocator() override = default;
 
   void New(void **ptr, size_t bytes) override {
-    *ptr = ::operator new(bytes);
+    *ptr = HostMemoryPool::Instance().Allocate(bytes);
+    if (!*ptr)
+      throw std::bad_alloc();
   }
 
   void Delete(void *ptr, size_t /* unused */) override {
-    ::operator delete(ptr);
+    HostMemoryPool::Instance().Deallocate(ptr);
   }
 };
 
@@ -99,6 +107,33 @@ DALI_DECLARE_OPTYPE_REGISTRY(CPUAllocator, CPUAllocator);
   DALI_DEFINE_OPTYPE_REGISTERER(OpName, OpType,     \
       dali::CPUAllocator, dali::CPUAllocator, "CPU_Allocator")
 
+/**
+ * @brief CPU allocator reusing the freed buffers, see `HostMemoryPool`.
+ *
+ * Selecting it also pools the host memory of the kernels. Optional arguments:
+ * `release_threshold` - bytes of the free buffers kept before giving them back to the system,
+ * `thread_cache_bytes` - bytes of the small buffers every thread keeps.
+ */
+class PoolingCPUAllocator : public CPUAllocator {
+ public:
+  explicit PoolingCPUAllocator(const OpSpec &spec) : CPUAllocator(spec) {
+    auto &pool = HostMemoryPool::Instance();
+    HostMemoryPool::Params params;
+    if (spec.HasArgument("release_threshold"))
+      params.release_threshold = spec.GetArgument<Index>("release_threshold");
+    if (spec.HasArgument("thread_cache_bytes"))
+      params.thread_cache_bytes = spec.GetArgument<Index>("thread_cache_bytes");
+    pool.SetParams(params);
+    pool.SetEnabled(true);
+  }
+
+  ~PoolingCPUAllocator() override {
+    // the buffers still alive are freed to the system when they are deleted
+    HostMemoryPool::Instance().SetEnabled(false);
+    HostMemoryPool::Instance().Release();
+  }
+};
+
 /**
  * @brief Pinned memory CPU allocator
  */
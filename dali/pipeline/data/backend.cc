@@ -20,6 +20,7 @@
 #include <utility>
 
 #include "dali/core/common.h"
+#include "dali/core/numa.h"
 #include "dali/pipeline/data/allocator.h"
 #include "dali/pipeline/operator/op_spec.h"
 
@@ -161,6 +162,9 @@ void* CPUBackend::New(size_t bytes, bool pinned) {
   void *ptr = nullptr;
   if (!pinned) {
     AllocatorManager::GetCPUAllocator().New(&ptr, bytes);
+    // Keep the buffer on the NUMA node of the thread that's going to fill it.
+    // Pinned memory can't be moved.
+    numa::PlaceMemory(ptr, bytes);
   } else {
     AllocatorManager::GetPinnedCPUAllocator().New(&ptr, bytes);
   }
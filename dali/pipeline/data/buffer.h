@@ -143,6 +143,14 @@ class Buffer {
     return static_cast<void*>(data_.get());
   }
 
+  /**
+   * @brief Returns the shared pointer owning the underlying storage. It can be used
+   * to create pointers into the buffer that keep the storage alive.
+   */
+  inline const shared_ptr<void> &get_data_ptr() const {
+    return data_;
+  }
+
   /**
    * @brief Returns the size in elements of the underlying data
    */
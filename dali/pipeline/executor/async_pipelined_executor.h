@@ -39,9 +39,9 @@ class DLL_PUBLIC AsyncPipelinedExecutor : public PipelinedExecutor {
                                            QueueSizes prefetch_queue_depth = QueueSizes{2, 2})
       : PipelinedExecutor(batch_size, num_thread, device_id, bytes_per_sample_hint, set_affinity,
                           max_num_stream, default_cuda_stream_priority, prefetch_queue_depth),
-        cpu_thread_(device_id, set_affinity),
-        mixed_thread_(device_id, set_affinity),
-        gpu_thread_(device_id, set_affinity),
+        cpu_thread_(device_id, set_affinity, "Executor cpu stage"),
+        mixed_thread_(device_id, set_affinity, "Executor mixed stage"),
+        gpu_thread_(device_id, set_affinity, "Executor gpu stage"),
         device_id_(device_id) {}
 
   DLL_PUBLIC ~AsyncPipelinedExecutor() override {
@@ -86,6 +86,16 @@ class DLL_PUBLIC AsyncPipelinedExecutor : public PipelinedExecutor {
   DLL_PUBLIC void RunGPU() override;
 
   DLL_PUBLIC void Outputs(DeviceWorkspace *ws) override {
+    OutputsImpl(ws);
+  }
+
+  DLL_PUBLIC void Outputs(HostWorkspace *ws) override {
+    OutputsImpl(ws);
+  }
+
+ protected:
+  template <typename Workspace>
+  void OutputsImpl(Workspace *ws) {
     CheckForErrors();
     try {
       PipelinedExecutor::Outputs(ws);
@@ -104,7 +114,6 @@ class DLL_PUBLIC AsyncPipelinedExecutor : public PipelinedExecutor {
     }
   }
 
- protected:
   void CheckForErrors() {
     cpu_thread_.CheckForErrors();
     mixed_thread_.CheckForErrors();
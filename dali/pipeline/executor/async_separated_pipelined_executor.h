@@ -39,9 +39,9 @@ class DLL_PUBLIC AsyncSeparatedPipelinedExecutor : public SeparatedPipelinedExec
       : SeparatedPipelinedExecutor(batch_size, num_thread, device_id, bytes_per_sample_hint,
                                    set_affinity, max_num_stream, default_cuda_stream_priority,
                                    prefetch_queue_depth),
-        cpu_thread_(device_id, set_affinity),
-        mixed_thread_(device_id, set_affinity),
-        gpu_thread_(device_id, set_affinity),
+        cpu_thread_(device_id, set_affinity, "Executor cpu stage"),
+        mixed_thread_(device_id, set_affinity, "Executor mixed stage"),
+        gpu_thread_(device_id, set_affinity, "Executor gpu stage"),
         device_id_(device_id) {}
 
   DLL_PUBLIC ~AsyncSeparatedPipelinedExecutor() override {
@@ -79,6 +79,16 @@ class DLL_PUBLIC AsyncSeparatedPipelinedExecutor : public SeparatedPipelinedExec
   DLL_PUBLIC void RunGPU() override;
 
   DLL_PUBLIC void Outputs(DeviceWorkspace *ws) override {
+    OutputsImpl(ws);
+  }
+
+  DLL_PUBLIC void Outputs(HostWorkspace *ws) override {
+    OutputsImpl(ws);
+  }
+
+ protected:
+  template <typename Workspace>
+  void OutputsImpl(Workspace *ws) {
     CheckForErrors();
     try {
       SeparatedPipelinedExecutor::Outputs(ws);
@@ -93,7 +103,6 @@ class DLL_PUBLIC AsyncSeparatedPipelinedExecutor : public SeparatedPipelinedExec
     }
   }
 
- protected:
   void CheckForErrors() {
     cpu_thread_.CheckForErrors();
     mixed_thread_.CheckForErrors();
@@ -15,10 +15,18 @@
 #ifndef DALI_PIPELINE_EXECUTOR_EXECUTOR_H_
 #define DALI_PIPELINE_EXECUTOR_EXECUTOR_H_
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
+#include <set>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -31,6 +39,7 @@
 #include "dali/pipeline/graph/op_graph_storage.h"
 #include "dali/pipeline/graph/op_graph_verifier.h"
 #include "dali/pipeline/operator/common.h"
+#include "dali/pipeline/operator/op_stats.h"
 #include "dali/pipeline/util/event_pool.h"
 #include "dali/pipeline/util/stream_pool.h"
 #include "dali/pipeline/util/thread_pool.h"
@@ -60,8 +69,11 @@ class DLL_PUBLIC ExecutorBase {
   DLL_PUBLIC virtual void RunGPU() = 0;
   DLL_PUBLIC virtual void Outputs(DeviceWorkspace *ws) = 0;
   DLL_PUBLIC virtual void ShareOutputs(DeviceWorkspace *ws) = 0;
+  DLL_PUBLIC virtual void Outputs(HostWorkspace *ws) = 0;
+  DLL_PUBLIC virtual void ShareOutputs(HostWorkspace *ws) = 0;
   DLL_PUBLIC virtual void ReleaseOutputs() = 0;
   DLL_PUBLIC virtual void SetCompletionCallback(ExecutorCallback cb) = 0;
+  DLL_PUBLIC virtual ExecutorStats GetStats() const = 0;
 
  protected:
   // virtual to allow the TestPruneWholeGraph test in gcc
@@ -76,6 +88,11 @@ class DLL_PUBLIC ExecutorBase {
  * prefetching of results by maintaining two copies of output
  * buffers, so that we can produce data into one while the
  * other is in use by the user.
+ *
+ * When created with `CPU_ONLY_DEVICE_ID` the executor runs graphs made only
+ * of CPU operators without using CUDA. The mixed and gpu stages just pass the
+ * queue indices along, so the prefetching works the same way, and the outputs
+ * are returned in a HostWorkspace.
  */
 template <typename WorkspacePolicy, typename QueuePolicy>
 class DLL_PUBLIC Executor : public ExecutorBase, public WorkspacePolicy, public QueuePolicy {
@@ -94,9 +111,13 @@ class DLL_PUBLIC Executor : public ExecutorBase, public WorkspacePolicy, public
         exec_error_(false),
         queue_sizes_(prefetch_queue_depth) {
     DALI_ENFORCE(batch_size_ > 0, "Batch size must be greater than 0.");
-    DALI_ENFORCE(device_id >= 0, "Device id must be non-negative.");
+    DALI_ENFORCE(device_id >= 0 || device_id == CPU_ONLY_DEVICE_ID,
+                 "Device id must be non-negative.");
 
     stage_queue_depths_ = QueuePolicy::GetQueueSizes(prefetch_queue_depth);
+
+    const char *env_planning = std::getenv("DALI_CPU_MEMORY_PLANNING");
+    memory_planning_ = env_planning && std::atoi(env_planning) != 0;
   }
 
   DLL_PUBLIC void Build(OpGraph *graph, vector<string> output_names) override;
@@ -106,9 +127,29 @@ class DLL_PUBLIC Executor : public ExecutorBase, public WorkspacePolicy, public
   DLL_PUBLIC void RunGPU() override;
   DLL_PUBLIC void Outputs(DeviceWorkspace *ws) override;
   DLL_PUBLIC void ShareOutputs(DeviceWorkspace *ws) override;
+  DLL_PUBLIC void Outputs(HostWorkspace *ws) override;
+  DLL_PUBLIC void ShareOutputs(HostWorkspace *ws) override;
   DLL_PUBLIC void ReleaseOutputs() override;
   DLL_PUBLIC void SetCompletionCallback(ExecutorCallback cb) override;
 
+  /**
+   * @brief Returns the statistics gathered since the pipeline was built: the run times and
+   * the produced bytes of every operator and the time each stage waited for its queue.
+   *
+   * The times of the mixed and GPU operators cover only issuing the work from the host.
+   */
+  DLL_PUBLIC ExecutorStats GetStats() const override;
+
+  /**
+   * @brief Lets the CPU intermediates which are never alive at the same time share their
+   * storage. Takes effect in the next `Build`.
+   *
+   * Initially set with the `DALI_CPU_MEMORY_PLANNING` environment variable.
+   */
+  DLL_PUBLIC void EnableMemoryPlanning(bool enable) {
+    memory_planning_ = enable;
+  }
+
   DLL_PUBLIC void ShutdownQueue() {
     QueuePolicy::SignalStop();
   }
@@ -125,6 +166,18 @@ class DLL_PUBLIC Executor : public ExecutorBase, public WorkspacePolicy, public
 
   void PruneUnusedGraphNodes() override;
 
+  bool IsCPUOnly() const {
+    return device_id_ == CPU_ONLY_DEVICE_ID;
+  }
+
+  void ThrowIfError() {
+    if (exec_error_ || QueuePolicy::IsStopSignaled()) {
+      std::lock_guard<std::mutex> errors_lock(errors_mutex_);
+      std::string error = errors_.empty() ? "Unknown error" : errors_.front();
+      throw std::runtime_error(error);
+    }
+  }
+
   virtual std::vector<int> GetTensorQueueSizes(const OpGraph &graph);
 
   virtual void SetupOutputInfo(const OpGraph &graph);
@@ -196,10 +249,10 @@ class DLL_PUBLIC Executor : public ExecutorBase, public WorkspacePolicy, public
   ThreadPool thread_pool_;
   std::vector<std::string> errors_;
   std::mutex errors_mutex_;
-  bool exec_error_;
+  std::atomic<bool> exec_error_;
   QueueSizes queue_sizes_;
   std::vector<tensor_data_store_queue_t> tensor_to_store_queue_;
-  cudaStream_t mixed_op_stream_, gpu_op_stream_;
+  cudaStream_t mixed_op_stream_ = 0, gpu_op_stream_ = 0;
   // MixedOpId -> queue_idx -> cudaEvent_t
   // To introduce dependency from MIXED to GPU Ops
   MixedOpEventMap mixed_op_events_;
@@ -207,10 +260,60 @@ class DLL_PUBLIC Executor : public ExecutorBase, public WorkspacePolicy, public
   // To introduce dependency from MIXED stage to GPU stage for callback only
   // in some edge cases where there are no operators
   std::vector<cudaEvent_t> mixed_callback_events_;
+  // Time spent by each stage in AcquireIdxs
+  StageStatsCollector stage_stats_[static_cast<int>(OpType::COUNT)];
 
  private:
   template <typename Workspace>
   void RunHelper(OpNode &op_node, Workspace &ws) {
+    int64_t start = stats_now_ns();
+    SetupHelper(op_node, ws);
+    op_node.op->Run(ws);
+    op_node.op->stats().AddIteration(stats_now_ns() - start, OutputBytes(ws));
+  }
+
+  static void AtomicMax(std::atomic<int64_t> &value, int64_t candidate) {
+    int64_t current = value.load(std::memory_order_relaxed);
+    while (current < candidate &&
+           !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {}
+  }
+
+  template <typename Backend>
+  static int64_t NumBytes(const TensorVector<Backend> &tv) {
+    int64_t bytes = 0;
+    for (auto &t : tv) {
+      bytes += t->nbytes();
+    }
+    return bytes;
+  }
+
+  template <typename Backend>
+  static int64_t NumBytes(const TensorList<Backend> &tl) {
+    return tl.nbytes();
+  }
+
+  template <typename Workspace>
+  static int64_t OutputBytes(const Workspace &ws) {
+    int64_t bytes = 0;
+    for (int i = 0; i < ws.NumOutput(); i++) {
+      if (ws.template OutputIsType<CPUBackend>(i)) {
+        bytes += NumBytes(ws.template OutputRef<CPUBackend>(i));
+      } else {
+        bytes += NumBytes(ws.template OutputRef<GPUBackend>(i));
+      }
+    }
+    return bytes;
+  }
+
+  QueueIdxs TimedAcquireIdxs(OpType stage) {
+    int64_t start = stats_now_ns();
+    auto idxs = QueuePolicy::AcquireIdxs(stage);
+    stage_stats_[static_cast<int>(stage)].AddWait(stats_now_ns() - start);
+    return idxs;
+  }
+
+  template <typename Workspace>
+  void SetupHelper(OpNode &op_node, Workspace &ws) {
     auto &output_desc = op_node.output_desc;
     auto &op = *op_node.op;
     output_desc.clear();
@@ -238,15 +341,86 @@ class DLL_PUBLIC Executor : public ExecutorBase, public WorkspacePolicy, public
                    "type information for Operator outputs. In that case CanInferOutputs should "
                    "always return false.");
     }
-    op.Run(ws);
   }
+
+  /**
+   * @brief Finds the runs of consecutive CPU operators that can be executed per sample.
+   *
+   * An operator joins the chain of the preceding one if it runs per sample, doesn't need
+   * the shapes of its inputs in Setup and none of its argument inputs is produced in the chain.
+   */
+  void FindPerSampleChains();
+
+  /**
+   * @brief Runs the CPU operators [begin, end) as one task per sample.
+   */
+  void RunPerSampleChain(QueueIdxs idxs, int begin, int end);
+
+  /**
+   * @brief Splits the CPU operators into units of work (single operators or per-sample
+   * chains) and finds the dependencies between them, through the regular and the
+   * argument inputs.
+   *
+   * If the units form independent branches, a pool for running them concurrently is created.
+   */
+  void FindCPUUnitDependencies();
+
+  void RunCPUUnit(QueueIdxs idxs, int unit);
+
+  /**
+   * @brief Runs every CPU unit as soon as all the units it depends on are done.
+   */
+  void RunCPUBranches(QueueIdxs idxs);
+
+  /**
+   * @brief Makes the CPU intermediates with disjoint lifetimes share their storage.
+   *
+   * The lifetime of a tensor spans the CPU units from its producer to its last consumer,
+   * following the outputs of the pass-through operators, which share the memory of their
+   * inputs. As independent units may run concurrently, a tensor can reuse the storage of
+   * another one only if its producer depends on all the units using that one.
+   * The outputs of the operators without regular inputs (readers, external sources),
+   * of the pass-through operators and the tensors used outside of the CPU stage keep their
+   * own storage.
+   */
+  void PlanCPUMemory(const std::vector<int> &queue_sizes);
+
+  /**
+   * @brief Drops the memory shared by the previous users of the storage of the outputs
+   * of the CPU op, along with their metadata.
+   */
+  void PrepareAliasedOutputs(QueueIdxs idxs, int cpu_op_id);
+
+  /**
+   * @brief Records the bytes held by the shared outputs of the CPU op, for the statistics
+   */
+  void RecordAliasedOutputs(QueueIdxs idxs, int cpu_op_id);
+
+  // CPU op id -> id of the first CPU op after the chain starting at it
+  std::vector<int> cpu_chain_end_;
+  // unit -> id of its first CPU op
+  std::vector<int> cpu_units_;
+  // unit -> units consuming its outputs
+  std::vector<std::vector<int>> cpu_unit_consumers_;
+  // unit -> number of units producing its inputs
+  std::vector<int> cpu_unit_num_producers_;
+  // Runs the independent CPU units, their per-sample work goes to thread_pool_
+  std::unique_ptr<ThreadPool> cpu_branch_pool_;
+
+  bool memory_planning_ = false;
+  // tensor -> index of the storage it shares with other tensors, -1 if it has its own
+  std::vector<int> tensor_alias_class_;
+  // shared storage -> the tensors using it, in the order of their producers
+  std::vector<std::vector<TensorNodeId>> alias_classes_;
+  // tensor -> the most bytes it held, recorded only for the shared storage
+  std::vector<std::atomic<int64_t>> tensor_peak_bytes_;
 };
 
 template <typename WorkspacePolicy, typename QueuePolicy>
 void Executor<WorkspacePolicy, QueuePolicy>::SetCompletionCallback(ExecutorCallback cb) {
   callback_ = cb;
   // Create necessary events lazily
-  if (mixed_callback_events_.empty()) {
+  if (!IsCPUOnly() && mixed_callback_events_.empty()) {
     mixed_callback_events_.resize(stage_queue_depths_[OpType::MIXED]);
     for (auto &event : mixed_callback_events_) {
       event = event_pool_.GetEvent();
@@ -254,6 +428,36 @@ void Executor<WorkspacePolicy, QueuePolicy>::SetCompletionCallback(ExecutorCallb
   }
 }
 
+template <typename WorkspacePolicy, typename QueuePolicy>
+ExecutorStats Executor<WorkspacePolicy, QueuePolicy>::GetStats() const {
+  ExecutorStats stats;
+  if (!graph_)
+    return stats;
+  for (OpType op_type : {OpType::CPU, OpType::MIXED, OpType::GPU}) {
+    for (int i = 0; i < graph_->NumOp(op_type); i++) {
+      const OpNode &op_node = graph_->Node(op_type, i);
+      OperatorStats op_stats = op_node.op->stats().Get();
+      op_stats.name = op_node.instance_name;
+      op_stats.op_type = op_type;
+      stats.operators[op_node.instance_name] = op_stats;
+    }
+    stats.stages[op_type] = stage_stats_[static_cast<int>(op_type)].Get();
+  }
+  // The shared storage has to fit the biggest of its tensors, the others come for free
+  for (const auto &alias_class : alias_classes_) {
+    int64_t total_bytes = 0, max_bytes = 0;
+    for (auto tensor_id : alias_class) {
+      int64_t bytes = tensor_peak_bytes_[tensor_id].load(std::memory_order_relaxed);
+      total_bytes += bytes;
+      max_bytes = std::max(max_bytes, bytes);
+    }
+    stats.memory.aliased_tensors += alias_class.size();
+    stats.memory.shared_buffers++;
+    stats.memory.peak_bytes_saved += total_bytes - max_bytes;
+  }
+  return stats;
+}
+
 template <typename WorkspacePolicy, typename QueuePolicy>
 void Executor<WorkspacePolicy, QueuePolicy>::Build(OpGraph *graph, vector<string> output_names) {
   DALI_ENFORCE(graph != nullptr, "Input graph is nullptr.");
@@ -271,6 +475,12 @@ void Executor<WorkspacePolicy, QueuePolicy>::Build(OpGraph *graph, vector<string
 
   // Check if graph is ok for execution
   CheckGraphConstraints(*graph_);
+  if (IsCPUOnly()) {
+    DALI_ENFORCE(graph_->NumOp(OpType::MIXED) == 0 && graph_->NumOp(OpType::GPU) == 0,
+                 "CPU-only execution supports only CPU operators.");
+    DALI_ENFORCE((std::is_same<QueuePolicy, UniformQueuePolicy>::value),
+                 "CPU-only execution doesn't support separated queues.");
+  }
   // Clear the old data
   tensor_to_store_queue_.clear();
 
@@ -279,10 +489,15 @@ void Executor<WorkspacePolicy, QueuePolicy>::Build(OpGraph *graph, vector<string
 
   auto queue_sizes = GetTensorQueueSizes(*graph_);
 
+  // The schedule of the CPU operators, needed to plan their memory
+  FindPerSampleChains();
+  FindCPUUnitDependencies();
+
   // Create corresponding storage type for TensorNodes in graph
   tensor_to_store_queue_ = CreateBackingStorageForTensorNodes(*graph_, batch_size_, queue_sizes);
+  PlanCPUMemory(queue_sizes);
   // Setup stream and events that will be used for execution
-  {
+  if (!IsCPUOnly()) {
     DeviceGuard g(device_id_);
     mixed_op_stream_ = stream_pool_.GetStream();
     gpu_op_stream_ = stream_pool_.GetStream();
@@ -309,37 +524,350 @@ void Executor<WorkspacePolicy, QueuePolicy>::Build(OpGraph *graph, vector<string
   SetupOutputQueuesForGraph();
 }
 
+template <typename WorkspacePolicy, typename QueuePolicy>
+void Executor<WorkspacePolicy, QueuePolicy>::FindPerSampleChains() {
+  int num_ops = graph_->NumOp(OpType::CPU);
+  cpu_chain_end_.assign(num_ops, 0);
+  int begin = 0;
+  for (int op_id = 0; op_id < num_ops; op_id++) {
+    cpu_chain_end_[op_id] = op_id + 1;
+    OpNode &op_node = graph_->Node(OpType::CPU, op_id);
+    auto *op = dynamic_cast<Operator<CPUBackend> *>(op_node.op.get());
+    if (op == nullptr || !op->CanRunPerSample()) {
+      begin = op_id + 1;
+      continue;
+    }
+    bool joins_chain = op_id > begin && !op->CanInferOutputs();
+    for (int i = op_node.spec.NumRegularInput(); joins_chain && i < op_node.spec.NumInput(); i++) {
+      const auto &producer = graph_->Node(graph_->Tensor(op_node.parent_tensors[i]).producer.node);
+      joins_chain = producer.op_type != OpType::CPU || producer.partition_index < begin;
+    }
+    if (joins_chain) {
+      cpu_chain_end_[begin] = op_id + 1;
+    } else {
+      begin = op_id;
+    }
+  }
+}
+
+template <typename WorkspacePolicy, typename QueuePolicy>
+void Executor<WorkspacePolicy, QueuePolicy>::FindCPUUnitDependencies() {
+  int num_ops = graph_->NumOp(OpType::CPU);
+  std::vector<int> unit_of_op(num_ops);
+  cpu_units_.clear();
+  for (int op_id = 0; op_id < num_ops; op_id = cpu_chain_end_[op_id]) {
+    for (int i = op_id; i < cpu_chain_end_[op_id]; i++) {
+      unit_of_op[i] = cpu_units_.size();
+    }
+    cpu_units_.push_back(op_id);
+  }
+
+  int num_units = cpu_units_.size();
+  cpu_unit_consumers_.assign(num_units, {});
+  cpu_unit_num_producers_.assign(num_units, 0);
+  // the length of the longest path of units leading to the unit
+  std::vector<int> depth(num_units, 0);
+  for (int unit = 0; unit < num_units; unit++) {
+    std::set<int> producers;
+    for (int op_id = cpu_units_[unit]; op_id < cpu_chain_end_[cpu_units_[unit]]; op_id++) {
+      for (auto tensor_id : graph_->Node(OpType::CPU, op_id).parent_tensors) {
+        const auto &producer = graph_->Node(graph_->Tensor(tensor_id).producer.node);
+        if (producer.op_type == OpType::CPU && unit_of_op[producer.partition_index] != unit)
+          producers.insert(unit_of_op[producer.partition_index]);
+      }
+    }
+    for (int producer : producers) {
+      cpu_unit_consumers_[producer].push_back(unit);
+      depth[unit] = std::max(depth[unit], depth[producer] + 1);
+    }
+    cpu_unit_num_producers_[unit] = producers.size();
+  }
+
+  // The units at the same depth don't depend on each other
+  std::map<int, int> units_at_depth;
+  int max_branches = 0;
+  for (int d : depth) {
+    max_branches = std::max(max_branches, ++units_at_depth[d]);
+  }
+  cpu_branch_pool_.reset();
+  if (max_branches > 1) {
+    cpu_branch_pool_.reset(new ThreadPool(max_branches, device_id_, false));
+  }
+}
+
+template <typename WorkspacePolicy, typename QueuePolicy>
+void Executor<WorkspacePolicy, QueuePolicy>::PlanCPUMemory(const std::vector<int> &queue_sizes) {
+  tensor_alias_class_.assign(graph_->NumTensor(), -1);
+  alias_classes_.clear();
+  if (!memory_planning_)
+    return;
+
+  int num_ops = graph_->NumOp(OpType::CPU);
+  int num_units = cpu_units_.size();
+  std::vector<int> unit_of_op(num_ops);
+  for (int unit = 0; unit < num_units; unit++) {
+    for (int op_id = cpu_units_[unit]; op_id < cpu_chain_end_[cpu_units_[unit]]; op_id++) {
+      unit_of_op[op_id] = unit;
+    }
+  }
+  // runs_after[a][b] - unit b starts only after unit a is done.
+  // The units are numbered in a topological order, so the consumers come later.
+  std::vector<std::vector<bool>> runs_after(num_units, std::vector<bool>(num_units, false));
+  for (int unit = num_units - 1; unit >= 0; unit--) {
+    for (int consumer : cpu_unit_consumers_[unit]) {
+      runs_after[unit][consumer] = true;
+      for (int u = consumer + 1; u < num_units; u++) {
+        if (runs_after[consumer][u])
+          runs_after[unit][u] = true;
+      }
+    }
+  }
+
+  std::set<TensorNodeId> outputs(pipeline_outputs_.begin(), pipeline_outputs_.end());
+  // Collects the units using the tensor directly or through the pass-through operators.
+  // Returns false if the tensor is used outside of the CPU stage.
+  std::function<bool(TensorNodeId, std::set<int> &)> collect_uses =
+      [&](TensorNodeId tensor_id, std::set<int> &uses) {
+    if (outputs.count(tensor_id))
+      return false;
+    for (const auto &consumer : graph_->Tensor(tensor_id).consumers) {
+      const auto &node = graph_->Node(consumer.node);
+      if (node.op_type != OpType::CPU)
+        return false;
+      uses.insert(unit_of_op[node.partition_index]);
+      if (node.spec.GetSchema().IsPassThrough()) {
+        for (auto child : node.children_tensors) {
+          if (!collect_uses(child, uses))
+            return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  struct AliasClass {
+    std::vector<TensorNodeId> tensors;
+    // the units using the last of the tensors
+    std::set<int> uses;
+    int queue_size;
+  };
+  std::vector<AliasClass> classes;
+  for (int op_id = 0; op_id < num_ops; op_id++) {
+    const auto &node = graph_->Node(OpType::CPU, op_id);
+    if (node.spec.NumRegularInput() == 0 || node.spec.GetSchema().IsPassThrough())
+      continue;
+    int unit = unit_of_op[op_id];
+    for (auto tensor_id : node.children_tensors) {
+      std::set<int> uses = {unit};
+      if (graph_->Tensor(tensor_id).producer.storage_device != StorageDevice::CPU ||
+          !collect_uses(tensor_id, uses))
+        continue;
+      // First fit - the storage of the first tensor which is dead before the producer runs
+      auto fits = [&](const AliasClass &c) {
+        return c.queue_size == queue_sizes[tensor_id] &&
+               std::all_of(c.uses.begin(), c.uses.end(),
+                           [&](int use) { return runs_after[use][unit]; });
+      };
+      auto it = std::find_if(classes.begin(), classes.end(), fits);
+      if (it == classes.end())
+        it = classes.insert(classes.end(), AliasClass{{}, {}, queue_sizes[tensor_id]});
+      it->tensors.push_back(tensor_id);
+      it->uses = std::move(uses);
+    }
+  }
+
+  for (auto &c : classes) {
+    if (c.tensors.size() < 2)
+      continue;
+    auto &shared = get_queue<OpType::CPU, StorageDevice::CPU>(
+        tensor_to_store_queue_[c.tensors[0]]);
+    for (auto tensor_id : c.tensors) {
+      get_queue<OpType::CPU, StorageDevice::CPU>(tensor_to_store_queue_[tensor_id]).store =
+          shared.store;
+      tensor_alias_class_[tensor_id] = alias_classes_.size();
+    }
+    alias_classes_.push_back(std::move(c.tensors));
+  }
+  tensor_peak_bytes_ = std::vector<std::atomic<int64_t>>(graph_->NumTensor());
+}
+
+template <typename WorkspacePolicy, typename QueuePolicy>
+void Executor<WorkspacePolicy, QueuePolicy>::PrepareAliasedOutputs(QueueIdxs idxs,
+                                                                   int cpu_op_id) {
+  if (alias_classes_.empty())
+    return;
+  for (auto tensor_id : graph_->Node(OpType::CPU, cpu_op_id).children_tensors) {
+    if (tensor_alias_class_[tensor_id] < 0)
+      continue;
+    auto &batch = *get_queue<OpType::CPU, StorageDevice::CPU>(
+        tensor_to_store_queue_[tensor_id])[idxs[OpType::CPU]];
+    for (size_t i = 0; i < batch.ntensor(); i++) {
+      if (batch[i].shares_data())
+        batch[i].Reset();
+      batch.SetMeta(i, DALIMeta());
+    }
+  }
+}
+
+template <typename WorkspacePolicy, typename QueuePolicy>
+void Executor<WorkspacePolicy, QueuePolicy>::RecordAliasedOutputs(QueueIdxs idxs,
+                                                                  int cpu_op_id) {
+  if (alias_classes_.empty())
+    return;
+  for (auto tensor_id : graph_->Node(OpType::CPU, cpu_op_id).children_tensors) {
+    if (tensor_alias_class_[tensor_id] < 0)
+      continue;
+    const auto &batch = *get_queue<OpType::CPU, StorageDevice::CPU>(
+        tensor_to_store_queue_[tensor_id])[idxs[OpType::CPU]];
+    AtomicMax(tensor_peak_bytes_[tensor_id], NumBytes(batch));
+  }
+}
+
 template <typename WorkspacePolicy, typename QueuePolicy>
 void Executor<WorkspacePolicy, QueuePolicy>::RunCPU() {
   TimeRange tr("[Executor] RunCPU");
 
   DeviceGuard g(device_id_);
 
-  auto cpu_idxs = QueuePolicy::AcquireIdxs(OpType::CPU);
+  auto cpu_idxs = TimedAcquireIdxs(OpType::CPU);
   if (exec_error_ || QueuePolicy::IsStopSignaled() || !QueuePolicy::AreValid(cpu_idxs)) {
     QueuePolicy::ReleaseIdxs(OpType::CPU, cpu_idxs);
     return;
   }
 
   // Run the cpu-ops in the thread
-  // Process each CPU Op in batch
-  for (int cpu_op_id = 0; cpu_op_id < graph_->NumOp(OpType::CPU); ++cpu_op_id) {
+  // Process each CPU Op in batch, chains of per-sample ops are processed sample by sample.
+  // Independent branches of the graph run concurrently.
+  if (cpu_branch_pool_) {
+    RunCPUBranches(cpu_idxs);
+  } else {
+    for (size_t unit = 0; unit < cpu_units_.size(); unit++) {
+      RunCPUUnit(cpu_idxs, unit);
+    }
+  }
+
+  // Pass the work to the mixed stage
+  QueuePolicy::ReleaseIdxs(OpType::CPU, cpu_idxs);
+}
+
+template <typename WorkspacePolicy, typename QueuePolicy>
+void Executor<WorkspacePolicy, QueuePolicy>::RunCPUUnit(QueueIdxs idxs, int unit) {
+  int cpu_op_id = cpu_units_[unit];
+  try {
+    if (cpu_chain_end_[cpu_op_id] - cpu_op_id > 1) {
+      RunPerSampleChain(idxs, cpu_op_id, cpu_chain_end_[cpu_op_id]);
+      return;
+    }
     OpNode &op_node = graph_->Node(OpType::CPU, cpu_op_id);
     typename WorkspacePolicy::template ws_t<OpType::CPU> ws =
-        WorkspacePolicy::template GetWorkspace<OpType::CPU>(cpu_idxs, *graph_, cpu_op_id);
+        WorkspacePolicy::template GetWorkspace<OpType::CPU>(idxs, *graph_, cpu_op_id);
     TimeRange tr("[Executor] Run CPU op " + op_node.instance_name, TimeRange::kBlue1);
+    PrepareAliasedOutputs(idxs, cpu_op_id);
+    RunHelper(op_node, ws);
+    RecordAliasedOutputs(idxs, cpu_op_id);
+  } catch (std::exception &e) {
+    HandleError(e.what());
+  } catch (...) {
+    HandleError();
+  }
+}
 
-    try {
-      RunHelper(op_node, ws);
-    } catch (std::exception &e) {
-      HandleError(e.what());
-    } catch (...) {
-      HandleError();
+template <typename WorkspacePolicy, typename QueuePolicy>
+void Executor<WorkspacePolicy, QueuePolicy>::RunCPUBranches(QueueIdxs idxs) {
+  int num_units = cpu_units_.size();
+  std::vector<int> num_producers = cpu_unit_num_producers_;
+  std::vector<int> ready;
+  for (int unit = 0; unit < num_units; unit++) {
+    if (num_producers[unit] == 0)
+      ready.push_back(unit);
+  }
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  int completed = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (completed < num_units) {
+    for (int unit : ready) {
+      cpu_branch_pool_->DoWorkWithID([&, unit](int) {
+        RunCPUUnit(idxs, unit);
+        std::lock_guard<std::mutex> unit_lock(mutex);
+        for (int consumer : cpu_unit_consumers_[unit]) {
+          if (--num_producers[consumer] == 0)
+            ready.push_back(consumer);
+        }
+        completed++;
+        cv.notify_one();
+      });
     }
+    ready.clear();
+    cv.wait(lock, [&] { return !ready.empty() || completed == num_units; });
   }
+  lock.unlock();
+  cpu_branch_pool_->WaitForWork();
+}
 
-  // Pass the work to the mixed stage
-  QueuePolicy::ReleaseIdxs(OpType::CPU, cpu_idxs);
+template <typename WorkspacePolicy, typename QueuePolicy>
+void Executor<WorkspacePolicy, QueuePolicy>::RunPerSampleChain(QueueIdxs idxs, int begin,
+                                                               int end) {
+  TimeRange tr("[Executor] Run CPU ops " + graph_->Node(OpType::CPU, begin).instance_name +
+               " - " + graph_->Node(OpType::CPU, end - 1).instance_name, TimeRange::kBlue1);
+  int64_t start = stats_now_ns();
+  std::vector<HostWorkspace> workspaces;
+  std::vector<Operator<CPUBackend> *> ops;
+  workspaces.reserve(end - begin);
+  for (int op_id = begin; op_id < end; op_id++) {
+    OpNode &op_node = graph_->Node(OpType::CPU, op_id);
+    PrepareAliasedOutputs(idxs, op_id);
+    workspaces.push_back(WorkspacePolicy::template GetWorkspace<OpType::CPU>(idxs, *graph_, op_id));
+    ops.push_back(static_cast<Operator<CPUBackend> *>(op_node.op.get()));
+    auto &ws = workspaces.back();
+    SetupHelper(op_node, ws);
+    // the layouts of the inputs produced in the chain are known only after it's done
+    if (op_id == begin)
+      CheckInputLayouts(ws, op_node.spec);
+    ops.back()->SetupSharedSampleParams(ws);
+  }
+
+  std::vector<int64_t> sample_time(ops.size());
+  for (size_t i = 0; i < ops.size(); i++) {
+    sample_time[i] = ops[i]->stats().Get().total_sample_time_ns;
+  }
+
+  auto &first_ws = workspaces.front();
+  bool has_input = first_ws.NumInput() > 0 && first_ws.InputIsType<CPUBackend>(0);
+  for (int data_idx = 0; data_idx < batch_size_; data_idx++) {
+    int64_t cost = has_input ? first_ws.Input<CPUBackend>(0, data_idx).nbytes() : 0;
+    thread_pool_.AddWork([&workspaces, &ops, data_idx](int tid) {
+      SampleWorkspace sample;
+      for (size_t i = 0; i < ops.size(); i++) {
+        workspaces[i].GetSample(&sample, data_idx, tid);
+        ops[i]->RunSample(sample);
+      }
+    }, cost);
+  }
+  thread_pool_.RunAll();
+
+  for (int op_id = begin + 1; op_id < end; op_id++) {
+    CheckInputLayouts(workspaces[op_id - begin], graph_->Node(OpType::CPU, op_id).spec);
+  }
+  for (int op_id = begin; op_id < end; op_id++) {
+    RecordAliasedOutputs(idxs, op_id);
+  }
+
+  // The operators of the chain run interleaved, so the wall time of the chain is split
+  // between them in proportion to the time they spent processing the samples
+  int64_t chain_time = stats_now_ns() - start;
+  int64_t total_sample_time = 0;
+  for (size_t i = 0; i < ops.size(); i++) {
+    sample_time[i] = ops[i]->stats().Get().total_sample_time_ns - sample_time[i];
+    total_sample_time += sample_time[i];
+  }
+  for (size_t i = 0; i < ops.size(); i++) {
+    int64_t op_time = total_sample_time > 0
+        ? static_cast<int64_t>(static_cast<double>(chain_time) * sample_time[i] / total_sample_time)
+        : chain_time / static_cast<int64_t>(ops.size());
+    ops[i]->stats().AddIteration(op_time, OutputBytes(workspaces[i]));
+  }
 }
 
 template <typename WorkspacePolicy, typename QueuePolicy>
@@ -347,7 +875,7 @@ void Executor<WorkspacePolicy, QueuePolicy>::RunMixed() {
   TimeRange tr("[Executor] RunMixed");
   DeviceGuard g(device_id_);
 
-  auto mixed_idxs = QueuePolicy::AcquireIdxs(OpType::MIXED);
+  auto mixed_idxs = TimedAcquireIdxs(OpType::MIXED);
   if (exec_error_ || QueuePolicy::IsStopSignaled() || !QueuePolicy::AreValid(mixed_idxs)) {
     QueuePolicy::ReleaseIdxs(OpType::MIXED, mixed_idxs);
     return;
@@ -371,7 +899,7 @@ void Executor<WorkspacePolicy, QueuePolicy>::RunMixed() {
     HandleError();
   }
 
-  if (callback_) {
+  if (callback_ && !IsCPUOnly()) {
     // Record event that will allow to call the callback after whole run of this pipeline is
     // finished.
     CUDA_CALL(cudaEventRecord(mixed_callback_events_[mixed_idxs[OpType::MIXED]], mixed_op_stream_));
@@ -384,7 +912,7 @@ template <typename WorkspacePolicy, typename QueuePolicy>
 void Executor<WorkspacePolicy, QueuePolicy>::RunGPU() {
   TimeRange tr("[Executor] RunGPU");
 
-  auto gpu_idxs = QueuePolicy::AcquireIdxs(OpType::GPU);
+  auto gpu_idxs = TimedAcquireIdxs(OpType::GPU);
   if (exec_error_ || QueuePolicy::IsStopSignaled() || !QueuePolicy::AreValid(gpu_idxs)) {
     QueuePolicy::ReleaseIdxs(OpType::GPU, gpu_idxs);
     return;
@@ -451,7 +979,10 @@ void Executor<WorkspacePolicy, QueuePolicy>::RunGPU() {
   // issued. Notify any waiting threads.
 
   // Schedule the call to any callback registered previously
-  if (callback_) {
+  if (callback_ && IsCPUOnly()) {
+    // There is no asynchronous work, the batch is complete
+    callback_();
+  } else if (callback_) {
     CUDA_CALL(cudaStreamWaitEvent(gpu_op_stream_,
                                   mixed_callback_events_[gpu_idxs[OpType::MIXED]], 0));
     CUDA_CALL(cudaStreamAddCallback(gpu_op_stream_, &detail::gpu_finished_callback,
@@ -481,22 +1012,15 @@ void Executor<WorkspacePolicy, QueuePolicy>::Outputs(DeviceWorkspace *ws) {
 template <typename WorkspacePolicy, typename QueuePolicy>
 void Executor<WorkspacePolicy, QueuePolicy>::ShareOutputs(DeviceWorkspace *ws) {
   DALI_ENFORCE(ws != nullptr, "Workspace is nullptr");
+  DALI_ENFORCE(!IsCPUOnly(), "CPU-only execution returns the outputs in a HostWorkspace");
   DeviceGuard g(device_id_);
   ws->Clear();
 
-  if (exec_error_ || QueuePolicy::IsStopSignaled()) {
-    std::lock_guard<std::mutex> errors_lock(errors_mutex_);
-    std::string error = errors_.empty() ? "Unknown error" : errors_.front();
-    throw std::runtime_error(error);
-  }
+  ThrowIfError();
 
   auto output_idx = QueuePolicy::UseOutputIdxs();
 
-  if (exec_error_ || QueuePolicy::IsStopSignaled()) {
-    std::lock_guard<std::mutex> errors_lock(errors_mutex_);
-    std::string error = errors_.empty() ? "Unknown error" : errors_.front();
-    throw std::runtime_error(error);
-  }
+  ThrowIfError();
 
   // We already gathered info about outputs, so we only have to wait on respective
   // events to make sure that the computation has completed
@@ -525,6 +1049,33 @@ void Executor<WorkspacePolicy, QueuePolicy>::ShareOutputs(DeviceWorkspace *ws) {
   }
 }
 
+template <typename WorkspacePolicy, typename QueuePolicy>
+void Executor<WorkspacePolicy, QueuePolicy>::Outputs(HostWorkspace *ws) {
+  ReleaseOutputs();
+  ShareOutputs(ws);
+}
+
+template <typename WorkspacePolicy, typename QueuePolicy>
+void Executor<WorkspacePolicy, QueuePolicy>::ShareOutputs(HostWorkspace *ws) {
+  DALI_ENFORCE(ws != nullptr, "Workspace is nullptr");
+  DALI_ENFORCE(IsCPUOnly(), "Only CPU-only execution returns the outputs in a HostWorkspace");
+  ws->Clear();
+
+  ThrowIfError();
+
+  auto output_idx = QueuePolicy::UseOutputIdxs();
+
+  ThrowIfError();
+
+  // All the outputs are produced by the CPU stage. The stages share the queue indices,
+  // so the index of the ready output is also the index of its CPU stage buffer.
+  for (auto out_tensor_id : pipeline_outputs_) {
+    auto &queue =
+        get_queue<OpType::CPU, StorageDevice::CPU>(tensor_to_store_queue_[out_tensor_id]);
+    ws->AddOutput(queue[output_idx[OpType::GPU]]);
+  }
+}
+
 template <typename WorkspacePolicy, typename QueuePolicy>
 void Executor<WorkspacePolicy, QueuePolicy>::PruneUnusedGraphNodes() {
   // We want to remove any nodes whose outputs are
@@ -14,8 +14,15 @@
 
 
 #include <gtest/gtest.h>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <future>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "dali/test/dali_test_decoder.h"
 #include "dali/pipeline/executor/executor.h"
@@ -99,6 +106,14 @@ using ExecutorSyncTypes =
 
 TYPED_TEST_SUITE(ExecutorSyncTest, ExecutorSyncTypes);
 
+template <typename ExecutorToTest>
+using ExecutorCPUOnlyTest = ExecutorTest<ExecutorToTest>;
+
+using ExecutorCPUOnlyTypes =
+    ::testing::Types<SimpleExecutor, PipelinedExecutor, AsyncPipelinedExecutor>;
+
+TYPED_TEST_SUITE(ExecutorCPUOnlyTest, ExecutorCPUOnlyTypes);
+
 TYPED_TEST(ExecutorTest, TestPruneBasicGraph) {
   auto exe = this->GetExecutor(this->batch_size_, this->num_threads_, 0, 1);
   exe->Init();
@@ -625,4 +640,417 @@ TYPED_TEST(ExecutorSyncTest, TestPrefetchedExecution) {
   }
 }
 
+TYPED_TEST(ExecutorCPUOnlyTest, TestPrefetchedExecution) {
+  int batch_size = this->batch_size_ / 2;
+  this->set_batch_size(batch_size);
+  this->SetEps(1.6);
+
+  auto exe = this->GetExecutor(this->batch_size_, this->num_threads_, CPU_ONLY_DEVICE_ID, 1);
+  exe->Init();
+
+  // Build a cpu only graph, the outputs don't need MakeContiguous
+  OpGraph graph;
+  graph.AddOp(this->PrepareSpec(
+          OpSpec("ExternalSource")
+          .AddArg("device", "cpu")
+          .AddArg("device_id", CPU_ONLY_DEVICE_ID)
+          .AddOutput("data", "cpu")), "");
+
+  graph.AddOp(this->PrepareSpec(
+          OpSpec("ImageDecoder")
+          .AddArg("device", "cpu")
+          .AddInput("data", "cpu")
+          .AddOutput("images", "cpu")), "");
+
+  vector<string> outputs = {"images_cpu"};
+  std::atomic<int> cb_counter{0};
+  exe->SetCompletionCallback([&cb_counter]() { ++cb_counter; });
+  exe->Build(&graph, outputs);
+
+  auto *src_op =
+      dynamic_cast<ExternalSource<CPUBackend> *>(graph.Node(OpType::CPU, 0).op.get());
+  ASSERT_NE(src_op, nullptr);
+  TensorList<CPUBackend> tl;
+  this->MakeJPEGBatch(&tl, this->batch_size_*2);
+
+  // Split the batch into two
+  vector<Tensor<CPUBackend>> batch1(batch_size), batch2(batch_size);
+  for (int i = 0; i < batch_size; ++i) {
+    batch1[i].Copy(tl, i, 0);
+    batch2[i].Copy(tl, i+batch_size, 0);
+  }
+
+  // Run twice without getting the results
+  src_op->SetDataSource(batch1);
+  exe->RunCPU();
+  exe->RunMixed();
+  exe->RunGPU();
+  src_op->SetDataSource(batch2);
+  exe->RunCPU();
+  exe->RunMixed();
+  exe->RunGPU();
+
+  // Verify that both sets of results are correct
+  for (int iter = 0; iter < 2; iter++) {
+    HostWorkspace ws;
+    exe->Outputs(&ws);
+    ASSERT_EQ(ws.NumOutput(), 1);
+    ASSERT_EQ(ws.NumInput(), 0);
+    ASSERT_EQ(ws.NumOutputAtIdx(0), batch_size);
+    for (int i = 0; i < batch_size; ++i) {
+      auto &img = ws.Output<CPUBackend>(0, i);
+      this->GenericDecoderTest::VerifyDecode(img.template data<uint8>(), img.shape()[0],
+                                             img.shape()[1], this->jpegs_,
+                                             i + iter * batch_size);
+    }
+  }
+  EXPECT_EQ(cb_counter, 2);
+
+  DeviceWorkspace dws;
+  EXPECT_THROW(exe->ShareOutputs(&dws), std::exception);
+}
+
+// Adds 1 to every element and records the order in which the samples are processed
+class SampleTraceOp : public Operator<CPUBackend> {
+ public:
+  explicit SampleTraceOp(const OpSpec &spec)
+      : Operator<CPUBackend>(spec),
+        trace_id_(spec.GetArgument<int>("trace_id")),
+        per_sample_(spec.GetArgument<bool>("per_sample")) {}
+
+  static std::vector<std::pair<int, int>> &Trace() {
+    static std::vector<std::pair<int, int>> trace;
+    return trace;
+  }
+
+ protected:
+  bool SetupImpl(std::vector<OutputDesc> &output_desc, const HostWorkspace &ws) override {
+    return false;
+  }
+
+  bool CanRunPerSample() const override {
+    return per_sample_;
+  }
+
+  void RunImpl(SampleWorkspace &ws) override {
+    auto &input = ws.Input<CPUBackend>(0);
+    auto &output = ws.Output<CPUBackend>(0);
+    output.Resize(input.shape());
+    auto *in = input.data<int>();
+    auto *out = output.mutable_data<int>();
+    for (Index i = 0; i < input.size(); i++) {
+      out[i] = in[i] + 1;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Trace().emplace_back(trace_id_, ws.data_idx());
+  }
+
+  using Operator<CPUBackend>::RunImpl;
+
+ private:
+  int trace_id_;
+  bool per_sample_;
+  static std::mutex mutex_;
+};
+
+std::mutex SampleTraceOp::mutex_;
+
+DALI_REGISTER_OPERATOR(SampleTraceOp, SampleTraceOp, CPU);
+
+DALI_SCHEMA(SampleTraceOp)
+  .DocStr("SampleTraceOp")
+  .NumInput(1)
+  .NumOutput(1)
+  .AddArg("trace_id", "Id of the op in the trace", DALI_INT32)
+  .AddOptionalArg("per_sample", "Whether the op can be run per sample", true);
+
+TYPED_TEST(ExecutorCPUOnlyTest, TestPerSampleChain) {
+  const int batch_size = 4;
+  this->set_batch_size(batch_size);
+  auto exe = this->GetExecutor(this->batch_size_, this->num_threads_, CPU_ONLY_DEVICE_ID, 1);
+  exe->Init();
+
+  OpGraph graph;
+  graph.AddOp(this->PrepareSpec(
+          OpSpec("ExternalSource")
+          .AddArg("device", "cpu")
+          .AddArg("device_id", CPU_ONLY_DEVICE_ID)
+          .AddOutput("data", "cpu")), "");
+  graph.AddOp(this->PrepareSpec(
+          OpSpec("SampleTraceOp")
+          .AddArg("device", "cpu")
+          .AddArg("trace_id", 0)
+          .AddInput("data", "cpu")
+          .AddOutput("data0", "cpu")), "trace0");
+  graph.AddOp(this->PrepareSpec(
+          OpSpec("SampleTraceOp")
+          .AddArg("device", "cpu")
+          .AddArg("trace_id", 1)
+          .AddInput("data0", "cpu")
+          .AddOutput("data1", "cpu")), "trace1");
+  graph.AddOp(this->PrepareSpec(
+          OpSpec("SampleTraceOp")
+          .AddArg("device", "cpu")
+          .AddArg("trace_id", 2)
+          .AddArg("per_sample", false)
+          .AddInput("data1", "cpu")
+          .AddOutput("data2", "cpu")), "trace2");
+
+  vector<string> outputs = {"data2_cpu"};
+  exe->Build(&graph, outputs);
+
+  auto *src_op =
+      dynamic_cast<ExternalSource<CPUBackend> *>(graph.Node(OpType::CPU, 0).op.get());
+  ASSERT_NE(src_op, nullptr);
+  vector<Tensor<CPUBackend>> batch(batch_size);
+  for (int i = 0; i < batch_size; ++i) {
+    batch[i].Resize({3});
+    auto *data = batch[i].mutable_data<int>();
+    for (int j = 0; j < 3; j++) {
+      data[j] = 10 * i + j;
+    }
+  }
+
+  SampleTraceOp::Trace().clear();
+  src_op->SetDataSource(batch);
+  exe->RunCPU();
+  exe->RunMixed();
+  exe->RunGPU();
+
+  HostWorkspace ws;
+  exe->Outputs(&ws);
+  ASSERT_EQ(ws.NumOutputAtIdx(0), batch_size);
+  for (int i = 0; i < batch_size; ++i) {
+    auto &out = ws.Output<CPUBackend>(0, i);
+    ASSERT_EQ(out.size(), 3);
+    for (int j = 0; j < 3; j++) {
+      EXPECT_EQ(out.template data<int>()[j], 10 * i + j + 3);
+    }
+  }
+
+  // The samples have the same size, so with a single thread they are processed in order.
+  // The first two ops run one sample after another, the last one waits for the whole batch
+  std::vector<std::pair<int, int>> expected;
+  for (int i = 0; i < batch_size; ++i) {
+    expected.emplace_back(0, i);
+    expected.emplace_back(1, i);
+  }
+  for (int i = 0; i < batch_size; ++i) {
+    expected.emplace_back(2, i);
+  }
+  EXPECT_EQ(SampleTraceOp::Trace(), expected);
+
+  auto stats = exe->GetStats();
+  for (const char *name : {"trace0", "trace1", "trace2"}) {
+    ASSERT_NE(stats.operators.count(name), 0u);
+    auto &op_stats = stats.operators[name];
+    EXPECT_EQ(op_stats.op_type, OpType::CPU);
+    EXPECT_EQ(op_stats.iterations, 1);
+    EXPECT_EQ(op_stats.samples, batch_size);
+    EXPECT_EQ(op_stats.bytes_produced, static_cast<int64_t>(batch_size * 3 * sizeof(int)));
+    int64_t histogram_samples = 0;
+    for (auto count : op_stats.sample_latency_histogram) {
+      histogram_samples += count;
+    }
+    EXPECT_EQ(histogram_samples, batch_size);
+  }
+  EXPECT_EQ(stats.stages[OpType::CPU].iterations, 1);
+  EXPECT_EQ(stats.stages[OpType::GPU].iterations, 1);
+}
+
+// Passes the data through and waits until two instances of the op run at the same time
+class OverlapOp : public Operator<CPUBackend> {
+ public:
+  explicit OverlapOp(const OpSpec &spec) : Operator<CPUBackend>(spec) {}
+
+  static int &NumRunning() {
+    static int num_running = 0;
+    return num_running;
+  }
+
+  static std::atomic<int> &NumOverlapped() {
+    static std::atomic<int> num_overlapped{0};
+    return num_overlapped;
+  }
+
+ protected:
+  bool SetupImpl(std::vector<OutputDesc> &output_desc, const HostWorkspace &ws) override {
+    return false;
+  }
+
+  void RunImpl(HostWorkspace &ws) override {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      NumRunning()++;
+      cv_.notify_all();
+      if (cv_.wait_for(lock, std::chrono::seconds(10), [] { return NumRunning() >= 2; }))
+        NumOverlapped()++;
+    }
+    auto &input = ws.InputRef<CPUBackend>(0);
+    auto &output = ws.OutputRef<CPUBackend>(0);
+    output.set_type(input.type());
+    output.Resize(input.shape());
+    for (size_t i = 0; i < input.ntensor(); i++) {
+      std::memcpy(output[i].raw_mutable_data(), input[i].raw_data(), input[i].nbytes());
+    }
+  }
+
+ private:
+  static std::mutex mutex_;
+  static std::condition_variable cv_;
+};
+
+std::mutex OverlapOp::mutex_;
+std::condition_variable OverlapOp::cv_;
+
+DALI_REGISTER_OPERATOR(OverlapOp, OverlapOp, CPU);
+
+DALI_SCHEMA(OverlapOp)
+  .DocStr("OverlapOp")
+  .NumInput(1)
+  .NumOutput(1);
+
+TYPED_TEST(ExecutorCPUOnlyTest, TestConcurrentBranches) {
+  const int batch_size = 2;
+  this->set_batch_size(batch_size);
+  auto exe = this->GetExecutor(this->batch_size_, this->num_threads_, CPU_ONLY_DEVICE_ID, 1);
+  exe->Init();
+
+  // Two independent branches, consuming the same data
+  OpGraph graph;
+  graph.AddOp(this->PrepareSpec(
+          OpSpec("ExternalSource")
+          .AddArg("device", "cpu")
+          .AddArg("device_id", CPU_ONLY_DEVICE_ID)
+          .AddOutput("data", "cpu")), "");
+  graph.AddOp(this->PrepareSpec(
+          OpSpec("OverlapOp")
+          .AddArg("device", "cpu")
+          .AddInput("data", "cpu")
+          .AddOutput("branch0", "cpu")), "");
+  graph.AddOp(this->PrepareSpec(
+          OpSpec("OverlapOp")
+          .AddArg("device", "cpu")
+          .AddInput("data", "cpu")
+          .AddOutput("branch1", "cpu")), "");
+
+  vector<string> outputs = {"branch0_cpu", "branch1_cpu"};
+  exe->Build(&graph, outputs);
+
+  auto *src_op =
+      dynamic_cast<ExternalSource<CPUBackend> *>(graph.Node(OpType::CPU, 0).op.get());
+  ASSERT_NE(src_op, nullptr);
+  vector<Tensor<CPUBackend>> batch(batch_size);
+  for (int i = 0; i < batch_size; ++i) {
+    batch[i].Resize({2});
+    batch[i].mutable_data<int>()[0] = i;
+    batch[i].mutable_data<int>()[1] = -i;
+  }
+
+  OverlapOp::NumRunning() = 0;
+  OverlapOp::NumOverlapped() = 0;
+  src_op->SetDataSource(batch);
+  exe->RunCPU();
+  exe->RunMixed();
+  exe->RunGPU();
+
+  HostWorkspace ws;
+  exe->Outputs(&ws);
+  EXPECT_EQ(OverlapOp::NumOverlapped(), 2);
+  ASSERT_EQ(ws.NumOutput(), 2);
+  for (int out_idx = 0; out_idx < 2; out_idx++) {
+    for (int i = 0; i < batch_size; ++i) {
+      auto &out = ws.Output<CPUBackend>(out_idx, i);
+      EXPECT_EQ(out.template data<int>()[0], i);
+      EXPECT_EQ(out.template data<int>()[1], -i);
+    }
+  }
+}
+
+TYPED_TEST(ExecutorCPUOnlyTest, TestMemoryPlanning) {
+  const int batch_size = 3;
+  this->set_batch_size(batch_size);
+  auto exe = this->GetExecutor(this->batch_size_, this->num_threads_, CPU_ONLY_DEVICE_ID, 1);
+  exe->Init();
+  exe->EnableMemoryPlanning(true);
+
+  // data -> data0 -> data1 -> data2 -> data3, data2 can reuse the storage of data0
+  OpGraph graph;
+  graph.AddOp(this->PrepareSpec(
+          OpSpec("ExternalSource")
+          .AddArg("device", "cpu")
+          .AddArg("device_id", CPU_ONLY_DEVICE_ID)
+          .AddOutput("data", "cpu")), "");
+  for (int i = 0; i < 4; i++) {
+    std::string input = i == 0 ? "data" : "data" + std::to_string(i - 1);
+    graph.AddOp(this->PrepareSpec(
+            OpSpec("SampleTraceOp")
+            .AddArg("device", "cpu")
+            .AddArg("trace_id", i)
+            .AddArg("per_sample", false)
+            .AddInput(input, "cpu")
+            .AddOutput("data" + std::to_string(i), "cpu")), "trace" + std::to_string(i));
+  }
+
+  vector<string> outputs = {"data3_cpu"};
+  exe->Build(&graph, outputs);
+
+  auto *src_op =
+      dynamic_cast<ExternalSource<CPUBackend> *>(graph.Node(OpType::CPU, 0).op.get());
+  ASSERT_NE(src_op, nullptr);
+  for (int iter = 0; iter < 2; iter++) {
+    // the samples grow in the second iteration
+    int sample_size = 3 + iter * 100;
+    vector<Tensor<CPUBackend>> batch(batch_size);
+    for (int i = 0; i < batch_size; ++i) {
+      batch[i].Resize({sample_size});
+      auto *data = batch[i].mutable_data<int>();
+      for (int j = 0; j < sample_size; j++) {
+        data[j] = 10 * i + j;
+      }
+    }
+    src_op->SetDataSource(batch);
+    exe->RunCPU();
+    exe->RunMixed();
+    exe->RunGPU();
+
+    HostWorkspace ws;
+    exe->Outputs(&ws);
+    ASSERT_EQ(ws.NumOutputAtIdx(0), batch_size);
+    for (int i = 0; i < batch_size; ++i) {
+      auto &out = ws.Output<CPUBackend>(0, i);
+      ASSERT_EQ(out.size(), sample_size);
+      for (int j = 0; j < sample_size; j++) {
+        EXPECT_EQ(out.template data<int>()[j], 10 * i + j + 4);
+      }
+    }
+  }
+
+  auto stats = exe->GetStats();
+  EXPECT_EQ(stats.memory.aliased_tensors, 2);
+  EXPECT_EQ(stats.memory.shared_buffers, 1);
+  EXPECT_EQ(stats.memory.peak_bytes_saved, static_cast<int64_t>(batch_size * 103 * sizeof(int)));
+}
+
+TYPED_TEST(ExecutorCPUOnlyTest, TestRejectMixedOps) {
+  auto exe = this->GetExecutor(this->batch_size_, this->num_threads_, CPU_ONLY_DEVICE_ID, 1);
+  exe->Init();
+
+  OpGraph graph;
+  graph.AddOp(this->PrepareSpec(
+          OpSpec("DummyOp")
+          .AddArg("device", "cpu")
+          .AddArg("num_outputs", 1)
+          .AddOutput("data", "cpu")), "");
+
+  graph.AddOp(this->PrepareSpec(
+          OpSpec("MakeContiguous")
+          .AddArg("device", "mixed")
+          .AddInput("data", "cpu")
+          .AddOutput("data_cont", "cpu")), "");
+
+  vector<string> outputs = {"data_cont_cpu"};
+  EXPECT_THROW(exe->Build(&graph, outputs), std::exception);
+}
+
 }  // namespace dali
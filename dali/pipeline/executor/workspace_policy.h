@@ -149,7 +149,7 @@ void SetupInputOutput(op_type_to_workspace_t<op_type> &ws, const OpGraph &graph,
 template <OpType op_type>
 inline void SetupThreadPool(op_type_to_workspace_t<op_type> &ws, const OpGraph &, const OpNode &,
                             ThreadPool *, const QueueIdxs) {
-  /* No-op if we are not CPU */
+  /* No-op if we are not CPU or Mixed */
 }
 
 template <>
@@ -158,6 +158,13 @@ inline void SetupThreadPool<OpType::CPU>(op_type_to_workspace_t<OpType::CPU> &ws
   ws.SetThreadPool(thread_pool);
 }
 
+template <>
+inline void SetupThreadPool<OpType::MIXED>(op_type_to_workspace_t<OpType::MIXED> &ws,
+                                           const OpGraph &, const OpNode &,
+                                           ThreadPool *thread_pool, const QueueIdxs) {
+  ws.SetThreadPool(thread_pool);
+}
+
 template <OpType op_type>
 void SetupStreamsAndEvents(op_type_to_workspace_t<op_type> &ws,
                            const OpGraph &graph, const OpNode &node,
@@ -46,8 +46,10 @@ void ExternalSource<CPUBackend>::RunImpl(HostWorkspace &ws) {
   }
   auto &thread_pool = ws.GetThreadPool();
   for (int data_idx = 0; data_idx < batch_size_; ++data_idx) {
-    thread_pool.DoWorkWithID([&ws, data_idx, is_tl_data, &tensor_list_elm, &vector_tensor_elm]
-                             (int tid) {
+    int64_t size = is_tl_data ? volume(tensor_list_elm.front()->tensor_shape(data_idx))
+                              : (*(vector_tensor_elm.front()))[data_idx].size();
+    thread_pool.AddWork([&ws, data_idx, is_tl_data, &tensor_list_elm, &vector_tensor_elm]
+                        (int tid) {
       Tensor<CPUBackend> &output = ws.Output<CPUBackend>(0, data_idx);
       // HostWorkspace doesn't have any stream
       cudaStream_t stream = 0;
@@ -57,9 +59,9 @@ void ExternalSource<CPUBackend>::RunImpl(HostWorkspace &ws) {
         auto &data = (*(vector_tensor_elm.front()))[data_idx];
         output.Copy(data, stream);
       }
-    });
+    }, size);
   }
-  thread_pool.WaitForWork();
+  thread_pool.RunAll();
   if (is_tl_data) {
     RecycleBuffer(tensor_list_elm);
   } else {
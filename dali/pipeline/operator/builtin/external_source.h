@@ -125,6 +125,8 @@ class ExternalSource : public Operator<Backend> {
     Operator<Backend>(spec),
     sync_worker_(spec.GetArgument<int>("device_id"), false) {
     output_name_ = spec.Output(0);
+    // CPU-only pipelines can't allocate pinned memory
+    pinned_staging_ = spec.GetArgument<int>("device_id") != CPU_ONLY_DEVICE_ID;
     sync_worker_.WaitForInit();
   }
 
@@ -153,6 +155,8 @@ class ExternalSource : public Operator<Backend> {
       data = tl_data_.GetEmpty();
     }
 
+    if (data.front()->is_pinned() != pinned_staging_)
+      data.front()->set_pinned(pinned_staging_);
     data.front()->Copy(tl, 0);
     {
       std::lock_guard<std::mutex> busy_lock(busy_m_);
@@ -180,7 +184,10 @@ class ExternalSource : public Operator<Backend> {
 
     data.front()->resize(t.size());
     for (size_t i = 0; i < t.size(); ++i) {
-      (*(data.front()))[i].Copy(t[i], 0);
+      auto &sample = (*(data.front()))[i];
+      if (sample.is_pinned() != pinned_staging_)
+        sample.set_pinned(pinned_staging_);
+      sample.Copy(t[i], 0);
     }
     {
       std::lock_guard<std::mutex> busy_lock(busy_m_);
@@ -234,6 +241,8 @@ class ExternalSource : public Operator<Backend> {
   detail::CachingList<uptr_vt_type> t_data_;
   detail::CachingList<uptr_cuda_event_type> cuda_events_;
   std::list<bool> data_in_tl_;
+  // whether the data is staged in pinned memory
+  bool pinned_staging_ = true;
   struct RecycleFunctor;
 
   std::mutex busy_m_;
@@ -16,10 +16,12 @@
 #define DALI_PIPELINE_OPERATOR_BUILTIN_MAKE_CONTIGUOUS_H_
 
 #include <algorithm>
+#include <utility>
 #include <vector>
 
 #include "dali/pipeline/operator/operator.h"
 #include "dali/pipeline/operator/common.h"
+#include "dali/pipeline/util/batch_copy.h"
 #include "dali/core/common.h"
 
 // Found by benchmarking coalesced vs non coalesced on diff size images
@@ -71,15 +73,7 @@ class MakeContiguous : public Operator<MixedBackend> {
       output.SetLayout(layout);
       output.set_type(type);
 
-      for (int i = 0; i < batch_size_; ++i) {
-        auto &input = ws.Input<CPUBackend>(0, i);
-
-        // Note: We know that this will translate into
-        // a std::memcpy, so it is safe to pass stream 0
-        type.Copy<CPUBackend, CPUBackend>(
-            output.raw_mutable_tensor(i),
-            input.raw_data(), input.size(), 0);
-      }
+      GatherSamples(ws, output);
     } else {
       auto &output = ws.Output<GPUBackend>(0);
       output.Resize(output_shape);
@@ -98,10 +92,7 @@ class MakeContiguous : public Operator<MixedBackend> {
         cpu_output_buff.SetLayout(layout);
         cpu_output_buff.set_type(type);
 
-        for (int i = 0; i < batch_size_; ++i) {
-          auto &input = ws.Input<CPUBackend>(0, i);
-          memcpy(cpu_output_buff.raw_mutable_tensor(i), input.raw_data(), input.nbytes());
-        }
+        GatherSamples(ws, cpu_output_buff);
         CUDA_CALL(cudaMemcpyAsync(
               output.raw_mutable_data(),
               cpu_output_buff.raw_mutable_data(),
@@ -127,6 +118,18 @@ class MakeContiguous : public Operator<MixedBackend> {
   DISABLE_COPY_MOVE_ASSIGN(MakeContiguous);
 
  protected:
+  // Copies the input samples to the slices of the host `output`, on the thread pool
+  // of the CPU stage if the workspace has one
+  void GatherSamples(MixedWorkspace &ws, TensorList<CPUBackend> &output) {
+    std::vector<SampleCopy> copies;
+    copies.reserve(batch_size_);
+    for (int i = 0; i < batch_size_; ++i) {
+      auto &input = ws.Input<CPUBackend>(0, i);
+      copies.push_back({ output.raw_mutable_tensor(i), input.raw_data(), input.nbytes() });
+    }
+    CopySamples(std::move(copies), ws.HasThreadPool() ? &ws.GetThreadPool() : nullptr);
+  }
+
   USE_OPERATOR_MEMBERS();
   TensorList<CPUBackend> cpu_output_buff;
   bool coalesced;
@@ -376,6 +376,15 @@ class DLL_PUBLIC OpSchema {
     return *this;
   }
 
+  /**
+   * @brief Notes that the outputs of this operator may share the memory
+   * of its inputs instead of holding a copy.
+   */
+  DLL_PUBLIC inline OpSchema& PassThrough() {
+    pass_through_ = true;
+    return *this;
+  }
+
   DLL_PUBLIC inline const vector<std::string>& GetParents() const {
     return parents_;
   }
@@ -426,6 +435,10 @@ class DLL_PUBLIC OpSchema {
     return no_prune_;
   }
 
+  DLL_PUBLIC inline bool IsPassThrough() const {
+    return pass_through_;
+  }
+
   DLL_PUBLIC int CalculateOutputs(const OpSpec &spec) const;
 
   DLL_PUBLIC int CalculateAdditionalOutputs(const OpSpec &spec) const {
@@ -501,6 +514,8 @@ class DLL_PUBLIC OpSchema {
 
   bool no_prune_ = false;
 
+  bool pass_through_ = false;
+
   bool is_deprecated_ = false;
   string deprecated_in_favor_of_;
 
@@ -0,0 +1,101 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dali/pipeline/operator/op_stats.h"
+
+namespace dali {
+
+namespace {
+
+void AtomicMax(std::atomic<int64_t> &value, int64_t candidate) {
+  int64_t current = value.load(std::memory_order_relaxed);
+  while (current < candidate &&
+         !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {}
+}
+
+int LatencyBucket(int64_t time_ns) {
+  int64_t time_us = time_ns / 1000;
+  int bucket = 0;
+  while (time_us > 0 && bucket < OperatorStats::kNumLatencyBuckets - 1) {
+    time_us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+}  // namespace
+
+void OperatorStatsCollector::AddIteration(int64_t time_ns, int64_t bytes_produced) {
+  iterations_.fetch_add(1, std::memory_order_relaxed);
+  total_time_ns_.fetch_add(time_ns, std::memory_order_relaxed);
+  AtomicMax(max_time_ns_, time_ns);
+  bytes_produced_.fetch_add(bytes_produced, std::memory_order_relaxed);
+}
+
+void OperatorStatsCollector::AddSample(int64_t time_ns) {
+  samples_.fetch_add(1, std::memory_order_relaxed);
+  total_sample_time_ns_.fetch_add(time_ns, std::memory_order_relaxed);
+  sample_latency_histogram_[LatencyBucket(time_ns)].fetch_add(1, std::memory_order_relaxed);
+}
+
+OperatorStats OperatorStatsCollector::Get() const {
+  OperatorStats stats;
+  stats.iterations = iterations_.load(std::memory_order_relaxed);
+  stats.total_time_ns = total_time_ns_.load(std::memory_order_relaxed);
+  stats.max_time_ns = max_time_ns_.load(std::memory_order_relaxed);
+  stats.wait_time_ns = wait_time_ns_.load(std::memory_order_relaxed);
+  stats.bytes_produced = bytes_produced_.load(std::memory_order_relaxed);
+  stats.samples = samples_.load(std::memory_order_relaxed);
+  stats.total_sample_time_ns = total_sample_time_ns_.load(std::memory_order_relaxed);
+  for (int i = 0; i < OperatorStats::kNumLatencyBuckets; i++) {
+    stats.sample_latency_histogram[i] = sample_latency_histogram_[i].load(
+        std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void OperatorStatsCollector::Reset() {
+  iterations_ = 0;
+  total_time_ns_ = 0;
+  max_time_ns_ = 0;
+  wait_time_ns_ = 0;
+  bytes_produced_ = 0;
+  samples_ = 0;
+  total_sample_time_ns_ = 0;
+  for (auto &count : sample_latency_histogram_) {
+    count = 0;
+  }
+}
+
+void StageStatsCollector::AddWait(int64_t time_ns) {
+  iterations_.fetch_add(1, std::memory_order_relaxed);
+  wait_time_ns_.fetch_add(time_ns, std::memory_order_relaxed);
+  AtomicMax(max_wait_time_ns_, time_ns);
+}
+
+StageStats StageStatsCollector::Get() const {
+  StageStats stats;
+  stats.iterations = iterations_.load(std::memory_order_relaxed);
+  stats.wait_time_ns = wait_time_ns_.load(std::memory_order_relaxed);
+  stats.max_wait_time_ns = max_wait_time_ns_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void StageStatsCollector::Reset() {
+  iterations_ = 0;
+  wait_time_ns_ = 0;
+  max_wait_time_ns_ = 0;
+}
+
+}  // namespace dali
@@ -0,0 +1,130 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_PIPELINE_OPERATOR_OP_STATS_H_
+#define DALI_PIPELINE_OPERATOR_OP_STATS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+
+#include "dali/core/api_helper.h"
+#include "dali/core/common.h"
+
+namespace dali {
+
+// Monotonic time in nanoseconds, used for the statistics
+inline int64_t stats_now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct OperatorStats {
+  // sample_latency_histogram[0] counts the samples processed in less than 1 us,
+  // sample_latency_histogram[i] the ones processed in [2^(i-1), 2^i) us,
+  // the last bucket counts also all the longer ones
+  static constexpr int kNumLatencyBuckets = 24;
+
+  std::string name;
+  OpType op_type = OpType::CPU;
+  // Number of runs and their wall time, as seen by the host. For the GPU operators this is
+  // the time of issuing the work.
+  int64_t iterations = 0;
+  int64_t total_time_ns = 0;
+  int64_t max_time_ns = 0;
+  // Time spent waiting for the data, e.g. by a reader for its prefetching thread
+  int64_t wait_time_ns = 0;
+  int64_t bytes_produced = 0;
+  // Samples processed one by one, by the per-sample operators
+  int64_t samples = 0;
+  int64_t total_sample_time_ns = 0;
+  std::array<int64_t, kNumLatencyBuckets> sample_latency_histogram = {};
+};
+
+struct StageStats {
+  int64_t iterations = 0;
+  // Time spent waiting for the queue of the stage to provide the buffers for the iteration
+  int64_t wait_time_ns = 0;
+  int64_t max_wait_time_ns = 0;
+};
+
+struct MemoryPlanStats {
+  // CPU intermediates sharing their storage with other ones, and the buffers they share
+  int64_t aliased_tensors = 0;
+  int64_t shared_buffers = 0;
+  // The sum of the peak sizes of the aliased tensors, minus the peak size of the biggest
+  // tensor in every shared buffer
+  int64_t peak_bytes_saved = 0;
+};
+
+struct ExecutorStats {
+  // by the operator instance name
+  std::map<std::string, OperatorStats> operators;
+  std::map<OpType, StageStats> stages;
+  MemoryPlanStats memory;
+};
+
+/**
+ * @brief Collects the statistics of an operator.
+ *
+ * Uses only relaxed atomic counters, so it can be updated from many threads
+ * and left enabled in production.
+ */
+class DLL_PUBLIC OperatorStatsCollector {
+ public:
+  DLL_PUBLIC void AddIteration(int64_t time_ns, int64_t bytes_produced);
+
+  DLL_PUBLIC void AddSample(int64_t time_ns);
+
+  DLL_PUBLIC void AddWait(int64_t time_ns) {
+    wait_time_ns_.fetch_add(time_ns, std::memory_order_relaxed);
+  }
+
+  DLL_PUBLIC OperatorStats Get() const;
+
+  DLL_PUBLIC void Reset();
+
+ private:
+  std::atomic<int64_t> iterations_{0};
+  std::atomic<int64_t> total_time_ns_{0};
+  std::atomic<int64_t> max_time_ns_{0};
+  std::atomic<int64_t> wait_time_ns_{0};
+  std::atomic<int64_t> bytes_produced_{0};
+  std::atomic<int64_t> samples_{0};
+  std::atomic<int64_t> total_sample_time_ns_{0};
+  std::array<std::atomic<int64_t>, OperatorStats::kNumLatencyBuckets> sample_latency_histogram_{};
+};
+
+/**
+ * @brief Collects the queue wait times of an executor stage
+ */
+class DLL_PUBLIC StageStatsCollector {
+ public:
+  DLL_PUBLIC void AddWait(int64_t time_ns);
+
+  DLL_PUBLIC StageStats Get() const;
+
+  DLL_PUBLIC void Reset();
+
+ private:
+  std::atomic<int64_t> iterations_{0};
+  std::atomic<int64_t> wait_time_ns_{0};
+  std::atomic<int64_t> max_wait_time_ns_{0};
+};
+
+}  // namespace dali
+
+#endif  // DALI_PIPELINE_OPERATOR_OP_STATS_H_
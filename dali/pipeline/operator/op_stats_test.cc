@@ -0,0 +1,89 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "dali/pipeline/operator/op_stats.h"
+
+namespace dali {
+
+TEST(OperatorStatsTest, Iterations) {
+  OperatorStatsCollector collector;
+  collector.AddIteration(100, 10);
+  collector.AddIteration(300, 20);
+  collector.AddIteration(200, 30);
+  collector.AddWait(50);
+  auto stats = collector.Get();
+  EXPECT_EQ(stats.iterations, 3);
+  EXPECT_EQ(stats.total_time_ns, 600);
+  EXPECT_EQ(stats.max_time_ns, 300);
+  EXPECT_EQ(stats.bytes_produced, 60);
+  EXPECT_EQ(stats.wait_time_ns, 50);
+  EXPECT_EQ(stats.samples, 0);
+
+  collector.Reset();
+  stats = collector.Get();
+  EXPECT_EQ(stats.iterations, 0);
+  EXPECT_EQ(stats.max_time_ns, 0);
+}
+
+TEST(OperatorStatsTest, LatencyHistogram) {
+  OperatorStatsCollector collector;
+  collector.AddSample(500);                  // < 1 us
+  collector.AddSample(1000);                 // [1, 2) us
+  collector.AddSample(3500);                 // [2, 4) us
+  collector.AddSample(1000000);              // [512, 1024) us
+  collector.AddSample(int64_t(1) << 50);     // the last bucket
+  auto stats = collector.Get();
+  EXPECT_EQ(stats.samples, 5);
+  EXPECT_EQ(stats.total_sample_time_ns, 500 + 1000 + 3500 + 1000000 + (int64_t(1) << 50));
+  std::array<int64_t, OperatorStats::kNumLatencyBuckets> expected = {};
+  expected[0] = 1;
+  expected[1] = 1;
+  expected[2] = 1;
+  expected[10] = 1;
+  expected[OperatorStats::kNumLatencyBuckets - 1] = 1;
+  EXPECT_EQ(stats.sample_latency_histogram, expected);
+}
+
+TEST(OperatorStatsTest, ConcurrentUpdates) {
+  OperatorStatsCollector collector;
+  StageStatsCollector stage_collector;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < 1000; i++) {
+        collector.AddSample(1000 * t);
+        collector.AddIteration(i + t, 1);
+        stage_collector.AddWait(t);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  auto stats = collector.Get();
+  EXPECT_EQ(stats.samples, 4000);
+  EXPECT_EQ(stats.iterations, 4000);
+  EXPECT_EQ(stats.bytes_produced, 4000);
+  EXPECT_EQ(stats.max_time_ns, 999 + 3);
+  auto stage_stats = stage_collector.Get();
+  EXPECT_EQ(stage_stats.iterations, 4000);
+  EXPECT_EQ(stage_stats.wait_time_ns, 1000 * (0 + 1 + 2 + 3));
+  EXPECT_EQ(stage_stats.max_wait_time_ns, 3);
+}
+
+}  // namespace dali
@@ -30,6 +30,7 @@
 #include "dali/pipeline/data/backend.h"
 #include "dali/pipeline/operator/op_schema.h"
 #include "dali/pipeline/operator/op_spec.h"
+#include "dali/pipeline/operator/op_stats.h"
 #include "dali/pipeline/operator/operator_factory.h"
 #include "dali/pipeline/util/backend2workspace_map.h"
 #include "dali/pipeline/workspace/device_workspace.h"
@@ -111,6 +112,19 @@ class DLL_PUBLIC OperatorBase {
     return false;
   }
 
+  /**
+   * @brief If Operator processes every sample on its own, with `RunImpl(SampleWorkspace&)`,
+   * the executor can run it on a sample right after the preceding per-sample operators,
+   * without waiting for the rest of the batch.
+   *
+   * Such Operator cannot use the data of its inputs in `Setup` and in
+   * `SetupSharedSampleParams(HostWorkspace&)`, unless it can infer its outputs
+   * (then it is only run as the first operator of a chain).
+   */
+  DLL_PUBLIC virtual bool CanRunPerSample() const {
+    return false;
+  }
+
   /**
    * @brief Executes the operator on a batch of samples on the CPU.
    */
@@ -149,11 +163,53 @@ class DLL_PUBLIC OperatorBase {
     return -1;
   }
 
+  /**
+   * @brief For reader Ops, returns true, as they keep a position in the data set
+   * that can be saved in a checkpoint. For all other Ops, returns false
+   */
+  DLL_PUBLIC virtual bool HasState() const {
+    return false;
+  }
+
+  /**
+   * @brief Makes the Operator keep its state after each of the recent iterations,
+   * so it can be saved with `SaveState`. Called before the first run.
+   */
+  DLL_PUBLIC virtual void EnableCheckpointing() {
+    DALI_FAIL("Checkpointing is not supported by " + name());
+  }
+
+  /**
+   * @brief Returns the state of the Operator after its first `iteration` runs
+   */
+  DLL_PUBLIC virtual std::string SaveState(int64_t iteration) {
+    DALI_FAIL("Checkpointing is not supported by " + name());
+  }
+
+  /**
+   * @brief Restores the state returned by `SaveState`. Called before the first run.
+   */
+  DLL_PUBLIC virtual void RestoreState(const std::string &state) {
+    DALI_FAIL("Checkpointing is not supported by " + name());
+  }
+
   template <typename Workspace>
   TensorLayout InputLayout(const Workspace &ws, int index) const {
     return GetInputLayout(ws, spec_.GetSchema(), index);
   }
 
+  /**
+   * @brief Run time statistics of the operator, collected by the executor and by the
+   * operator itself (e.g. the per-sample latencies or the time a reader waits for the data)
+   */
+  DLL_PUBLIC OperatorStatsCollector &stats() {
+    return stats_;
+  }
+
+  DLL_PUBLIC const OperatorStatsCollector &stats() const {
+    return stats_;
+  }
+
   DLL_PUBLIC bool CanBePruned() const {
     const auto &schema = spec_.GetSchema();
     return !spec_.GetArgument<bool>("preserve") && !schema.IsNoPrune();
@@ -215,6 +271,7 @@ class DLL_PUBLIC OperatorBase {
   int default_cuda_stream_priority_;
   std::bernoulli_distribution op_dis_;
   std::mt19937 op_rng_;
+  OperatorStatsCollector stats_;
 };
 
 #define USE_OPERATOR_MEMBERS()      \
@@ -254,7 +311,7 @@ class Operator<CPUBackend> : public OperatorBase {
     CheckInputLayouts(ws, spec_);
     SetupSharedSampleParams(ws);
     RunImpl(ws);
-    ws.GetThreadPool().WaitForWork();
+    ws.GetThreadPool().RunAll();
   }
 
   /**
@@ -281,17 +338,29 @@ class Operator<CPUBackend> : public OperatorBase {
     // This is implemented, as a default, using the RunImpl that accepts SampleWorkspace,
     // allowing for fallback to old per-sample implementations.
 
+    // The samples are submitted together and the biggest ones are processed first
+    bool has_input = ws.NumInput() > 0 && ws.InputIsType<CPUBackend>(0);
+    auto &thread_pool = ws.GetThreadPool();
     for (int data_idx = 0; data_idx < batch_size_; ++data_idx) {
-      auto &thread_pool = ws.GetThreadPool();
-      thread_pool.DoWorkWithID([this, &ws, data_idx](int tid) {
+      int64_t cost = has_input ? ws.Input<CPUBackend>(0, data_idx).nbytes() : 0;
+      thread_pool.AddWork([this, &ws, data_idx](int tid) {
         SampleWorkspace sample;
         ws.GetSample(&sample, data_idx, tid);
-        this->SetupSharedSampleParams(sample);
-        this->RunImpl(sample);
-      });
+        this->RunSample(sample);
+      }, cost);
     }
   }
 
+  /**
+   * @brief Processes a single sample with the per-sample implementation
+   */
+  void RunSample(SampleWorkspace &ws) {
+    int64_t start = stats_now_ns();
+    SetupSharedSampleParams(ws);
+    RunImpl(ws);
+    stats_.AddSample(stats_now_ns() - start);
+  }
+
   /**
    * @brief Shared param setup. Legacy implementation for per-sample approach
    *
@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <map>
 #include <memory>
 
 #include "dali/pipeline/executor/async_pipelined_executor.h"
@@ -28,6 +29,7 @@
 
 #include "dali/pipeline/operator/argument.h"
 #include "dali/pipeline/operator/common.h"
+#include "dali/pipeline/util/state_io.h"
 #include "dali/core/device_guard.h"
 #include "dali/pipeline/dali.pb.h"
 
@@ -143,21 +145,24 @@ void Pipeline::Init(int batch_size, int num_threads, int device_id, int64_t seed
     this->prefetch_queue_depth_ = prefetch_queue_depth;
     DALI_ENFORCE(batch_size_ > 0, "Batch size must be greater than 0");
 
-    int lowest_cuda_stream_priority, highest_cuda_stream_priority;
-    CUDA_CALL(cudaDeviceGetStreamPriorityRange(&lowest_cuda_stream_priority,
-                                               &highest_cuda_stream_priority));
-    const auto min_priority_value =
-        std::min(lowest_cuda_stream_priority, highest_cuda_stream_priority);
-    const auto max_priority_value =
-        std::max(lowest_cuda_stream_priority, highest_cuda_stream_priority);
-    DALI_ENFORCE(
-        default_cuda_stream_priority >= min_priority_value &&
-        default_cuda_stream_priority <= max_priority_value,
-        "Provided default cuda stream priority `" + std::to_string(default_cuda_stream_priority) +
-        "` is outside the priority range [" + std::to_string(min_priority_value) + ", " +
-        std::to_string(max_priority_value) + "], with lowest priority being `" +
-        std::to_string(lowest_cuda_stream_priority) + "` and highest priority being `" +
-        std::to_string(highest_cuda_stream_priority) + "`");
+    if (device_id != CPU_ONLY_DEVICE_ID) {
+      int lowest_cuda_stream_priority, highest_cuda_stream_priority;
+      CUDA_CALL(cudaDeviceGetStreamPriorityRange(&lowest_cuda_stream_priority,
+                                                 &highest_cuda_stream_priority));
+      const auto min_priority_value =
+          std::min(lowest_cuda_stream_priority, highest_cuda_stream_priority);
+      const auto max_priority_value =
+          std::max(lowest_cuda_stream_priority, highest_cuda_stream_priority);
+      DALI_ENFORCE(
+          default_cuda_stream_priority >= min_priority_value &&
+          default_cuda_stream_priority <= max_priority_value,
+          "Provided default cuda stream priority `" +
+          std::to_string(default_cuda_stream_priority) +
+          "` is outside the priority range [" + std::to_string(min_priority_value) + ", " +
+          std::to_string(max_priority_value) + "], with lowest priority being `" +
+          std::to_string(lowest_cuda_stream_priority) + "` and highest priority being `" +
+          std::to_string(highest_cuda_stream_priority) + "`");
+    }
 
     seed_.resize(MAX_SEEDS);
     current_seed_ = 0;
@@ -213,6 +218,9 @@ int Pipeline::AddOperator(OpSpec spec, const std::string& inst_name, int logical
     spec.SetArg("device", "cpu");
   }
 
+  DALI_ENFORCE(device_id_ != CPU_ONLY_DEVICE_ID || device == "cpu",
+    "Cannot add \"" + device + "\" operator " + spec.name() + " to a CPU-only pipeline");
+
   // If necessary, split ImageDecoder operator in two separated stages (CPU and Mixed-GPU)
   auto operator_name = spec.name();
   bool split_stages = false;
@@ -438,6 +446,8 @@ void Pipeline::Build(vector<std::pair<string, string>> output_names) {
   output_names_ = output_names;
   DALI_ENFORCE(!built_, "\"Build()\" can only be called once.");
   DALI_ENFORCE(output_names.size() > 0, "User specified zero outputs.");
+  DALI_ENFORCE(device_id_ != CPU_ONLY_DEVICE_ID || !separated_execution_,
+      "CPU-only pipeline doesn't support separated execution.");
 
   executor_ = GetExecutor(pipelined_execution_, separated_execution_, async_execution_, batch_size_,
                           num_threads_, device_id_, bytes_per_sample_hint_, set_affinity_,
@@ -473,7 +483,10 @@ void Pipeline::Build(vector<std::pair<string, string>> output_names) {
       DALI_ENFORCE(it->second.has_cpu, "Requested cpu output '" +
           name + "' only exists on gpu.");
 
-      if (!it->second.has_contiguous) {
+      if (device_id_ == CPU_ONLY_DEVICE_ID) {
+        // HostWorkspace outputs don't have to be contiguous
+        outputs.push_back(name + "_" + device);
+      } else if (!it->second.has_contiguous) {
         // Add a make contiguous op to produce this output
         OpSpec spec =
           OpSpec("MakeContiguous")
@@ -490,6 +503,8 @@ void Pipeline::Build(vector<std::pair<string, string>> output_names) {
         outputs.push_back(name + "_" + device);
       }
     } else if (device == "gpu") {
+      DALI_ENFORCE(device_id_ != CPU_ONLY_DEVICE_ID,
+          "Requested gpu output '" + name + "' from a CPU-only pipeline.");
       if (!it->second.has_gpu) {
         DALI_ENFORCE(it->second.has_cpu, "Output '" + name +
             "' exists on neither cpu or gpu, internal error");
@@ -517,6 +532,15 @@ void Pipeline::Build(vector<std::pair<string, string>> output_names) {
 
   graph_.InstantiateOperators();
 
+  if (checkpointing_) {
+    for (OpNodeId i = 0; i < graph_.NumOp(); i++) {
+      auto &node = graph_.Node(i);
+      if (node.op->HasState()) {
+        node.op->EnableCheckpointing();
+      }
+    }
+  }
+
   // Load the final graph into the executor
   executor_->Build(&graph_, outputs);
   built_ = true;
@@ -555,6 +579,8 @@ void Pipeline::Outputs(DeviceWorkspace *ws) {
     } catch (...) {
       throw std::runtime_error("Unknown Critical error in pipeline");
     }
+  outputs_returned_++;
+  TraceIteration();
 }
 
 void Pipeline::ShareOutputs(DeviceWorkspace *ws) {
@@ -569,6 +595,40 @@ void Pipeline::ShareOutputs(DeviceWorkspace *ws) {
     } catch (...) {
       throw std::runtime_error("Unknown Critical error in pipeline");
     }
+  outputs_returned_++;
+  TraceIteration();
+}
+
+void Pipeline::Outputs(HostWorkspace *ws) {
+  DALI_ENFORCE(built_,
+      "\"Build()\" must be called prior to executing the pipeline.");
+    try {
+      executor_->Outputs(ws);
+    } catch (std::exception &e) {
+      throw std::runtime_error("Critical error in pipeline: "
+          + std::string(e.what())
+          + "\nCurrent pipeline object is no longer valid.");
+    } catch (...) {
+      throw std::runtime_error("Unknown Critical error in pipeline");
+    }
+  outputs_returned_++;
+  TraceIteration();
+}
+
+void Pipeline::ShareOutputs(HostWorkspace *ws) {
+  DALI_ENFORCE(built_,
+      "\"Build()\" must be called prior to executing the pipeline.");
+    try {
+      executor_->ShareOutputs(ws);
+    } catch (std::exception &e) {
+      throw std::runtime_error("Critical error in pipeline: "
+          + std::string(e.what())
+          + "\nCurrent pipeline object is no longer valid.");
+    } catch (...) {
+      throw std::runtime_error("Unknown Critical error in pipeline");
+    }
+  outputs_returned_++;
+  TraceIteration();
 }
 
 void Pipeline::ReleaseOutputs() {
@@ -743,10 +803,105 @@ std::map<std::string, Index> Pipeline::EpochSize() {
   return ret;
 }
 
+ExecutorStats Pipeline::GetExecutorStatistics() const {
+  DALI_ENFORCE(built_,
+      "\"Build()\" must be called prior to querying the executor statistics.");
+  return executor_->GetStats();
+}
+
 void Pipeline::SaveGraphToDotFile(const std::string &filename) {
   graph_.SaveToDotFile(filename);
 }
 
+void Pipeline::EnableTracing(const std::string &filename, int dump_every_n_iterations) {
+  DALI_ENFORCE(dump_every_n_iterations <= 0 || !filename.empty(),
+      "The trace file name is required to dump the trace periodically.");
+  trace_filename_ = filename;
+  trace_dump_interval_ = dump_every_n_iterations;
+  trace_iterations_ = 0;
+  Tracer::Enable();
+}
+
+void Pipeline::DisableTracing() {
+  Tracer::Enable(false);
+  trace_dump_interval_ = 0;
+}
+
+void Pipeline::DumpTrace(const std::string &filename) {
+  Tracer::DumpChromeTrace(filename);
+}
+
+void Pipeline::TraceIteration() {
+  if (trace_dump_interval_ > 0 && ++trace_iterations_ % trace_dump_interval_ == 0) {
+    Tracer::DumpChromeTrace(trace_filename_);
+  }
+}
+
+namespace {
+
+const char kCheckpointMagic[] = "DALICKPT";
+constexpr uint32_t kCheckpointVersion = 1;
+
+}  // namespace
+
+void Pipeline::EnableCheckpointing() {
+  DALI_ENFORCE(!built_, "Checkpointing has to be enabled before \"Build()\" is called.");
+  checkpointing_ = true;
+}
+
+std::string Pipeline::GetCheckpoint() {
+  DALI_ENFORCE(built_, "\"Build()\" must be called prior to saving a checkpoint.");
+  DALI_ENFORCE(checkpointing_, "Checkpointing is not enabled for the pipeline.");
+  StateWriter writer;
+  writer.Write(std::string(kCheckpointMagic));
+  writer.Write<uint32_t>(kCheckpointVersion);
+  writer.Write<int64_t>(outputs_returned_);
+  std::vector<OpNode*> nodes;
+  for (OpNodeId i = 0; i < graph_.NumOp(); i++) {
+    auto &node = graph_.Node(i);
+    if (node.op->HasState()) {
+      nodes.push_back(&node);
+    }
+  }
+  writer.Write<uint64_t>(nodes.size());
+  for (auto *node : nodes) {
+    writer.Write(node->instance_name);
+    writer.Write(node->op->SaveState(outputs_returned_));
+  }
+  return std::move(writer.data());
+}
+
+void Pipeline::RestoreFromCheckpoint(const std::string &checkpoint) {
+  DALI_ENFORCE(built_, "\"Build()\" must be called prior to restoring a checkpoint.");
+  DALI_ENFORCE(checkpointing_, "Checkpointing is not enabled for the pipeline.");
+  StateReader reader(checkpoint);
+  DALI_ENFORCE(reader.ReadString() == kCheckpointMagic, "The data is not a DALI checkpoint.");
+  DALI_ENFORCE(reader.Read<uint32_t>() == kCheckpointVersion,
+      "Unsupported version of the checkpoint.");
+  reader.Read<int64_t>();  // the number of iterations, only informative
+  std::map<std::string, std::string> states;
+  uint64_t num_states = reader.Read<uint64_t>();
+  for (uint64_t i = 0; i < num_states; i++) {
+    auto name = reader.ReadString();
+    states[name] = reader.ReadString();
+  }
+  DALI_ENFORCE(reader.AtEnd(), "The checkpoint is corrupted.");
+
+  size_t restored = 0;
+  for (OpNodeId i = 0; i < graph_.NumOp(); i++) {
+    auto &node = graph_.Node(i);
+    if (!node.op->HasState())
+      continue;
+    auto it = states.find(node.instance_name);
+    DALI_ENFORCE(it != states.end(), "The checkpoint doesn't contain the state of \"" +
+        node.instance_name + "\". Was it saved with a different pipeline?");
+    node.op->RestoreState(it->second);
+    restored++;
+  }
+  DALI_ENFORCE(restored == states.size(),
+      "The checkpoint contains the states of operators that are not in the pipeline.");
+}
+
 int Pipeline::GetNextLogicalId() {
   int ret = next_logical_id_;
   next_logical_id_++;
@@ -67,7 +67,9 @@ class DLL_PUBLIC Pipeline {
    *
    * @param batch_size the size of the batch that should be produced.
    * @param num_threads the number of threads to use in the prefetch stage.
-   * @param device_id id of the GPU to operate on.
+   * @param device_id id of the GPU to operate on. `CPU_ONLY_DEVICE_ID` creates
+   * a pipeline of CPU operators that doesn't use the GPU, its outputs are
+   * returned in a HostWorkspace.
    * @param seed used for random number generation. Leaving the default value
    * for this parameter results in random seed
    * @param pipelined_execution whether to allocate the necessary buffers for pipeline execution
@@ -307,6 +309,21 @@ class DLL_PUBLIC Pipeline {
    */
   DLL_PUBLIC void ShareOutputs(DeviceWorkspace *ws);
 
+  /**
+   * @brief Fills the input host workspace with the output of a CPU-only pipeline.
+   * Previously returned buffers are released.
+   * This method blocks until the next batch is complete. RunCPU and RunGPU
+   * must be called prior to calling this or this method will result in
+   * deadlock.
+   */
+  DLL_PUBLIC void Outputs(HostWorkspace *ws);
+
+  /**
+   * @brief Fills the input host workspace with the output of a CPU-only pipeline.
+   * To release previously returned buffers ReleaseOutputs need to be called.
+   */
+  DLL_PUBLIC void ShareOutputs(HostWorkspace *ws);
+
   /**
    * @brief Release buffers returned by the Output call
    * This method is meant for cases where buffers are coppied out
@@ -326,6 +343,49 @@ class DLL_PUBLIC Pipeline {
    */
   DLL_PUBLIC void SaveGraphToDotFile(const std::string &filename);
 
+  /**
+   * @brief Starts recording the timeline of the execution (see `Tracer`).
+   *
+   * If `dump_every_n_iterations` is positive, the recorded events are written to `filename`
+   * as a Chrome trace every that many iterations, as the outputs are returned.
+   * The tracing is process-wide, so it covers also the other pipelines.
+   */
+  DLL_PUBLIC void EnableTracing(const std::string &filename = "",
+                                int dump_every_n_iterations = 0);
+
+  /**
+   * @brief Stops recording the timeline of the execution
+   */
+  DLL_PUBLIC void DisableTracing();
+
+  /**
+   * @brief Writes the recorded timeline of the execution as a Chrome trace JSON file
+   */
+  DLL_PUBLIC void DumpTrace(const std::string &filename);
+
+  /**
+   * @brief Makes the readers keep track of their positions, so the pipeline can be saved
+   * with `GetCheckpoint` and resumed with `RestoreFromCheckpoint`.
+   * Has to be called before `Build()`.
+   */
+  DLL_PUBLIC void EnableCheckpointing();
+
+  /**
+   * @brief Returns the state of all the readers after the iterations whose outputs were
+   * returned so far, as a small binary blob.
+   *
+   * The saved positions don't include the data prefetched by the pipeline, so the resumed
+   * pipeline starts exactly with the outputs of the next iteration.
+   */
+  DLL_PUBLIC std::string GetCheckpoint();
+
+  /**
+   * @brief Restores the readers from a checkpoint returned by `GetCheckpoint` of the same
+   * pipeline. The readers seek straight to the saved positions.
+   * Has to be called after `Build()` and before the pipeline is run.
+   */
+  DLL_PUBLIC void RestoreFromCheckpoint(const std::string &checkpoint);
+
   /**
    * @brief Returns the batch size that will be produced by the pipeline.
    */
@@ -337,6 +397,12 @@ class DLL_PUBLIC Pipeline {
    */
   DLL_PUBLIC std::map<std::string, Index> EpochSize();
 
+  /**
+   * @brief Returns the run time statistics of the operators and the stages of the executor,
+   * gathered since the pipeline was built
+   */
+  DLL_PUBLIC ExecutorStats GetExecutorStatistics() const;
+
   /**
    * @brief Returns the number of threads used by the pipeline.
    */
@@ -408,6 +474,9 @@ class DLL_PUBLIC Pipeline {
 
   inline void AddToOpSpecs(const std::string &inst_name, const OpSpec &spec, int logical_id);
 
+  // Dumps the trace if it's due
+  void TraceIteration();
+
   int GetNextLogicalId();
   int GetNextInternalLogicalId();
 
@@ -425,6 +494,11 @@ class DLL_PUBLIC Pipeline {
   int next_logical_id_ = 0;
   int next_internal_logical_id_ = -1;
   QueueSizes prefetch_queue_depth_;
+  std::string trace_filename_;
+  int trace_dump_interval_ = 0;
+  int64_t trace_iterations_ = 0;
+  bool checkpointing_ = false;
+  int64_t outputs_returned_ = 0;
 
   std::vector<int64_t> seed_;
   int original_seed_;
@@ -14,6 +14,7 @@
 
 #include "dali/pipeline/pipeline.h"
 
+#include <cstdlib>
 #include <cuda_runtime_api.h>
 #include <gtest/gtest.h>
 
@@ -776,4 +777,81 @@ TEST(PipelineTest, AddOperator) {
   ASSERT_EQ(pipe.GetOperatorNode("third_op")->spec.GetArgument<int64_t>("seed"), 0xDEADBEEF);
 }
 
+namespace {
+
+void AddCPUOnlyOps(Pipeline &pipe) {
+  pipe.AddExternalInput("data");
+  pipe.AddOperator(OpSpec("Copy")
+          .AddArg("device", "cpu")
+          .AddInput("data", "cpu")
+          .AddOutput("copied", "cpu"), "copy");
+}
+
+// Feeds the external source of a pipeline built with AddCPUOnlyOps and checks the outputs.
+// Reports the errors with exceptions, so it can run in a death test.
+void RunCPUOnlyPipeline(Pipeline &pipe, int batch_size) {
+  for (int iter = 0; iter < 2; iter++) {
+    TensorList<CPUBackend> tl;
+    tl.set_pinned(false);
+    tl.Resize(uniform_list_shape(batch_size, {3}));
+    for (int i = 0; i < batch_size * 3; i++)
+      tl.mutable_data<int>()[i] = iter * 100 + i;
+    pipe.SetExternalInput("data", tl);
+    pipe.RunCPU();
+    pipe.RunGPU();
+  }
+
+  for (int iter = 0; iter < 2; iter++) {
+    HostWorkspace ws;
+    pipe.Outputs(&ws);
+    DALI_ENFORCE(ws.NumOutput() == 1 && ws.NumOutputAtIdx(0) == batch_size,
+                 "Unexpected number of outputs");
+    for (int i = 0; i < batch_size; i++) {
+      auto &out = ws.Output<CPUBackend>(0, i);
+      DALI_ENFORCE(out.shape() == TensorShape<>(3), "Unexpected output shape");
+      for (int j = 0; j < 3; j++)
+        DALI_ENFORCE(out.data<int>()[j] == iter * 100 + i * 3 + j, "Unexpected output value");
+    }
+  }
+}
+
+void RunCPUOnlyPipelineWithoutGPU() {
+  // Any call to CUDA fails when no GPU is visible. The variable is read when CUDA is
+  // initialized, which doesn't happen before in this process.
+  setenv("CUDA_VISIBLE_DEVICES", "", 1);
+  int batch_size = 4;
+  {
+    Pipeline pipe(batch_size, 2, CPU_ONLY_DEVICE_ID);
+    AddCPUOnlyOps(pipe);
+    pipe.Build({{"copied", "cpu"}});
+    RunCPUOnlyPipeline(pipe, batch_size);
+  }
+  exit(0);
+}
+
+}  // namespace
+
+TEST(PipelineTest, CPUOnly) {
+  int batch_size = 4;
+  Pipeline pipe(batch_size, 2, CPU_ONLY_DEVICE_ID);
+  AddCPUOnlyOps(pipe);
+
+  ASSERT_THROW(pipe.AddOperator(OpSpec("Copy")
+          .AddArg("device", "gpu")
+          .AddInput("data", "gpu")
+          .AddOutput("copied_gpu", "gpu"), "copy_gpu"), std::runtime_error);
+
+  pipe.Build({{"copied", "cpu"}});
+  // no MakeContiguous is needed to return the outputs
+  ASSERT_EQ(pipe.GetOperatorNode("copy")->children.size(), 0);
+
+  RunCPUOnlyPipeline(pipe, batch_size);
+}
+
+TEST(PipelineTest, CPUOnlyWithoutGPU) {
+  // Re-executes the test binary, so the pipeline runs in a process which hasn't used CUDA
+  ::testing::GTEST_FLAG(death_test_style) = "threadsafe";
+  EXPECT_EXIT(RunCPUOnlyPipelineWithoutGPU(), ::testing::ExitedWithCode(0), "");
+}
+
 }  // namespace dali
@@ -0,0 +1,111 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dali/pipeline/util/batch_copy.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "dali/pipeline/util/thread_pool.h"
+
+namespace dali {
+
+void StreamingCopy(void *dst, const void *src, size_t bytes) {
+#ifdef __SSE2__
+  auto *out = static_cast<char *>(dst);
+  auto *in = static_cast<const char *>(src);
+  // the streaming stores need an aligned destination
+  size_t head = (16 - reinterpret_cast<uintptr_t>(out) % 16) % 16;
+  if (bytes < head + 64) {
+    std::memcpy(out, in, bytes);
+    return;
+  }
+  std::memcpy(out, in, head);
+  out += head;
+  in += head;
+  bytes -= head;
+
+  for (size_t blocks = bytes / 64; blocks > 0; blocks--, out += 64, in += 64) {
+    auto *src_vec = reinterpret_cast<const __m128i *>(in);
+    auto *dst_vec = reinterpret_cast<__m128i *>(out);
+    __m128i a = _mm_loadu_si128(src_vec + 0);
+    __m128i b = _mm_loadu_si128(src_vec + 1);
+    __m128i c = _mm_loadu_si128(src_vec + 2);
+    __m128i d = _mm_loadu_si128(src_vec + 3);
+    _mm_stream_si128(dst_vec + 0, a);
+    _mm_stream_si128(dst_vec + 1, b);
+    _mm_stream_si128(dst_vec + 2, c);
+    _mm_stream_si128(dst_vec + 3, d);
+  }
+  // the streaming stores are weakly ordered - make them visible before the copy is
+  // reported as complete
+  _mm_sfence();
+  std::memcpy(out, in, bytes % 64);
+#else
+  std::memcpy(dst, src, bytes);
+#endif
+}
+
+namespace {
+
+void CopyChunk(const SampleCopy &copy) {
+  if (copy.bytes >= kStreamingCopyBytes)
+    StreamingCopy(copy.dst, copy.src, copy.bytes);
+  else
+    std::memcpy(copy.dst, copy.src, copy.bytes);
+}
+
+}  // namespace
+
+void CopySamples(std::vector<SampleCopy> copies, ThreadPool *thread_pool) {
+  // merge the copies of samples lying one after another
+  size_t merged = 0;
+  size_t total_bytes = 0;
+  for (size_t i = 0; i < copies.size(); i++) {
+    const auto &copy = copies[i];
+    if (!copy.bytes)
+      continue;
+    total_bytes += copy.bytes;
+    if (merged > 0) {
+      auto &prev = copies[merged - 1];
+      if (static_cast<char *>(prev.dst) + prev.bytes == copy.dst &&
+          static_cast<const char *>(prev.src) + prev.bytes == copy.src) {
+        prev.bytes += copy.bytes;
+        continue;
+      }
+    }
+    copies[merged++] = copy;
+  }
+  copies.resize(merged);
+
+  if (!thread_pool || thread_pool->size() <= 1 || total_bytes < kMinParallelCopyBytes) {
+    for (auto &copy : copies)
+      CopyChunk(copy);
+    return;
+  }
+
+  for (auto &copy : copies) {
+    for (size_t offset = 0; offset < copy.bytes; offset += kMaxCopyChunkBytes) {
+      SampleCopy chunk = { static_cast<char *>(copy.dst) + offset,
+                           static_cast<const char *>(copy.src) + offset,
+                           std::min(kMaxCopyChunkBytes, copy.bytes - offset) };
+      thread_pool->AddWork([chunk](int) { CopyChunk(chunk); }, chunk.bytes);
+    }
+  }
+  thread_pool->RunAll();
+}
+
+}  // namespace dali
@@ -0,0 +1,59 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_PIPELINE_UTIL_BATCH_COPY_H_
+#define DALI_PIPELINE_UTIL_BATCH_COPY_H_
+
+#include <cstddef>
+#include <vector>
+#include "dali/core/api_helper.h"
+
+namespace dali {
+
+class ThreadPool;
+
+struct SampleCopy {
+  void *dst;
+  const void *src;
+  size_t bytes;
+};
+
+// Copies of at least that many bytes bypass the CPU caches
+constexpr size_t kStreamingCopyBytes = 1 << 20;
+// Smaller batches are copied on the calling thread
+constexpr size_t kMinParallelCopyBytes = 256 << 10;
+// Bigger copies are split between the threads
+constexpr size_t kMaxCopyChunkBytes = 4 << 20;
+
+/**
+ * @brief Copies `bytes` bytes between host buffers with non-temporal stores, which don't
+ *        pull the destination into the caches. Falls back to memcpy without SSE2.
+ */
+DLL_PUBLIC void StreamingCopy(void *dst, const void *src, size_t bytes);
+
+/**
+ * @brief Copies the samples of a batch between host buffers, e.g. gathers them
+ *        into a contiguous buffer.
+ *
+ * Copies adjacent both in the source and in the destination (e.g. of a batch which is
+ * already contiguous) are merged. With a thread pool, the copies are split into chunks
+ * of up to `kMaxCopyChunkBytes` and run on its threads, the biggest first; the function
+ * returns when they are complete. Small batches, or all of them without a thread pool,
+ * are copied on the calling thread.
+ */
+DLL_PUBLIC void CopySamples(std::vector<SampleCopy> copies, ThreadPool *thread_pool);
+
+}  // namespace dali
+
+#endif  // DALI_PIPELINE_UTIL_BATCH_COPY_H_
@@ -0,0 +1,78 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "dali/pipeline/util/batch_copy.h"
+#include "dali/pipeline/util/thread_pool.h"
+
+namespace dali {
+
+TEST(BatchCopyTest, StreamingCopy) {
+  std::vector<uint8_t> src(3 * kStreamingCopyBytes), dst(src.size() + 32);
+  for (size_t i = 0; i < src.size(); i++)
+    src[i] = i * 7 + i / 251;
+  // all the alignments of the destination, and the tails shorter than a block
+  for (size_t offset = 0; offset < 17; offset++) {
+    for (size_t bytes : { size_t(0), size_t(10), size_t(100), src.size() - 63 }) {
+      std::fill(dst.begin(), dst.end(), 0);
+      StreamingCopy(dst.data() + offset, src.data() + 1, bytes);
+      for (size_t i = 0; i < bytes; i++)
+        ASSERT_EQ(dst[offset + i], src[i + 1]) << "offset " << offset << " bytes " << bytes;
+      EXPECT_EQ(dst[offset + bytes], 0);
+      if (offset > 0) {
+        EXPECT_EQ(dst[offset - 1], 0);
+      }
+    }
+  }
+}
+
+TEST(BatchCopyTest, GatherSamples) {
+  ThreadPool pool(4, -1, false);
+  // small samples, a contiguous run and samples split into chunks
+  std::vector<size_t> sizes = { 3, 1000, 64 << 10, 64 << 10, kStreamingCopyBytes + 5,
+                                2 * kMaxCopyChunkBytes + 17, 0, 1 };
+  size_t total = 0;
+  for (auto size : sizes)
+    total += size;
+  std::vector<uint8_t> src(total);
+  for (size_t i = 0; i < total; i++)
+    src[i] = i % 253;
+
+  for (ThreadPool *thread_pool : { static_cast<ThreadPool *>(nullptr), &pool }) {
+    // the samples in the source are reversed, except for the two in the middle
+    std::vector<uint8_t> dst(total, 0);
+    std::vector<SampleCopy> copies;
+    size_t src_offset = total, dst_offset = 0;
+    for (size_t i = 0; i < sizes.size(); i++) {
+      src_offset -= sizes[i];
+      copies.push_back({ dst.data() + dst_offset, src.data() + src_offset, sizes[i] });
+      dst_offset += sizes[i];
+    }
+    std::swap(copies[2].src, copies[3].src);
+    CopySamples(copies, thread_pool);
+    for (auto &copy : copies) {
+      auto *out = static_cast<const uint8_t *>(copy.dst);
+      auto *in = static_cast<const uint8_t *>(copy.src);
+      for (size_t i = 0; i < copy.bytes; i++)
+        ASSERT_EQ(out[i], in[i]);
+    }
+  }
+}
+
+}  // namespace dali
@@ -0,0 +1,122 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_PIPELINE_UTIL_STATE_IO_H_
+#define DALI_PIPELINE_UTIL_STATE_IO_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "dali/core/error_handling.h"
+
+namespace dali {
+
+/**
+ * @brief Appends the values making up the state of an object (e.g. a reader position)
+ *        to a binary blob, read back with StateReader.
+ *
+ * The values are stored as they are in memory, so the blob can only be read on a machine
+ * with the same endianness.
+ */
+class StateWriter {
+ public:
+  template <typename T>
+  void Write(const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable values can be written directly");
+    data_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void Write(const std::string &str) {
+    Write<uint64_t>(str.size());
+    data_.append(str);
+  }
+
+  template <typename T>
+  void Write(const std::vector<T> &values) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only vectors of trivially copyable values can be written");
+    Write<uint64_t>(values.size());
+    data_.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+  }
+
+  const std::string &data() const {
+    return data_;
+  }
+
+  std::string &data() {
+    return data_;
+  }
+
+ private:
+  std::string data_;
+};
+
+/**
+ * @brief Reads back the values written with StateWriter, in the same order.
+ *
+ * Throws if the blob is too short, i.e. it is truncated or wasn't written by a matching
+ * StateWriter.
+ */
+class StateReader {
+ public:
+  explicit StateReader(const std::string &data) : data_(data) {}
+
+  template <typename T>
+  T Read() {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable values can be read directly");
+    T value;
+    std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string ReadString() {
+    uint64_t size = Read<uint64_t>();
+    return std::string(Take(size), size);
+  }
+
+  template <typename T>
+  std::vector<T> ReadVector() {
+    uint64_t size = Read<uint64_t>();
+    DALI_ENFORCE(size <= (data_.size() - pos_) / sizeof(T), "The state data is corrupted");
+    std::vector<T> values(size);
+    const char *src = Take(size * sizeof(T));
+    if (size > 0)
+      std::memcpy(values.data(), src, size * sizeof(T));
+    return values;
+  }
+
+  bool AtEnd() const {
+    return pos_ == data_.size();
+  }
+
+ private:
+  const char *Take(size_t bytes) {
+    DALI_ENFORCE(bytes <= data_.size() - pos_, "The state data is truncated or corrupted");
+    const char *ptr = data_.data() + pos_;
+    pos_ += bytes;
+    return ptr;
+  }
+
+  const std::string &data_;
+  size_t pos_ = 0;
+};
+
+}  // namespace dali
+
+#endif  // DALI_PIPELINE_UTIL_STATE_IO_H_
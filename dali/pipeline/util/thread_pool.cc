@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdlib>
+#include <utility>
 
 #include "dali/pipeline/util/thread_pool.h"
 #if NVML_ENABLED
@@ -20,27 +22,34 @@
 #endif
 #include "dali/core/cuda_utils.h"
 #include "dali/core/device_guard.h"
+#include "dali/core/numa.h"
+#include "dali/core/tracer.h"
 
 namespace dali {
 
 ThreadPool::ThreadPool(int num_thread, int device_id, bool set_affinity)
-    : threads_(num_thread), running_(true), work_complete_(true), active_threads_(0) {
+    : threads_(num_thread), running_(true) {
   DALI_ENFORCE(num_thread > 0, "Thread pool must have non-zero size");
 #if NVML_ENABLED
-  nvml::Init();
+  // CPU-only pipelines may run on hosts without the driver
+  use_nvml_ = device_id != CPU_ONLY_DEVICE_ID;
+  if (use_nvml_)
+    nvml::Init();
 #endif
+  for (int i = 0; i < num_thread; ++i) {
+    queues_.emplace_back(new WorkQueue());
+  }
   // Start the threads in the main loop
   for (int i = 0; i < num_thread; ++i) {
     threads_[i] = std::thread(std::bind(&ThreadPool::ThreadMain, this, i, device_id, set_affinity));
   }
-  tl_errors_.resize(num_thread);
 }
 
 ThreadPool::~ThreadPool() {
-  // Wait for work to find errors
-  WaitForWork(false);
-
+  // Wait for the work of all the threads to finish
   std::unique_lock<std::mutex> lock(mutex_);
+  completed_.wait(lock, [this] { return outstanding_work_ == 0; });
+
   running_ = false;
   condition_.notify_all();
   lock.unlock();
@@ -49,37 +58,186 @@ ThreadPool::~ThreadPool() {
     thread.join();
   }
 #if NVML_ENABLED
-  nvml::Shutdown();
+  if (use_nvml_)
+    nvml::Shutdown();
 #endif
 }
 
+ThreadPool::WorkGroup &ThreadPool::CurrentGroup() {
+  std::lock_guard<std::mutex> lock(groups_mutex_);
+  auto &group = groups_[std::this_thread::get_id()];
+  if (!group) {
+    group.reset(new WorkGroup());
+  }
+  return *group;
+}
+
 void ThreadPool::DoWorkWithID(Work work) {
+  auto &group = CurrentGroup();
+  ++group.outstanding;
+  ++outstanding_work_;
+  auto &queue = *queues_[next_queue_++ % queues_.size()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back({std::move(work), &group});
+  }
+  NotifyQueued(1);
+}
+
+void ThreadPool::AddWork(Work work, int64_t priority) {
+  // only the calling thread touches its pending work
+  CurrentGroup().pending.emplace_back(priority, std::move(work));
+}
+
+void ThreadPool::RunAll(bool wait) {
+  auto &group = CurrentGroup();
+  vector<std::pair<int64_t, Work>> pending;
+  pending.swap(group.pending);
+  if (!pending.empty()) {
+    std::stable_sort(pending.begin(), pending.end(),
+                     [](const std::pair<int64_t, Work> &a, const std::pair<int64_t, Work> &b) {
+                       return a.first > b.first;
+                     });
+    group.outstanding += pending.size();
+    outstanding_work_ += pending.size();
+    // Deal the work to the queues like cards, every worker starts with its most expensive
+    // work and the cheapest work is at the back, where the idle workers steal from
+    int num_queues = queues_.size();
+    unsigned first_queue = next_queue_.fetch_add(pending.size());
+    for (int q = 0; q < num_queues && q < static_cast<int>(pending.size()); q++) {
+      auto &queue = *queues_[(first_queue + q) % num_queues];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      for (size_t i = q; i < pending.size(); i += num_queues) {
+        queue.tasks.push_back({std::move(pending[i].second), &group});
+      }
+    }
+    NotifyQueued(pending.size());
+  }
+  if (wait) {
+    WaitForGroup();
+  }
+}
+
+void ThreadPool::NotifyQueued(int64_t num_work) {
+  queued_work_ += num_work;
+  // Taking the lock guarantees that a thread going to sleep either sees
+  // the new work or is already waiting for the notification
+  { std::lock_guard<std::mutex> lock(mutex_); }
+  if (num_work == 1) {
+    condition_.notify_one();
+  } else {
+    condition_.notify_all();
+  }
+}
+
+bool ThreadPool::GetWork(int thread_id, Task &task) {
+  if (queued_work_ == 0) {
+    return false;
+  }
+  int num_queues = queues_.size();
+  // Own queue first, most expensive work first
+  {
+    auto &queue = *queues_[thread_id];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      --queued_work_;
+      return true;
+    }
+  }
+  // Steal the cheapest work of the others
+  for (int i = 1; i < num_queues; i++) {
+    auto &queue = *queues_[(thread_id + i) % num_queues];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      --queued_work_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::WaitForGroup() {
+  auto &group = CurrentGroup();
+  std::unique_lock<std::mutex> lock(mutex_);
+  completed_.wait(lock, [&group] { return group.outstanding == 0; });
+  lock.unlock();
+
+  // The group is drained, drop it, so the groups of the threads that are gone don't pile
+  // up and a thread that gets the same id doesn't inherit the errors
+  std::unique_ptr<WorkGroup> drained;
   {
-    // Add work to the queue
-    std::lock_guard<std::mutex> lock(mutex_);
-    work_queue_.push(work);
-    work_complete_ = false;
+    std::lock_guard<std::mutex> groups_lock(groups_mutex_);
+    auto it = groups_.find(std::this_thread::get_id());
+    drained = std::move(it->second);
+    groups_.erase(it);
   }
-  // Signal a thread to complete the work
-  condition_.notify_one();
+
+  vector<std::pair<int, string>> errors;
+  TakeErrors(thread_errors_, errors);
+  TakeErrors(*drained, errors);
+  ThrowErrors(errors);
 }
 
 // Blocks until all work issued to the thread pool is complete
 void ThreadPool::WaitForWork(bool checkForErrors) {
+  RunAll(false);
   std::unique_lock<std::mutex> lock(mutex_);
-  completed_.wait(lock, [this] { return this->work_complete_; });
-
-  if (checkForErrors) {
-    // Check for errors
-    for (size_t i = 0; i < threads_.size(); ++i) {
-      if (!tl_errors_[i].empty()) {
-        // Throw the first error that occured
-        string error = "Error in thread " + std::to_string(i) + ": " + tl_errors_[i].front();
-        tl_errors_[i].pop();
-        throw std::runtime_error(error);
-      }
+  completed_.wait(lock, [this] { return outstanding_work_ == 0; });
+  lock.unlock();
+
+  if (!checkForErrors) {
+    return;
+  }
+  vector<std::pair<int, string>> errors;
+  TakeErrors(thread_errors_, errors);
+  {
+    // Only the owner drops its group, the other threads may be about to submit more work
+    std::lock_guard<std::mutex> groups_lock(groups_mutex_);
+    for (auto &entry : groups_) {
+      TakeErrors(*entry.second, errors);
+    }
+    auto it = groups_.find(std::this_thread::get_id());
+    if (it != groups_.end() && it->second->outstanding == 0) {
+      groups_.erase(it);
     }
   }
+  ThrowErrors(errors);
+}
+
+void ThreadPool::AddError(WorkGroup &group, int thread_id, string error) {
+  std::lock_guard<std::mutex> lock(group.errors_mutex);
+  group.errors.emplace_back(thread_id, std::move(error));
+  group.has_errors = true;
+}
+
+void ThreadPool::TakeErrors(WorkGroup &group, vector<std::pair<int, string>> &errors) {
+  if (!group.has_errors) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(group.errors_mutex);
+  for (auto &error : group.errors) {
+    errors.push_back(std::move(error));
+  }
+  group.errors.clear();
+  group.has_errors = false;
+}
+
+void ThreadPool::ThrowErrors(const vector<std::pair<int, string>> &errors) {
+  if (errors.empty()) {
+    return;
+  }
+  // The first error that occured, followed by the others, so none of them is lost
+  string message;
+  for (auto &error : errors) {
+    if (!message.empty())
+      message += "\n";
+    message += "Error in thread " + std::to_string(error.first) + ": " + error.second;
+  }
+  throw std::runtime_error(message);
 }
 
 int ThreadPool::size() const {
@@ -88,72 +246,73 @@ int ThreadPool::size() const {
 
 void ThreadPool::ThreadMain(int thread_id, int device_id, bool set_affinity) {
   DeviceGuard g(device_id);
+  Tracer::SetThreadName("ThreadPool worker " + to_string(thread_id));
   try {
-#if NVML_ENABLED
     if (set_affinity) {
       const char *env_affinity = std::getenv("DALI_AFFINITY_MASK");
-      int core = -1;
-      if (env_affinity) {
-        const auto &vec = string_split(env_affinity, ',');
-        if ((size_t)thread_id < vec.size()) {
-          core = std::stoi(vec[thread_id]);
-        } else {
-          DALI_WARN("DALI_AFFINITY_MASK environment variable is set, " +
-                    "but does not have enough entries: " + "thread_id (" + to_string(thread_id) +
-                    ") vs #entries (" + to_string(vec.size()) + "). Ignoring...");
+      int numa_node = env_affinity ? -1 : numa::AffinityNode(device_id);
+      if (numa_node >= 0) {
+        // Keep the workers, and the memory they allocate, on the NUMA node of the GPU
+        // (or the one chosen with DALI_NUMA_NODE)
+        numa::BindCurrentThread(numa_node);
+      } else if (use_nvml_) {
+#if NVML_ENABLED
+        int core = -1;
+        if (env_affinity) {
+          const auto &vec = string_split(env_affinity, ',');
+          if ((size_t)thread_id < vec.size()) {
+            core = std::stoi(vec[thread_id]);
+          } else {
+            DALI_WARN("DALI_AFFINITY_MASK environment variable is set, " +
+                      "but does not have enough entries: " + "thread_id (" +
+                      to_string(thread_id) + ") vs #entries (" + to_string(vec.size()) +
+                      "). Ignoring...");
+          }
         }
+        nvml::SetCPUAffinity(core);
+#endif
       }
-      nvml::SetCPUAffinity(core);
     }
-#endif
   } catch (std::exception &e) {
-    tl_errors_[thread_id].push(e.what());
+    AddError(thread_errors_, thread_id, e.what());
   } catch (...) {
-    tl_errors_[thread_id].push("Caught unknown exception");
+    AddError(thread_errors_, thread_id, "Caught unknown exception");
   }
 
-  while (running_) {
-    // Block on the condition to wait for work
-    std::unique_lock<std::mutex> lock(mutex_);
-    condition_.wait(lock, [this] { return !(running_ && work_queue_.empty()); });
-    // If we're no longer running, exit the run loop
-    if (!running_) break;
-
-    // Get work from the queue & mark
-    // this thread as active
-    Work work = work_queue_.front();
-    work_queue_.pop();
-    bool should_wake_next = !work_queue_.empty();
-    ++active_threads_;
-
-    // Unlock the lock
-    lock.unlock();
-
-    if (should_wake_next) {
-      condition_.notify_one();
+  while (true) {
+    Task task;
+    if (!GetWork(thread_id, task)) {
+      // Block on the condition to wait for work
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this] { return !running_ || queued_work_ > 0; });
+      // If we're no longer running, exit the run loop
+      if (!running_) break;
+      continue;
     }
 
-    // If an error occurs, we save it in tl_errors_. When
-    // WaitForWork is called, we will check for any errors
-    // in the threads and return an error if one occured.
+    // If an error occurs, we save it in the group of the work. When
+    // WaitForWork is called by the thread that submitted it, we will
+    // return an error if one occured.
+    int64_t trace_begin = Tracer::IsEnabled() ? Tracer::Now() : -1;
     try {
-      work(thread_id);
+      task.work(thread_id);
     } catch (std::exception &e) {
-      lock.lock();
-      tl_errors_[thread_id].push(e.what());
-      lock.unlock();
+      AddError(*task.group, thread_id, e.what());
     } catch (...) {
-      lock.lock();
-      tl_errors_[thread_id].push("Caught unknown exception");
-      lock.unlock();
+      AddError(*task.group, thread_id, "Caught unknown exception");
+    }
+    if (trace_begin >= 0) {
+      static const char kWorkName[] = "ThreadPool work";
+      Tracer::Record(kWorkName, sizeof(kWorkName) - 1, trace_begin, Tracer::Now());
     }
+    // Release whatever the work captured before reporting it as done
+    task.work = nullptr;
 
-    // Mark this thread as idle & check for complete work
-    lock.lock();
-    --active_threads_;
-    if (work_queue_.empty() && active_threads_ == 0) {
-      work_complete_ = true;
-      completed_.notify_one();
+    bool group_done = --task.group->outstanding == 0;
+    bool all_done = --outstanding_work_ == 0;
+    if (group_done || all_done) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      completed_.notify_all();
     }
   }
 }
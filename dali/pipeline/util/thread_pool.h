@@ -15,12 +15,16 @@
 #ifndef DALI_PIPELINE_UTIL_THREAD_POOL_H_
 #define DALI_PIPELINE_UTIL_THREAD_POOL_H_
 
+#include <atomic>
 #include <cstdlib>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <string>
 #include "dali/core/common.h"
@@ -28,6 +32,23 @@
 
 namespace dali {
 
+/**
+ * @brief Work-stealing thread pool.
+ *
+ * Every worker has its own queue of work. The workers take the work from their own
+ * queues first and steal from the others when theirs are empty, so submitting and
+ * picking up work doesn't serialize all the threads on a single lock.
+ *
+ * The work can be submitted one by one with DoWorkWithID, or in bulk: the work added
+ * with AddWork is held back until RunAll, which orders it by priority (e.g. the size
+ * of the sample) and spreads it between the workers in a single pass, so the most
+ * expensive work starts first and the cheap work fills the gaps at the end.
+ *
+ * The work is accounted for per submitting thread: RunAll waits only for the work issued
+ * by the calling thread and reports only its errors, so several threads (e.g. operators
+ * running concurrently) can share the pool. WaitForWork waits for all the work in the pool,
+ * also when it was issued by another thread.
+ */
 class DLL_PUBLIC ThreadPool {
  public:
   // Basic unit of work that our threads do
@@ -35,11 +56,42 @@ class DLL_PUBLIC ThreadPool {
 
   DLL_PUBLIC ThreadPool(int num_thread, int device_id, bool set_affinity);
 
+  /**
+   * @brief Waits for the work that was issued. The work added with AddWork and never
+   *        started is dropped, and the errors are not reported.
+   */
   DLL_PUBLIC ~ThreadPool();
 
+  /**
+   * @brief Starts the work immediately.
+   *
+   * The work goes to the queues of the workers in turns and idle workers steal it, so,
+   * unlike with a single queue, the work is not guaranteed to start in the order it was
+   * issued. Use AddWork and RunAll when the order matters.
+   */
   DLL_PUBLIC void DoWorkWithID(Work work);
 
-  // Blocks until all work issued to the thread pool is complete
+  /**
+   * @brief Adds the work to be started by RunAll or WaitForWork.
+   *        The work with higher priority is started first.
+   */
+  DLL_PUBLIC void AddWork(Work work, int64_t priority = 0);
+
+  /**
+   * @brief Starts all the work added with AddWork and optionally waits for all the work
+   *        issued by the calling thread to complete, reporting only its errors.
+   *        Use it when other threads share the pool.
+   */
+  DLL_PUBLIC void RunAll(bool wait = true);
+
+  /**
+   * @brief Starts the work added with AddWork by the calling thread and blocks until all
+   *        work issued to the thread pool, by any thread, is complete. The errors of all
+   *        that work are reported, in a single exception.
+   *
+   * The work added with AddWork by other threads is not started: it waits for their
+   * RunAll or WaitForWork.
+   */
   DLL_PUBLIC void WaitForWork(bool checkForErrors = true);
 
   DLL_PUBLIC int size() const;
@@ -47,20 +99,72 @@ class DLL_PUBLIC ThreadPool {
   DISABLE_COPY_MOVE_ASSIGN(ThreadPool);
 
  private:
+  // Work submitted by a single thread
+  struct WorkGroup {
+    // work added with AddWork, waiting for RunAll
+    vector<std::pair<int64_t, Work>> pending;
+    // work issued and not completed yet
+    std::atomic<int64_t> outstanding{0};
+    // Stored error strings, with the id of the thread
+    std::atomic<bool> has_errors{false};
+    std::mutex errors_mutex;
+    vector<std::pair<int, string>> errors;
+  };
+
+  struct Task {
+    Work work;
+    WorkGroup *group;
+  };
+
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
   DLL_PUBLIC void ThreadMain(int thread_id, int device_id, bool set_affinity);
 
+  // Returns the group of the work submitted by the calling thread
+  WorkGroup &CurrentGroup();
+
+  // Takes work from the queue of `thread_id` or steals it from the other queues
+  bool GetWork(int thread_id, Task &task);
+
+  // Called after the work was put in the queues
+  void NotifyQueued(int64_t num_work);
+
+  // Waits for the work of the calling thread and drops its group
+  void WaitForGroup();
+
+  static void AddError(WorkGroup &group, int thread_id, string error);
+
+  // Moves the errors of the group to `errors`
+  static void TakeErrors(WorkGroup &group, vector<std::pair<int, string>> &errors);
+
+  // Throws all the errors in one exception, if there are any
+  static void ThrowErrors(const vector<std::pair<int, string>> &errors);
+
   vector<std::thread> threads_;
-  std::queue<Work> work_queue_;
+  vector<std::unique_ptr<WorkQueue>> queues_;
+  // queue that gets the next work submitted with DoWorkWithID
+  std::atomic<unsigned> next_queue_{0};
+
+  std::mutex groups_mutex_;
+  // groups of the threads with work in flight, dropped by their owners once drained
+  std::unordered_map<std::thread::id, std::unique_ptr<WorkGroup>> groups_;
+  // errors that don't belong to any work, e.g. failing to set the affinity of a thread
+  WorkGroup thread_errors_;
+
+  // work in the queues, not picked up yet
+  std::atomic<int64_t> queued_work_{0};
+  // work issued and not completed yet, by all the threads
+  std::atomic<int64_t> outstanding_work_{0};
 
   bool running_;
-  bool work_complete_;
-  int active_threads_;
+  // NVML sets the affinity of the threads; it's not used by the CPU-only pipelines
+  bool use_nvml_ = false;
   std::mutex mutex_;
   std::condition_variable condition_;
   std::condition_variable completed_;
-
-  //  Stored error strings for each thread
-  vector<std::queue<string>> tl_errors_;
 };
 
 }  // namespace dali
@@ -0,0 +1,182 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dali/pipeline/util/thread_pool.h"
+
+namespace dali {
+
+TEST(ThreadPoolTest, DoWorkWithID) {
+  ThreadPool pool(4, -1, false);
+  std::atomic<int> count{0};
+  std::atomic<bool> bad_id{false};
+  for (int i = 0; i < 1000; i++) {
+    pool.DoWorkWithID([&](int tid) {
+      if (tid < 0 || tid >= 4)
+        bad_id = true;
+      ++count;
+    });
+  }
+  pool.WaitForWork();
+  EXPECT_EQ(count, 1000);
+  EXPECT_FALSE(bad_id);
+}
+
+TEST(ThreadPoolTest, RunAllByPriority) {
+  // with a single worker the order of the work is the order of the priorities
+  ThreadPool pool(1, -1, false);
+  std::vector<int> order;
+  for (int priority : {3, 10, 1, 7, 7, 5}) {
+    pool.AddWork([&order, priority](int) { order.push_back(priority); }, priority);
+  }
+  EXPECT_TRUE(order.empty());
+  pool.RunAll();
+  EXPECT_EQ(order, std::vector<int>({10, 7, 7, 5, 3, 1}));
+}
+
+TEST(ThreadPoolTest, WaitForWorkRunsAddedWork) {
+  ThreadPool pool(3, -1, false);
+  std::atomic<int> count{0};
+  for (int i = 0; i < 100; i++) {
+    pool.AddWork([&](int) { ++count; }, i);
+    pool.DoWorkWithID([&](int) { ++count; });
+  }
+  pool.WaitForWork();
+  EXPECT_EQ(count, 200);
+}
+
+TEST(ThreadPoolTest, Errors) {
+  ThreadPool pool(2, -1, false);
+  std::atomic<int> count{0};
+  for (int i = 0; i < 10; i++) {
+    pool.AddWork([&, i](int) {
+      ++count;
+      if (i == 5)
+        throw std::runtime_error("work failed");
+    });
+  }
+  EXPECT_THROW(pool.RunAll(), std::runtime_error);
+  // the other work still completes and the pool stays usable
+  EXPECT_EQ(count, 10);
+  pool.DoWorkWithID([&](int) { ++count; });
+  EXPECT_NO_THROW(pool.WaitForWork());
+  EXPECT_EQ(count, 11);
+}
+
+TEST(ThreadPoolTest, ErrorsReportedOnce) {
+  ThreadPool pool(2, -1, false);
+  for (int i = 0; i < 10; i++) {
+    pool.AddWork([](int) {
+      throw std::runtime_error("work failed");
+    });
+  }
+  EXPECT_THROW(pool.RunAll(), std::runtime_error);
+  // the remaining errors of the failed batch are not reported with the next one
+  pool.DoWorkWithID([](int) {});
+  EXPECT_NO_THROW(pool.WaitForWork());
+}
+
+TEST(ThreadPoolTest, AllErrorsReported) {
+  ThreadPool pool(2, -1, false);
+  for (int i = 0; i < 2; i++) {
+    pool.AddWork([i](int) {
+      throw std::runtime_error("work " + std::to_string(i) + " failed");
+    });
+  }
+  try {
+    pool.RunAll();
+    FAIL() << "Expected an error";
+  } catch (const std::runtime_error &e) {
+    std::string message = e.what();
+    EXPECT_NE(message.find("work 0 failed"), std::string::npos);
+    EXPECT_NE(message.find("work 1 failed"), std::string::npos);
+  }
+}
+
+TEST(ThreadPoolTest, WaitForWorkOfOtherThread) {
+  // WaitForWork waits also for the work issued by another thread, and reports its errors
+  ThreadPool pool(2, -1, false);
+  std::atomic<bool> release{false};
+  std::atomic<bool> done{false};
+  std::thread other([&] {
+    pool.DoWorkWithID([&](int) {
+      while (!release) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      done = true;
+      throw std::runtime_error("other thread's work failed");
+    });
+  });
+  other.join();
+  std::thread releaser([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    release = true;
+  });
+  EXPECT_THROW(pool.WaitForWork(), std::runtime_error);
+  EXPECT_TRUE(done);
+  releaser.join();
+  EXPECT_NO_THROW(pool.WaitForWork());
+}
+
+TEST(ThreadPoolTest, Stealing) {
+  // The work is dealt to the workers in the order of priority, so the queue of the
+  // slow work holds also the 5th piece of work, which has to be stolen by the others
+  ThreadPool pool(4, -1, false);
+  std::atomic<int> completed{0};
+  int completed_before_slow = -1;
+  pool.AddWork([&](int) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    completed_before_slow = completed;
+  }, 100);
+  for (int i = 0; i < 7; i++) {
+    pool.AddWork([&](int) { ++completed; }, 10 - i);
+  }
+  pool.RunAll();
+  EXPECT_EQ(completed_before_slow, 7);
+}
+
+TEST(ThreadPoolTest, SeparateSubmitters) {
+  // Every thread waits only for its own work and gets only its own errors
+  ThreadPool pool(2, -1, false);
+  std::atomic<bool> release{false};
+  std::atomic<int> count{0};
+  pool.AddWork([&](int) {
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    throw std::runtime_error("slow work failed");
+  });
+  pool.RunAll(false);
+
+  std::thread other([&] {
+    for (int i = 0; i < 10; i++) {
+      pool.AddWork([&](int) { ++count; });
+    }
+    EXPECT_NO_THROW(pool.RunAll());
+    EXPECT_EQ(count, 10);
+    release = true;
+  });
+  other.join();
+  EXPECT_THROW(pool.WaitForWork(), std::runtime_error);
+}
+
+}  // namespace dali
@@ -25,6 +25,7 @@
 
 #include "dali/core/common.h"
 #include "dali/core/error_handling.h"
+#include "dali/core/numa.h"
 #if NVML_ENABLED
 #include "dali/util/nvml.h"
 #endif
@@ -62,18 +63,25 @@ class WorkerThread {
  public:
   typedef std::function<void(void)> Work;
 
-  inline WorkerThread(int device_id, bool set_affinity) :
+  /**
+   * @param name shown for the events of the thread in the trace of the execution
+   */
+  inline WorkerThread(int device_id, bool set_affinity, const std::string &name = "") :
     running_(true), work_complete_(true), barrier_(2) {
 #if NVML_ENABLED
-    nvml::Init();
+    // CPU-only pipelines may run on hosts without the driver
+    use_nvml_ = device_id != CPU_ONLY_DEVICE_ID;
+    if (use_nvml_)
+      nvml::Init();
 #endif
     thread_ = std::thread(&WorkerThread::ThreadMain,
-        this, device_id, set_affinity);
+        this, device_id, set_affinity, name);
   }
 
   inline ~WorkerThread() {
 #if NVML_ENABLED
-    nvml::Shutdown();
+    if (use_nvml_)
+      nvml::Shutdown();
 #endif
   }
 
@@ -149,13 +157,20 @@ class WorkerThread {
   }
 
  private:
-  void ThreadMain(int device_id, bool set_affinity) {
+  void ThreadMain(int device_id, bool set_affinity, const std::string &name) {
     DeviceGuard g(device_id);
+    if (!name.empty())
+      Tracer::SetThreadName(name);
     try {
       if (set_affinity) {
+        int numa_node = numa::AffinityNode(device_id);
+        if (numa_node >= 0) {
+          numa::BindCurrentThread(numa_node);
+        } else if (use_nvml_) {
 #if NVML_ENABLED
-        nvml::SetCPUAffinity();
+          nvml::SetCPUAffinity();
 #endif
+        }
       }
     } catch (std::exception &e) {
       errors_.push(e.what());
@@ -218,6 +233,7 @@ class WorkerThread {
   std::queue<string> errors_;
 
   Barrier barrier_;
+  bool use_nvml_ = false;
 };
 
 }  // namespace dali
@@ -56,7 +56,7 @@ int HostWorkspace::NumOutputAtIdx(int idx) const {
   DALI_ENFORCE_VALID_INDEX(idx, output_index_map_.size());
   auto tensor_meta = output_index_map_[idx];
   if (tensor_meta.storage_device == StorageDevice::CPU) {
-    return cpu_inputs_[tensor_meta.index]->size();
+    return cpu_outputs_[tensor_meta.index]->size();
   }
   return gpu_outputs_[tensor_meta.index]->size();
 }
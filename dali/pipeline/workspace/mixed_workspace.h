@@ -25,6 +25,7 @@
 #include "dali/pipeline/data/tensor.h"
 #include "dali/pipeline/data/tensor_list.h"
 #include "dali/pipeline/data/tensor_vector.h"
+#include "dali/pipeline/util/thread_pool.h"
 #include "dali/pipeline/workspace/workspace.h"
 
 namespace dali {
@@ -109,6 +110,23 @@ class DLL_PUBLIC MixedWorkspace : public WorkspaceBase<MixedInputType, MixedOutp
     return event_;
   }
 
+  /**
+   * @brief Sets the thread pool of the CPU stage, which the mixed operators may use
+   * for their host-side work, e.g. gathering the samples into a contiguous buffer.
+   */
+  DLL_PUBLIC inline void SetThreadPool(ThreadPool *pool) {
+    thread_pool_ = pool;
+  }
+
+  DLL_PUBLIC inline bool HasThreadPool() const {
+    return thread_pool_ != nullptr;
+  }
+
+  DLL_PUBLIC inline ThreadPool &GetThreadPool() const {
+    DALI_ENFORCE(HasThreadPool(), "Workspace does not have a Thread Pool.");
+    return *thread_pool_;
+  }
+
  private:
   cudaStream_t stream_impl() const override {
     return stream_;
@@ -117,6 +135,7 @@ class DLL_PUBLIC MixedWorkspace : public WorkspaceBase<MixedInputType, MixedOutp
   bool has_stream_ = false, has_event_ = false;
   cudaStream_t stream_;
   cudaEvent_t event_;
+  ThreadPool* thread_pool_ = nullptr;
 };
 
 }  // namespace dali
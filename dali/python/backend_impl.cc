@@ -23,10 +23,12 @@
 #include "dali/python/python3_compat.h"
 #include "dali/util/user_stream.h"
 #include "dali/operators/reader/parser/tfrecord_parser.h"
+#include "dali/operators/reader/loader/sample_cache.h"
 #include "dali/plugin/copy.h"
 #include "dali/plugin/plugin_manager.h"
 #include "dali/util/half.hpp"
 #include "dali/core/device_guard.h"
+#include "dali/core/host_pool.h"
 #include "dali/core/python_util.h"
 #include "dali/operators/operators.h"
 
@@ -766,6 +768,20 @@ PYBIND11_MODULE(backend_impl, m) {
         [](Pipeline *p, const string &filename) {
           p->SaveGraphToDotFile(filename);
         })
+    .def("EnableTracing", &Pipeline::EnableTracing,
+        "filename"_a = "",
+        "dump_every_n_iterations"_a = 0)
+    .def("DisableTracing", &Pipeline::DisableTracing)
+    .def("DumpTrace", &Pipeline::DumpTrace)
+    .def("EnableCheckpointing", &Pipeline::EnableCheckpointing)
+    .def("GetCheckpoint",
+        [](Pipeline *p) -> py::bytes {
+          return p->GetCheckpoint();
+        })
+    .def("RestoreFromCheckpoint",
+        [](Pipeline *p, const py::bytes &checkpoint) {
+          p->RestoreFromCheckpoint(checkpoint);
+        })
     .def("epoch_size", &Pipeline::EpochSize)
     .def("epoch_size",
         [](Pipeline* p, const std::string& op_name) {
@@ -773,6 +789,43 @@ PYBIND11_MODULE(backend_impl, m) {
           DALI_ENFORCE(sizes.find(op_name) != sizes.end(),
               "Operator " + op_name + " does not expose valid epoch size.");
           return sizes[op_name];
+        })
+    .def("executor_statistics",
+        [](Pipeline *p) {
+          ExecutorStats stats = p->GetExecutorStatistics();
+          py::dict operators;
+          for (const auto &op : stats.operators) {
+            const OperatorStats &op_stats = op.second;
+            py::dict op_dict;
+            op_dict["device"] = to_string(op_stats.op_type);
+            op_dict["iterations"] = op_stats.iterations;
+            op_dict["total_time_ns"] = op_stats.total_time_ns;
+            op_dict["max_time_ns"] = op_stats.max_time_ns;
+            op_dict["wait_time_ns"] = op_stats.wait_time_ns;
+            op_dict["bytes_produced"] = op_stats.bytes_produced;
+            op_dict["samples"] = op_stats.samples;
+            op_dict["total_sample_time_ns"] = op_stats.total_sample_time_ns;
+            op_dict["sample_latency_histogram"] = std::vector<int64_t>(
+                op_stats.sample_latency_histogram.begin(), op_stats.sample_latency_histogram.end());
+            operators[py::str(op.first)] = op_dict;
+          }
+          py::dict stages;
+          for (const auto &stage : stats.stages) {
+            py::dict stage_dict;
+            stage_dict["iterations"] = stage.second.iterations;
+            stage_dict["wait_time_ns"] = stage.second.wait_time_ns;
+            stage_dict["max_wait_time_ns"] = stage.second.max_wait_time_ns;
+            stages[py::str(to_string(stage.first))] = stage_dict;
+          }
+          py::dict memory;
+          memory["aliased_tensors"] = stats.memory.aliased_tensors;
+          memory["shared_buffers"] = stats.memory.shared_buffers;
+          memory["peak_bytes_saved"] = stats.memory.peak_bytes_saved;
+          py::dict ret;
+          ret["operators"] = operators;
+          ret["stages"] = stages;
+          ret["memory"] = memory;
+          return ret;
         });
 
 #define DALI_OPSPEC_ADDARG(T) \
@@ -831,6 +884,38 @@ PYBIND11_MODULE(backend_impl, m) {
   // Registry for OpSchema
   m.def("GetSchema", &GetSchema, py::return_value_policy::reference);
 
+  m.def("GetSampleCacheStats",
+        [](const std::string &name) {
+          auto stats = SampleCacheRegistry::Instance().GetStats(name);
+          py::dict d;
+          d["hits"] = stats.hits;
+          d["misses"] = stats.misses;
+          d["evictions"] = stats.evictions;
+          d["num_entries"] = stats.num_entries;
+          d["size_bytes"] = stats.size_bytes;
+          d["capacity_bytes"] = stats.capacity_bytes;
+          return d;
+        },
+        R"code(Returns the statistics of the reader sample cache called `name`.)code",
+        py::arg("name") = std::string());
+
+  m.def("GetHostPoolStats",
+        []() {
+          auto stats = HostMemoryPool::Instance().GetStats();
+          py::dict d;
+          d["enabled"] = HostMemoryPool::Instance().IsEnabled();
+          d["allocated_bytes"] = stats.allocated_bytes;
+          d["peak_allocated_bytes"] = stats.peak_allocated_bytes;
+          d["cached_bytes"] = stats.cached_bytes;
+          d["hits"] = stats.hits;
+          d["misses"] = stats.misses;
+          d["releases"] = stats.releases;
+          d["huge_page_blocks"] = stats.huge_page_blocks;
+          d["huge_page_fallbacks"] = stats.huge_page_fallbacks;
+          return d;
+        },
+        R"code(Returns the statistics of the host memory pool used by `PoolingCPUAllocator`.)code");
+
   py::class_<OpSchema>(m, "OpSchema")
     .def("Dox", &OpSchema::Dox)
     .def("MaxNumInput", &OpSchema::MaxNumInput)
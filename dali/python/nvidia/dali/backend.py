@@ -25,7 +25,9 @@ default_plugins = [
 
 initialized = False
 if not initialized:
-    Init(OpSpec("CPUAllocator"), OpSpec("PinnedCPUAllocator"), OpSpec("GPUAllocator"))
+    # DALI_CPU_ALLOCATOR=PoolingCPUAllocator reuses the host buffers instead of freeing them
+    Init(OpSpec(os.environ.get("DALI_CPU_ALLOCATOR", "CPUAllocator")),
+         OpSpec("PinnedCPUAllocator"), OpSpec("GPUAllocator"))
     initialized = True
 
     # pybind11 deprecations
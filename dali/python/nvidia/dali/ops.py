@@ -432,7 +432,9 @@ class TFRecordReader(with_metaclass(_DaliOperatorMeta, object)):
             self._path = path
         else:
             self._path = [path]
-        if isinstance(index_path, list):
+        if index_path is None:
+            self._index_path = []
+        elif isinstance(index_path, list):
             self._index_path = index_path
         else:
             self._index_path = [index_path]
@@ -441,7 +443,8 @@ class TFRecordReader(with_metaclass(_DaliOperatorMeta, object)):
         self._device = "cpu"
 
         self._spec.AddArg("path", self._path)
-        self._spec.AddArg("index_path", self._index_path)
+        if self._index_path:
+            self._spec.AddArg("index_path", self._index_path)
 
         for key, value in kwargs.items():
             self._spec.AddArg(key, value)
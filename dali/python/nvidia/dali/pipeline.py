@@ -81,11 +81,16 @@ class Pipeline(object):
         unrestricted number of streams is assumed).
     `default_cuda_stream_priority` : int, optional, default = 0
         CUDA stream priority used by DALI. See `cudaStreamCreateWithPriority` in CUDA documentation
+    `enable_checkpointing` : bool, optional, default = False
+        Whether the readers keep track of their positions, so that the pipeline can be saved
+        with :meth:`nvidia.dali.pipeline.Pipeline.checkpoint` and resumed with
+        :meth:`nvidia.dali.pipeline.Pipeline.restore_from_checkpoint`.
     """
     def __init__(self, batch_size = -1, num_threads = -1, device_id = -1, seed = -1,
                  exec_pipelined=True, prefetch_queue_depth=2,
                  exec_async=True, bytes_per_sample=0,
-                 set_affinity=False, max_streams=-1, default_cuda_stream_priority = 0):
+                 set_affinity=False, max_streams=-1, default_cuda_stream_priority = 0,
+                 enable_checkpointing=False):
         self._sinks = []
         self._batch_size = batch_size
         self._num_threads = num_threads
@@ -105,6 +110,7 @@ class Pipeline(object):
         self._set_affinity = set_affinity
         self._max_streams = max_streams
         self._default_cuda_stream_priority = default_cuda_stream_priority
+        self._enable_checkpointing = enable_checkpointing
         self._api_type = None
         self._skip_api_check = False
         if type(prefetch_queue_depth) is dict:
@@ -163,6 +169,30 @@ class Pipeline(object):
             return self._pipe.epoch_size(name)
         return self._pipe.epoch_size()
 
+    def executor_statistics(self):
+        """Run time statistics gathered by the executor since the pipeline was built.
+
+        Returns a dictionary with three entries:
+
+        * `operators` - for every operator (by its name) the number of runs (`iterations`),
+          their total and maximal wall time (`total_time_ns`, `max_time_ns`), the time spent
+          waiting for the data (`wait_time_ns`), the number of bytes of its outputs
+          (`bytes_produced`) and, for the operators processing the samples one by one,
+          the number of samples, their total time and a histogram of their latencies
+          (`sample_latency_histogram`, bucket `i` counts the samples that took
+          [2^(i-1), 2^i) microseconds).
+        * `stages` - for the `cpu`, `mixed` and `gpu` stages the time spent waiting for
+          free output buffers (`wait_time_ns`, `max_wait_time_ns`).
+        * `memory` - with ``DALI_CPU_MEMORY_PLANNING=1``, the number of the CPU intermediates
+          sharing their buffers (`aliased_tensors`), the number of these buffers
+          (`shared_buffers`) and the estimated peak bytes saved (`peak_bytes_saved`).
+
+        The times of the mixed and gpu operators cover only issuing the work from the host.
+        """
+        if not self._built:
+            raise RuntimeError("Pipeline must be built first.")
+        return self._pipe.executor_statistics()
+
     @staticmethod
     def current(raise_error_if_none = True):
         pipeline = getattr(pipeline_tls, 'current_pipeline', None)
@@ -237,6 +267,8 @@ class Pipeline(object):
                                 self._default_cuda_stream_priority)
         self._pipe.SetExecutionTypes(self._exec_pipelined, self._exec_separated, self._exec_async)
         self._pipe.SetQueueSizes(self._cpu_queue_size, self._gpu_queue_size)
+        if self._enable_checkpointing:
+            self._pipe.EnableCheckpointing()
         prev_pipeline = Pipeline.set_current(self)
         outputs = self.define_graph()
         Pipeline.set_current(prev_pipeline)
@@ -548,10 +580,44 @@ class Pipeline(object):
                                 self._default_cuda_stream_priority)
         self._pipe.SetExecutionTypes(self._exec_pipelined, self._exec_separated, self._exec_async)
         self._pipe.SetQueueSizes(self._cpu_queue_size, self._gpu_queue_size)
+        if self._enable_checkpointing:
+            self._pipe.EnableCheckpointing()
         self._prepared = True
         self._pipe.Build()
         self._built = True
 
+    def checkpoint(self):
+        """Returns the positions of all the readers after the iterations whose outputs
+        were returned so far, as bytes.
+
+        A pipeline created with the same definition and restored from the checkpoint
+        with :meth:`nvidia.dali.pipeline.Pipeline.restore_from_checkpoint` returns
+        the outputs of the next iterations. The pipeline has to be created with
+        `enable_checkpointing` set.
+        """
+        if not self._built:
+            raise RuntimeError("Pipeline must be built first.")
+        return self._pipe.GetCheckpoint()
+
+    def restore_from_checkpoint(self, checkpoint):
+        """Makes the readers resume from the positions returned by
+        :meth:`nvidia.dali.pipeline.Pipeline.checkpoint`.
+
+        The readers seek straight to the saved positions, without reading the samples
+        before them. Has to be called after the pipeline is built and before it is run.
+
+        Parameters
+        ----------
+        checkpoint : bytes
+                     Checkpoint returned by :meth:`nvidia.dali.pipeline.Pipeline.checkpoint`
+                     of the pipeline with the same definition.
+        """
+        if not self._built:
+            raise RuntimeError("Pipeline must be built first.")
+        if not self._first_iter:
+            raise RuntimeError("Pipeline can only be restored from a checkpoint before it is run.")
+        self._pipe.RestoreFromCheckpoint(checkpoint)
+
     def save_graph_to_dot_file(self, filename):
         """Saves the pipeline graph to a file.
 
@@ -564,6 +630,44 @@ class Pipeline(object):
             raise RuntimeError("Pipeline must be built first.")
         self._pipe.SaveGraphToDotFile(filename)
 
+    def enable_tracing(self, filename = None, every_n_iterations = 0):
+        """Starts recording the timeline of the execution: the stages of the executor,
+        the operators, the work of the thread pool workers and the reader prefetching.
+        The timeline can be viewed in chrome://tracing or in Perfetto.
+
+        The tracing is process-wide, so it covers also the other pipelines.
+        Every thread keeps only its most recent events.
+
+        Parameters
+        ----------
+        filename : str, optional, default = None
+                   Name of the file to which the trace is written periodically.
+        every_n_iterations : int, optional, default = 0
+                   If positive, the trace is written to `filename` every that many
+                   iterations, when the outputs are returned.
+        """
+        if not self._built:
+            raise RuntimeError("Pipeline must be built first.")
+        self._pipe.EnableTracing(filename or "", every_n_iterations)
+
+    def disable_tracing(self):
+        """Stops recording the timeline of the execution."""
+        if not self._built:
+            raise RuntimeError("Pipeline must be built first.")
+        self._pipe.DisableTracing()
+
+    def dump_trace(self, filename):
+        """Writes the recorded timeline of the execution as a Chrome trace JSON file.
+
+        Parameters
+        ----------
+        filename : str
+                   Name of the file to which the trace is written.
+        """
+        if not self._built:
+            raise RuntimeError("Pipeline must be built first.")
+        self._pipe.DumpTrace(filename)
+
     def define_graph(self):
         """This function is defined by the user to construct the
         graph of operations for their pipeline.
@@ -3,6 +3,7 @@
 #ifndef DALI_TEST_DALI_TEST_DECODER_H_
 #define DALI_TEST_DALI_TEST_DECODER_H_
 
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
@@ -12,6 +13,28 @@
 
 namespace dali {
 
+/**
+ * @brief Encodes a random h x w JPEG image with the EXIF orientation that rotates it by
+ *        90 degrees, so the decoded image is w x h
+ */
+inline std::vector<uint8_t> RotatedJpeg(int h, int w) {
+  cv::Mat img(h, w, CV_8UC3);
+  cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(256));
+  std::vector<uint8_t> jpeg;
+  cv::imencode(".jpg", img, jpeg);
+  const uint8_t exif[] = {
+    0xFF, 0xE1, 0x00, 0x22,  // APP1 marker, 34 bytes
+    'E', 'x', 'i', 'f', 0, 0,
+    'M', 'M', 0x00, 0x2A, 0x00, 0x00, 0x00, 0x08,  // big endian TIFF header
+    0x00, 0x01,  // single IFD entry: orientation (0x112), short, value 6
+    0x01, 0x12, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x06, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,  // no next IFD
+  };
+  // right after the SOI marker
+  jpeg.insert(jpeg.begin() + 2, std::begin(exif), std::end(exif));
+  return jpeg;
+}
+
 template <typename ImgType>
 class GenericDecoderTest : public DALISingleOpTest<ImgType> {
  public:
@@ -102,6 +125,32 @@ class GenericDecoderTest : public DALISingleOpTest<ImgType> {
     }
   }
 
+  /**
+   * Decodes the images straight into a tensor, with Image::DecodeTo,
+   * and compares them with the images decoded by OpenCV
+   */
+  void RunTestDecodeTo(const ImgSetDescr &imgs, float eps = 5e-2) {
+    this->SetEps(eps);
+    const int c = this->GetNumColorComp();
+    for (size_t imgIdx = 0; imgIdx < imgs.nImages(); ++imgIdx) {
+      Tensor<CPUBackend> image;
+      auto img = ImageFactory::CreateImage(
+          imgs.data_[imgIdx], imgs.sizes_[imgIdx], this->img_type_);
+      auto shape = img->DecodeTo([&image](const Image::Shape &shape) {
+        image.Resize(shape);
+        return image.mutable_data<uint8_t>();
+      });
+      ASSERT_EQ(image.shape(), TensorShape<>(shape));
+
+      Tensor<CPUBackend> reference;
+      this->DecodeImage(imgs.data_[imgIdx], imgs.sizes_[imgIdx], c, this->ImageType(),
+                        &reference);
+      ASSERT_EQ(image.shape(), reference.shape());
+      this->CheckBuffers(image.size(), reference.mutable_data<uint8>(),
+                         image.mutable_data<uint8>(), false, nullptr, image.shape());
+    }
+  }
+
   void VerifyDecode(const uint8 *img, int h, int w, const ImgSetDescr &imgs,
                     int img_id) const {
     // Compare w/ opencv result
@@ -24,6 +24,9 @@ import numpy as np
 from numpy.testing import assert_array_equal, assert_allclose
 import os
 import random
+import json
+import shutil
+import tempfile
 from PIL import Image
 
 from test_utils import check_batch
@@ -1354,6 +1357,120 @@ def test_pipeline_default_cuda_stream_priority():
             out2_data = out2[0].as_cpu()
             assert(np.sum(np.abs(out1_data.at(i)-out2_data.at(i)))==0)
 
+def test_executor_statistics():
+    batch_size = 8
+    n_iters = 3
+
+    class HybridPipe(Pipeline):
+        def __init__(self, batch_size):
+            super(HybridPipe, self).__init__(batch_size, num_threads=2, device_id=0)
+            self.input = ops.CaffeReader(path = caffe_db_folder)
+            self.decode = ops.ImageDecoder(device = "cpu", output_type = types.RGB)
+            self.res = ops.Resize(device="gpu", resize_x=64, resize_y=64)
+
+        def define_graph(self):
+            inputs, labels = self.input(name="Reader")
+            images = self.decode(inputs, name="Decoder")
+            images = self.res(images.gpu(), name="Resize")
+            return images
+
+    pipe = HybridPipe(batch_size)
+    pipe.build()
+    for _ in range(n_iters):
+        pipe.run()
+    stats = pipe.executor_statistics()
+    operators = stats["operators"]
+    # prefetching runs the pipeline ahead of the outputs
+    assert operators["Reader"]["iterations"] >= n_iters
+    assert operators["Reader"]["bytes_produced"] > 0
+    # the counters are updated independently, while the pipeline keeps prefetching,
+    # so they may be one iteration apart
+    decoder = operators["Decoder"]
+    assert decoder["device"] == "cpu"
+    assert abs(decoder["samples"] - decoder["iterations"] * batch_size) <= batch_size
+    assert abs(sum(decoder["sample_latency_histogram"]) - decoder["samples"]) <= batch_size
+    resize = operators["Resize"]
+    sample_bytes = 64 * 64 * 3
+    assert resize["device"] == "gpu"
+    assert resize["bytes_produced"] % sample_bytes == 0
+    produced_samples = resize["bytes_produced"] // sample_bytes
+    assert abs(produced_samples - resize["iterations"] * batch_size) <= batch_size
+    for stage in ["cpu", "mixed", "gpu"]:
+        assert stats["stages"][stage]["iterations"] >= n_iters
+
+def test_execution_trace():
+    batch_size = 8
+
+    class HybridPipe(Pipeline):
+        def __init__(self, batch_size):
+            super(HybridPipe, self).__init__(batch_size, num_threads=2, device_id=0)
+            self.input = ops.CaffeReader(path = caffe_db_folder)
+            self.decode = ops.ImageDecoder(device = "cpu", output_type = types.RGB)
+
+        def define_graph(self):
+            inputs, labels = self.input(name="Reader")
+            images = self.decode(inputs, name="Decoder")
+            return images
+
+    pipe = HybridPipe(batch_size)
+    pipe.build()
+    tmp_dir = tempfile.mkdtemp()
+    try:
+        periodic_trace = os.path.join(tmp_dir, "periodic.json")
+        pipe.enable_tracing(periodic_trace, every_n_iterations=2)
+        for _ in range(4):
+            pipe.run()
+        pipe.disable_tracing()
+        trace = os.path.join(tmp_dir, "trace.json")
+        pipe.dump_trace(trace)
+        for filename in [periodic_trace, trace]:
+            with open(filename) as f:
+                events = json.load(f)["traceEvents"]
+            names = [e["name"] for e in events if e["ph"] == "X"]
+            assert "[Executor] RunCPU" in names
+            assert "[Executor] Run CPU op Decoder" in names
+            assert "ThreadPool work" in names
+            thread_names = [e["args"]["name"] for e in events if e["ph"] == "M"]
+            assert any(name.startswith("DataReader prefetch") for name in thread_names)
+    finally:
+        shutil.rmtree(tmp_dir)
+
+def test_checkpointing():
+    batch_size = 4
+
+    class ReaderPipe(Pipeline):
+        def __init__(self, reader_type):
+            super(ReaderPipe, self).__init__(batch_size, num_threads=2, device_id=0,
+                                             enable_checkpointing=True)
+            if reader_type == "CaffeReader":
+                self.input = ops.CaffeReader(path = caffe_db_folder, random_shuffle = True,
+                                             initial_fill = 16)
+            else:
+                self.input = ops.MXNetReader(path = os.path.join(recordio_db_folder, "train.rec"),
+                                             index_path = os.path.join(recordio_db_folder, "train.idx"),
+                                             random_shuffle = True, initial_fill = 16,
+                                             shuffle_block_size = 8)
+
+        def define_graph(self):
+            inputs, labels = self.input(name="Reader")
+            return inputs, labels
+
+    def run(pipe, iterations):
+        return [[pipe.run()[0].at(i).tobytes() for i in range(batch_size)]
+                for _ in range(iterations)]
+
+    for reader_type in ["CaffeReader", "MXNetReader"]:
+        pipe = ReaderPipe(reader_type)
+        pipe.build()
+        run(pipe, 5)
+        checkpoint = pipe.checkpoint()
+        expected = run(pipe, 10)
+
+        restored = ReaderPipe(reader_type)
+        restored.build()
+        restored.restore_from_checkpoint(checkpoint)
+        assert run(restored, 10) == expected
+
 class CachedPipeline(Pipeline):
     def __init__(self, reader_type, batch_size, is_cached=False, is_cached_batch_copy=True,  seed=123456, skip_cached_images=False, num_shards=100000):
         super(CachedPipeline, self).__init__(batch_size, num_threads=1, device_id=0, prefetch_queue_depth=1, seed=seed)
@@ -0,0 +1,338 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#if LIBURING_ENABLED
+#include <liburing.h>
+#endif
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "dali/util/batch_file_reader.h"
+#include "dali/core/error_handling.h"
+#include "dali/pipeline/util/thread_pool.h"
+
+namespace dali {
+
+IOBackend ParseIOBackend(const std::string &name) {
+  if (name == "mmap") {
+    return IOBackend::MMAP;
+  } else if (name == "pread") {
+    return IOBackend::PREAD;
+  } else if (name == "io_uring") {
+    return IOBackend::IO_URING;
+  }
+  DALI_FAIL("Unknown I/O backend: \"" + name + "\". Supported values are: "
+            "\"mmap\", \"pread\" and \"io_uring\".");
+}
+
+namespace {
+
+/**
+ * @brief Reads the requests with blocking pread calls, distributed over a pool of threads
+ */
+class PreadFileReader : public BatchFileReader {
+ public:
+  PreadFileReader(int queue_depth, bool direct_io)
+      : BatchFileReader(queue_depth, direct_io), thread_pool_(queue_depth, -1, false) {}
+
+ protected:
+  void ReadAll(std::vector<ReadRequest> &requests) override {
+    int num_threads = thread_pool_.size();
+    for (int t = 0; t < num_threads; t++) {
+      thread_pool_.DoWorkWithID([this, &requests, t, num_threads](int) {
+        for (size_t i = t; i < requests.size(); i += num_threads) {
+          auto &req = requests[i];
+          while (req.done < req.required) {
+            req.start = ResumePosition(req);
+            ssize_t ret = pread(req.fd, req.dst + req.start, req.size - req.start,
+                                req.offset + req.start);
+            if (ret < 0 && errno == EINTR)
+              continue;
+            ReadCompleted(req, ret < 0 ? -errno : ret);
+          }
+        }
+      });
+    }
+    thread_pool_.WaitForWork();
+  }
+
+ private:
+  ThreadPool thread_pool_;
+};
+
+#if LIBURING_ENABLED
+
+/**
+ * @brief Submits the requests through io_uring, keeping up to `queue_depth` reads in flight
+ */
+class UringFileReader : public BatchFileReader {
+ public:
+  UringFileReader(int queue_depth, bool direct_io) : BatchFileReader(queue_depth, direct_io) {
+    int ret = io_uring_queue_init(queue_depth, &ring_, 0);
+    DALI_ENFORCE(ret == 0, "Failed to initialize io_uring: " + std::string(std::strerror(-ret)));
+  }
+
+  ~UringFileReader() override {
+    io_uring_queue_exit(&ring_);
+  }
+
+ protected:
+  void ReadAll(std::vector<ReadRequest> &requests) override {
+    std::deque<ReadRequest*> todo;
+    for (auto &req : requests)
+      todo.push_back(&req);
+
+    // submitted to the kernel and not completed yet
+    int in_flight = 0;
+    // prepared in the submission queue, not submitted yet
+    int unsubmitted = 0;
+    std::exception_ptr error;
+    while (!error && (!todo.empty() || in_flight + unsubmitted > 0)) {
+      try {
+        while (!todo.empty() && in_flight + unsubmitted < queue_depth_) {
+          io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+          if (!sqe)
+            break;
+          auto *req = todo.front();
+          todo.pop_front();
+          req->start = ResumePosition(*req);
+          io_uring_prep_read(sqe, req->fd, req->dst + req->start, req->size - req->start,
+                             req->offset + req->start);
+          io_uring_sqe_set_data(sqe, req);
+          unsubmitted++;
+        }
+        int ret = io_uring_submit_and_wait(&ring_, 1);
+        DALI_ENFORCE(ret >= 0 || ret == -EINTR,
+                     "io_uring submission failed: " + std::string(std::strerror(-ret)));
+        if (ret > 0) {
+          in_flight += ret;
+          unsubmitted -= ret;
+        }
+
+        io_uring_cqe *cqe = nullptr;
+        while (io_uring_peek_cqe(&ring_, &cqe) == 0 && cqe) {
+          auto *req = static_cast<ReadRequest*>(io_uring_cqe_get_data(cqe));
+          int res = cqe->res;
+          io_uring_cqe_seen(&ring_, cqe);
+          in_flight--;
+          if (res == -EINTR || res == -EAGAIN) {
+            todo.push_back(req);
+            continue;
+          }
+          ReadCompleted(*req, res);
+          // short read, the rest needs to be requested again
+          if (req->done < req->required)
+            todo.push_back(req);
+        }
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+    if (error) {
+      Drain(in_flight, unsubmitted);
+      std::rethrow_exception(error);
+    }
+  }
+
+ private:
+  /**
+   * @brief Waits for all the reads in flight, as they write to the buffers of the failed batch,
+   *        and drops the reads that were not submitted.
+   */
+  void Drain(int in_flight, int unsubmitted) {
+    while (in_flight > 0) {
+      io_uring_cqe *cqe = nullptr;
+      int ret = io_uring_wait_cqe(&ring_, &cqe);
+      if (ret == -EINTR || ret == -EAGAIN)
+        continue;
+      DALI_ENFORCE(ret == 0, "Waiting for io_uring completions failed: " +
+                   std::string(std::strerror(-ret)));
+      io_uring_cqe_seen(&ring_, cqe);
+      in_flight--;
+    }
+    if (unsubmitted > 0) {
+      // the prepared reads can't be taken back from the submission queue, start from scratch
+      io_uring_queue_exit(&ring_);
+      int ret = io_uring_queue_init(queue_depth_, &ring_, 0);
+      DALI_ENFORCE(ret == 0, "Failed to initialize io_uring: " +
+                   std::string(std::strerror(-ret)));
+    }
+  }
+
+  io_uring ring_;
+};
+
+#endif  // LIBURING_ENABLED
+
+}  // namespace
+
+constexpr int64 BatchFileReader::kDirectIOAlignment;
+
+std::unique_ptr<BatchFileReader> BatchFileReader::Create(IOBackend backend, int queue_depth,
+                                                         bool direct_io) {
+  DALI_ENFORCE(queue_depth > 0, "I/O queue depth needs to be greater than 0");
+  DALI_ENFORCE(backend != IOBackend::MMAP, "BatchFileReader doesn't support mmap");
+  if (backend == IOBackend::IO_URING) {
+#if LIBURING_ENABLED
+    try {
+      return std::unique_ptr<BatchFileReader>(new UringFileReader(queue_depth, direct_io));
+    } catch (const DALIException &e) {
+      DALI_WARN(std::string(e.what()) + ". Falling back to pread.");
+    }
+#else
+    DALI_WARN("DALI was built without liburing, falling back to pread.");
+#endif
+  }
+  return std::unique_ptr<BatchFileReader>(new PreadFileReader(queue_depth, direct_io));
+}
+
+BatchFileReader::~BatchFileReader() {
+  CloseFiles();
+}
+
+void BatchFileReader::ReadCompleted(ReadRequest &req, int64 ret) {
+  DALI_ENFORCE(ret >= 0, "Error reading from a file " + *req.path + ": " +
+               std::strerror(-ret));
+  // an aligned read may start before the data already read, it has to get past it
+  DALI_ENFORCE(req.start + ret > req.done, "Unexpected end of file " + *req.path);
+  req.done = req.start + ret;
+}
+
+int64 BatchFileReader::FileSize(const std::string &path) {
+  struct stat s;
+  DALI_ENFORCE(stat(path.c_str(), &s) == 0,
+               "Could not access " + path + ": " + std::strerror(errno));
+  return s.st_size;
+}
+
+void BatchFileReader::Enqueue(const std::string &path, int64 offset, size_t size, uint8_t *dst) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = fds_.find(path);
+  if (it == fds_.end()) {
+    int fd = open(path.c_str(), O_RDONLY | (direct_io_ ? O_DIRECT : 0));
+    if (fd < 0 && direct_io_ && errno == EINVAL) {
+      // the file system doesn't support O_DIRECT, the aligned reads work without it as well
+      static std::once_flag warned;
+      std::call_once(warned, [&path]() {
+        DALI_WARN("The file system of " + path + " doesn't support O_DIRECT, "
+                  "`direct_io` is not in effect for its files.");
+      });
+      fd = open(path.c_str(), O_RDONLY);
+    }
+    DALI_ENFORCE(fd >= 0, "Could not open file " + path + ": " + std::strerror(errno));
+    it = fds_.emplace(path, fd).first;
+  }
+  if (size == 0)
+    return;
+  requests_.push_back({it->second, offset, size, dst, 0, size, &it->first, 0});
+}
+
+void BatchFileReader::Wait() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!requests_.empty()) {
+    // make sure that the requests and the files are released even if reading fails
+    std::vector<ReadRequest> requests;
+    std::swap(requests, requests_);
+    try {
+      if (direct_io_) {
+        std::vector<StagedCopy> copies;
+        AlignRequests(requests, copies);
+        ReadAll(requests);
+        for (auto &copy : copies) {
+          std::memcpy(copy.dst, staging_.get() + copy.staging_pos, copy.size);
+        }
+      } else {
+        ReadAll(requests);
+      }
+    } catch (...) {
+      CloseFiles();
+      throw;
+    }
+  }
+  CloseFiles();
+}
+
+void BatchFileReader::AlignRequests(std::vector<ReadRequest> &requests,
+                                    std::vector<StagedCopy> &copies) {
+  const int64 A = kDirectIOAlignment;
+  std::vector<ReadRequest> aligned;
+  // position in the staging buffer of the reads that go there, -1 for the reads in place
+  std::vector<int64> staged;
+  size_t staging_total = 0;
+  auto stage = [&](const ReadRequest &req, int64 begin, int64 end, int64 from, int64 to) {
+    aligned.push_back({req.fd, begin, static_cast<size_t>(end - begin), nullptr, 0,
+                       static_cast<size_t>(to - begin), req.path, 0});
+    staged.push_back(staging_total);
+    copies.push_back({req.dst + (from - req.offset), staging_total + (from - begin),
+                      static_cast<size_t>(to - from)});
+    staging_total += end - begin;
+  };
+
+  for (auto &req : requests) {
+    int64 end = req.offset + req.size;
+    int64 aligned_begin = req.offset / A * A;
+    int64 aligned_end = (end + A - 1) / A * A;
+    // whole blocks of the fragment
+    int64 inner_begin = (req.offset + A - 1) / A * A;
+    int64 inner_end = end / A * A;
+    // the blocks can be read in place if the destination is aligned like the offset
+    int64 dst_misalignment = reinterpret_cast<uintptr_t>(req.dst) % A;
+    bool in_place = inner_end > inner_begin && dst_misalignment == req.offset % A;
+    if (!in_place) {
+      stage(req, aligned_begin, aligned_end, req.offset, end);
+      continue;
+    }
+    if (req.offset > aligned_begin)
+      stage(req, aligned_begin, inner_begin, req.offset, inner_begin);
+    size_t inner_size = inner_end - inner_begin;
+    aligned.push_back({req.fd, inner_begin, inner_size, req.dst + (inner_begin - req.offset), 0,
+                       inner_size, req.path, 0});
+    staged.push_back(-1);
+    if (end > inner_end)
+      stage(req, inner_end, aligned_end, inner_end, end);
+  }
+
+  if (staging_total > staging_size_) {
+    void *p = nullptr;
+    DALI_ENFORCE(posix_memalign(&p, A, staging_total) == 0,
+                 "Failed to allocate " + to_string(staging_total) + " bytes for direct I/O");
+    staging_.reset(static_cast<uint8_t*>(p));
+    staging_size_ = staging_total;
+  }
+  for (size_t i = 0; i < aligned.size(); i++) {
+    if (staged[i] >= 0)
+      aligned[i].dst = staging_.get() + staged[i];
+  }
+  requests.swap(aligned);
+}
+
+void BatchFileReader::CloseFiles() {
+  for (auto &entry : fds_) {
+    close(entry.second);
+  }
+  fds_.clear();
+}
+
+}  // namespace dali
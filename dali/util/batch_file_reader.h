@@ -0,0 +1,144 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_UTIL_BATCH_FILE_READER_H_
+#define DALI_UTIL_BATCH_FILE_READER_H_
+
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dali/core/api_helper.h"
+#include "dali/core/common.h"
+
+namespace dali {
+
+/**
+ * @brief How the readers access the files
+ */
+enum class IOBackend {
+  MMAP,      // LocalFileStream, files are memory mapped
+  PREAD,     // BatchFileReader, reads are issued with pread from a pool of threads
+  IO_URING   // BatchFileReader, reads are issued through io_uring
+};
+
+DLL_PUBLIC IOBackend ParseIOBackend(const std::string &name);
+
+/**
+ * @brief Reads many file fragments at once, straight into the provided buffers.
+ *
+ * Reads are only queued by Enqueue, which can be called from many threads.
+ * Wait issues all the queued reads, keeping up to `queue_depth` of them in flight,
+ * and returns when all of them are complete.
+ *
+ * With `direct_io` the files are opened with O_DIRECT, so the reads bypass the page cache.
+ * O_DIRECT requires the offset, the size and the buffer to be aligned to kDirectIOAlignment.
+ * The aligned blocks of a fragment are read straight into the destination, if it has the same
+ * alignment as the offset in the file. The partial blocks at the ends, or the whole fragment
+ * when the alignments differ, are read into an aligned staging buffer and copied from there.
+ */
+class DLL_PUBLIC BatchFileReader {
+ public:
+  /**
+   * @brief Creates a reader for the given backend.
+   *
+   * If io_uring is not available (DALI built without liburing or the kernel doesn't
+   * support it), the pread based reader is returned.
+   */
+  static std::unique_ptr<BatchFileReader> Create(IOBackend backend, int queue_depth,
+                                                 bool direct_io = false);
+
+  // Alignment of O_DIRECT reads, large enough for any logical block size in use
+  static constexpr int64 kDirectIOAlignment = 4096;
+
+  virtual ~BatchFileReader();
+
+  /**
+   * @brief Queue reading `size` bytes of `path` starting at `offset` into `dst`
+   */
+  void Enqueue(const std::string &path, int64 offset, size_t size, uint8_t *dst);
+
+  /**
+   * @brief Issue all queued reads and wait for them to complete
+   */
+  void Wait();
+
+  static int64 FileSize(const std::string &path);
+
+ protected:
+  struct ReadRequest {
+    int fd;
+    int64 offset;
+    size_t size;
+    uint8_t *dst;
+    // how many bytes have been read already
+    size_t done;
+    // how many bytes are actually needed, the aligned reads may end past the end of file
+    size_t required;
+    const std::string *path;
+    // where the read in flight starts
+    size_t start;
+  };
+
+  BatchFileReader(int queue_depth, bool direct_io)
+      : queue_depth_(queue_depth), direct_io_(direct_io) {}
+
+  virtual void ReadAll(std::vector<ReadRequest> &requests) = 0;
+
+  /**
+   * @brief Where the next read of the request starts. With O_DIRECT the reads have to
+   *        start at a block boundary, so after a short read the last, partially read block
+   *        is read again.
+   */
+  size_t ResumePosition(const ReadRequest &req) const {
+    return direct_io_ ? req.done / kDirectIOAlignment * kDirectIOAlignment : req.done;
+  }
+
+  // Accounts for `ret` bytes read at `req.start`, `ret` being the result of the read
+  static void ReadCompleted(ReadRequest &req, int64 ret);
+
+  int queue_depth_;
+
+ private:
+  // Part of a fragment read into the staging buffer, copied to the destination afterwards
+  struct StagedCopy {
+    uint8_t *dst;
+    size_t staging_pos;
+    size_t size;
+  };
+
+  void CloseFiles();
+
+  // Splits the requests into aligned reads, either in place or into the staging buffer
+  void AlignRequests(std::vector<ReadRequest> &requests, std::vector<StagedCopy> &copies);
+
+  bool direct_io_;
+  std::mutex mutex_;
+  std::vector<ReadRequest> requests_;
+  // files are opened once per batch
+  std::unordered_map<std::string, int> fds_;
+
+  struct FreeDeleter {
+    void operator()(void *p) const { free(p); }
+  };
+  std::unique_ptr<uint8_t, FreeDeleter> staging_;
+  size_t staging_size_ = 0;
+};
+
+}  // namespace dali
+
+#endif  // DALI_UTIL_BATCH_FILE_READER_H_
@@ -0,0 +1,121 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dali/util/batch_file_reader.h"
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace dali {
+
+class BatchFileReaderTest : public ::testing::TestWithParam<std::tuple<IOBackend, bool>> {
+ public:
+  std::unique_ptr<BatchFileReader> CreateReader(int queue_depth) {
+    return BatchFileReader::Create(std::get<0>(GetParam()), queue_depth, std::get<1>(GetParam()));
+  }
+
+  void SetUp() override {
+    char name[] = "/tmp/dali_batch_file_reader_XXXXXX";
+    int fd = mkstemp(name);
+    ASSERT_GE(fd, 0);
+    path_ = name;
+    data_.resize(1 << 20);
+    for (size_t i = 0; i < data_.size(); i++)
+      data_[i] = static_cast<uint8_t>(i * 7 + i / 251);
+    ASSERT_EQ(write(fd, data_.data(), data_.size()), static_cast<ssize_t>(data_.size()));
+    close(fd);
+  }
+
+  void TearDown() override {
+    std::remove(path_.c_str());
+  }
+
+  std::string path_;
+  std::vector<uint8_t> data_;
+};
+
+TEST_P(BatchFileReaderTest, ReadFragments) {
+  auto reader = CreateReader(8);
+  EXPECT_EQ(BatchFileReader::FileSize(path_), static_cast<int64>(data_.size()));
+
+  const int kFragments = 100;
+  std::vector<std::vector<uint8_t>> out(kFragments);
+  std::vector<int64> offsets(kFragments);
+  for (int iter = 0; iter < 2; iter++) {
+    for (int i = 0; i < kFragments; i++) {
+      offsets[i] = (i * 104729) % (data_.size() - 10000);
+      out[i].assign(1000 + i * 90, 0);
+      reader->Enqueue(path_, offsets[i], out[i].size(), out[i].data());
+    }
+    reader->Wait();
+    for (int i = 0; i < kFragments; i++) {
+      ASSERT_TRUE(std::equal(out[i].begin(), out[i].end(), data_.begin() + offsets[i]));
+    }
+  }
+}
+
+TEST_P(BatchFileReaderTest, ReadAlignedFragments) {
+  // destinations aligned like the offsets, so with O_DIRECT the whole blocks are read in place
+  const int64 A = BatchFileReader::kDirectIOAlignment;
+  auto reader = CreateReader(4);
+  std::vector<uint8_t> buffer(data_.size() + A);
+  uint8_t *base = buffer.data() + (A - reinterpret_cast<uintptr_t>(buffer.data()) % A) % A;
+  std::vector<std::pair<int64, size_t>> fragments = {
+    {0, 3 * A}, {5 * A + 100, 4 * A}, {20 * A, 2 * A + 1}, {30 * A - 1, 2},
+    {40 * A + 7, 100}, {static_cast<int64>(data_.size()) - A - 10, A + 10},
+  };
+  for (auto &f : fragments)
+    reader->Enqueue(path_, f.first, f.second, base + f.first);
+  // misaligned destination, read through the staging buffer
+  std::vector<uint8_t> misaligned(3 * A);
+  reader->Enqueue(path_, 50 * A, misaligned.size() - 1, misaligned.data() + 1);
+  reader->Wait();
+  for (auto &f : fragments) {
+    ASSERT_TRUE(std::equal(base + f.first, base + f.first + f.second,
+                           data_.begin() + f.first));
+  }
+  EXPECT_TRUE(std::equal(misaligned.begin() + 1, misaligned.end(), data_.begin() + 50 * A));
+}
+
+TEST_P(BatchFileReaderTest, ReadPastEnd) {
+  auto reader = CreateReader(4);
+  std::vector<uint8_t> out(100);
+  reader->Enqueue(path_, data_.size() - 10, out.size(), out.data());
+  EXPECT_THROW(reader->Wait(), std::exception);
+  // the reader is usable after an error
+  reader->Enqueue(path_, 0, out.size(), out.data());
+  reader->Wait();
+  EXPECT_TRUE(std::equal(out.begin(), out.end(), data_.begin()));
+}
+
+TEST_P(BatchFileReaderTest, NonExistentFile) {
+  auto reader = CreateReader(4);
+  std::vector<uint8_t> out(100);
+  EXPECT_THROW(reader->Enqueue(path_ + "_does_not_exist", 0, out.size(), out.data()),
+               std::exception);
+}
+
+INSTANTIATE_TEST_SUITE_P(BatchFileReaderTest, BatchFileReaderTest,
+                         ::testing::Combine(
+                            ::testing::Values(IOBackend::PREAD, IOBackend::IO_URING),
+                            ::testing::Bool()));
+
+}  // namespace dali
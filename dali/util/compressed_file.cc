@@ -0,0 +1,281 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dali/util/compressed_file.h"
+#include "dali/core/error_handling.h"
+
+namespace dali {
+
+Compression ParseCompression(const std::string &name) {
+  std::string lower = name;
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  if (lower.empty() || lower == "none") {
+    return Compression::NONE;
+  } else if (lower == "gzip") {
+    return Compression::GZIP;
+  } else if (lower == "zlib") {
+    return Compression::ZLIB;
+  }
+  DALI_FAIL("Unknown compression: \"" + name + "\". Supported values are: "
+            "\"none\", \"gzip\" and \"zlib\".");
+}
+
+namespace {
+
+// how much compressed data is read from the file at once
+constexpr size_t kInputBufferSize = 256 << 10;
+
+}  // namespace
+
+CompressedFileStream::CompressedFileStream(const std::string &path, Compression compression,
+                                           size_t chunk_size, int max_chunks)
+    : FileStream(path), compression_(compression), chunk_size_(chunk_size),
+      max_chunks_(max_chunks) {
+  DALI_ENFORCE(compression_ != Compression::NONE, "CompressedFileStream needs a compression");
+  DALI_ENFORCE(chunk_size_ > 0 && max_chunks_ > 0, "Invalid decompression buffer size");
+  file_ = std::fopen(path_.c_str(), "rb");
+  DALI_ENFORCE(file_ != nullptr, "Could not open file " + path_ + ": " + std::strerror(errno));
+  std::memset(&zstream_, 0, sizeof(zstream_));
+  Start();
+}
+
+CompressedFileStream::~CompressedFileStream() {
+  Close();
+}
+
+void CompressedFileStream::Close() {
+  Stop();
+  if (zstream_initialized_) {
+    inflateEnd(&zstream_);
+    zstream_initialized_ = false;
+  }
+  if (file_) {
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+void CompressedFileStream::Start() {
+  std::rewind(file_);
+  // 16 added to the window bits selects the gzip header, otherwise the zlib header is expected
+  int window_bits = compression_ == Compression::GZIP ? 16 + MAX_WBITS : MAX_WBITS;
+  int ret = zstream_initialized_ ? inflateReset(&zstream_)
+                                 : inflateInit2(&zstream_, window_bits);
+  DALI_ENFORCE(ret == Z_OK, "Failed to initialize the decompression of " + path_);
+  zstream_initialized_ = true;
+  zstream_.next_in = nullptr;
+  zstream_.avail_in = 0;
+
+  for (auto &chunk : ready_)
+    free_.push_back(std::move(chunk));
+  ready_.clear();
+  if (!current_.empty())
+    free_.push_back(std::move(current_));
+  current_.clear();
+  current_pos_ = 0;
+  pos_ = 0;
+  stop_ = false;
+  finished_ = false;
+  error_ = nullptr;
+  worker_ = std::thread(&CompressedFileStream::DecompressLoop, this);
+}
+
+void CompressedFileStream::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  space_cv_.notify_all();
+  if (worker_.joinable())
+    worker_.join();
+}
+
+bool CompressedFileStream::Publish(std::vector<uint8_t> &&chunk) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  space_cv_.wait(lock, [&]() {
+    return stop_ || ready_.size() < static_cast<size_t>(max_chunks_);
+  });
+  if (stop_)
+    return false;
+  ready_.push_back(std::move(chunk));
+  ready_cv_.notify_one();
+  return true;
+}
+
+void CompressedFileStream::DecompressLoop() {
+  try {
+    auto take_chunk = [&]() {
+      std::vector<uint8_t> chunk;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_.empty()) {
+          chunk = std::move(free_.back());
+          free_.pop_back();
+        }
+      }
+      chunk.resize(chunk_size_);
+      return chunk;
+    };
+
+    std::vector<uint8_t> in(kInputBufferSize);
+    std::vector<uint8_t> chunk = take_chunk();
+    size_t filled = 0;
+    bool input_end = false;
+    bool stream_end = false;
+    while (true) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_)
+          return;
+      }
+      if (zstream_.avail_in == 0 && !input_end) {
+        size_t n = std::fread(in.data(), 1, in.size(), file_);
+        if (n < in.size()) {
+          DALI_ENFORCE(!std::ferror(file_), "Error reading from a file " + path_);
+          input_end = true;
+        }
+        zstream_.next_in = in.data();
+        zstream_.avail_in = n;
+      }
+      if (stream_end) {
+        if (zstream_.avail_in == 0 && input_end)
+          break;
+        // concatenated gzip files are a valid gzip file as well
+        DALI_ENFORCE(compression_ == Compression::GZIP,
+                     "Unexpected data after the end of the compressed stream in " + path_);
+        DALI_ENFORCE(inflateReset(&zstream_) == Z_OK,
+                     "Failed to restart the decompression of " + path_);
+        stream_end = false;
+        continue;
+      }
+
+      zstream_.next_out = chunk.data() + filled;
+      zstream_.avail_out = chunk.size() - filled;
+      int ret = inflate(&zstream_, Z_NO_FLUSH);
+      filled = chunk.size() - zstream_.avail_out;
+      if (ret == Z_STREAM_END) {
+        stream_end = true;
+      } else if (ret == Z_BUF_ERROR) {
+        // no progress was possible, more input is needed
+        DALI_ENFORCE(!input_end || zstream_.avail_in > 0,
+                     "Unexpected end of the compressed file " + path_);
+      } else {
+        DALI_ENFORCE(ret == Z_OK, "Error decompressing " + path_ + ": " +
+                     (zstream_.msg ? zstream_.msg : "invalid data"));
+      }
+
+      if (filled == chunk.size()) {
+        if (!Publish(std::move(chunk)))
+          return;
+        chunk = take_chunk();
+        filled = 0;
+      }
+    }
+    if (filled > 0) {
+      chunk.resize(filled);
+      if (!Publish(std::move(chunk)))
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_ = true;
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_ = std::current_exception();
+    finished_ = true;
+  }
+  ready_cv_.notify_all();
+}
+
+bool CompressedFileStream::NextChunk() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ready_cv_.wait(lock, [&]() { return !ready_.empty() || finished_; });
+  if (ready_.empty()) {
+    if (error_)
+      std::rethrow_exception(error_);
+    return false;
+  }
+  if (current_.capacity() > 0)
+    free_.push_back(std::move(current_));
+  current_ = std::move(ready_.front());
+  ready_.pop_front();
+  current_pos_ = 0;
+  space_cv_.notify_one();
+  return true;
+}
+
+size_t CompressedFileStream::Read(uint8_t *buffer, size_t n_bytes) {
+  size_t total = 0;
+  while (total < n_bytes) {
+    if (current_pos_ == current_.size()) {
+      if (!NextChunk())
+        break;
+      continue;
+    }
+    size_t n = std::min(n_bytes - total, current_.size() - current_pos_);
+    std::memcpy(buffer + total, current_.data() + current_pos_, n);
+    current_pos_ += n;
+    total += n;
+  }
+  pos_ += total;
+  return total;
+}
+
+size_t CompressedFileStream::Skip(size_t n_bytes) {
+  size_t total = 0;
+  while (total < n_bytes) {
+    if (current_pos_ == current_.size()) {
+      if (!NextChunk())
+        break;
+      continue;
+    }
+    size_t n = std::min(n_bytes - total, current_.size() - current_pos_);
+    current_pos_ += n;
+    total += n;
+  }
+  pos_ += total;
+  return total;
+}
+
+shared_ptr<void> CompressedFileStream::Get(size_t n_bytes) {
+  shared_ptr<uint8_t> buffer(new uint8_t[n_bytes], std::default_delete<uint8_t[]>());
+  if (Read(buffer.get(), n_bytes) != n_bytes)
+    return nullptr;
+  return buffer;
+}
+
+void CompressedFileStream::Seek(int64 pos) {
+  DALI_ENFORCE(pos >= 0, "Invalid seek");
+  if (pos < pos_) {
+    Stop();
+    Start();
+  }
+  Skip(pos - pos_);
+  DALI_ENFORCE(pos_ == pos, "Invalid seek, " + to_string(pos) +
+               " is past the end of the decompressed " + path_);
+}
+
+size_t CompressedFileStream::Size() const {
+  DALI_FAIL("The size of the decompressed " + path_ + " is not known");
+}
+
+}  // namespace dali
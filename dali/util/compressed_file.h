@@ -0,0 +1,115 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_UTIL_COMPRESSED_FILE_H_
+#define DALI_UTIL_COMPRESSED_FILE_H_
+
+#include <zlib.h>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dali/core/api_helper.h"
+#include "dali/core/common.h"
+#include "dali/util/file.h"
+
+namespace dali {
+
+enum class Compression {
+  NONE,
+  GZIP,
+  ZLIB
+};
+
+/**
+ * @brief Accepts "none" (or empty), "gzip" and "zlib", in any case
+ */
+DLL_PUBLIC Compression ParseCompression(const std::string &name);
+
+/**
+ * @brief Reads the decompressed content of a GZIP or ZLIB compressed file.
+ *
+ * The file is decompressed ahead of the reads by a separate thread, which keeps up to
+ * `max_chunks` chunks of `chunk_size` bytes ready. Seeking forward skips the data, seeking
+ * backward starts the decompression from the beginning of the file. Concatenated GZIP members
+ * are read as one stream.
+ */
+class DLL_PUBLIC CompressedFileStream : public FileStream {
+ public:
+  CompressedFileStream(const std::string &path, Compression compression,
+                       size_t chunk_size = 1 << 20, int max_chunks = 4);
+  ~CompressedFileStream() override;
+
+  void Close() override;
+
+  size_t Read(uint8_t *buffer, size_t n_bytes) override;
+
+  /**
+   * @brief Reads `n_bytes` to a new buffer, the data can't be shared with the stream
+   */
+  shared_ptr<void> Get(size_t n_bytes) override;
+
+  void Seek(int64 pos) override;
+
+  /**
+   * @brief Not available, the decompressed size is not known until the whole file is read
+   */
+  size_t Size() const override;
+
+  int64 Tell() const {
+    return pos_;
+  }
+
+ private:
+  void Start();
+  void Stop();
+  void DecompressLoop();
+  // Pushes the chunk to the consumer, returns false if the stream is being stopped
+  bool Publish(std::vector<uint8_t> &&chunk);
+  // Makes the next decompressed chunk current, returns false at the end of the stream
+  bool NextChunk();
+  size_t Skip(size_t n_bytes);
+
+  Compression compression_;
+  size_t chunk_size_;
+  int max_chunks_;
+
+  FILE *file_ = nullptr;
+  z_stream zstream_;
+  bool zstream_initialized_ = false;
+
+  std::thread worker_;
+  std::mutex mutex_;
+  std::condition_variable ready_cv_, space_cv_;
+  std::deque<std::vector<uint8_t>> ready_;
+  std::vector<std::vector<uint8_t>> free_;
+  bool stop_ = false;
+  bool finished_ = false;
+  std::exception_ptr error_;
+
+  // consumer side
+  std::vector<uint8_t> current_;
+  size_t current_pos_ = 0;
+  int64 pos_ = 0;
+};
+
+}  // namespace dali
+
+#endif  // DALI_UTIL_COMPRESSED_FILE_H_
@@ -0,0 +1,151 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dali/util/compressed_file.h"
+#include <gtest/gtest.h>
+#include <zlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "dali/core/error_handling.h"
+
+namespace dali {
+
+namespace {
+
+std::vector<uint8_t> Compress(const std::vector<uint8_t> &data, Compression compression) {
+  z_stream zs = {};
+  int window_bits = compression == Compression::GZIP ? 16 + MAX_WBITS : MAX_WBITS;
+  EXPECT_EQ(deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8,
+                         Z_DEFAULT_STRATEGY), Z_OK);
+  std::vector<uint8_t> out(deflateBound(&zs, data.size()));
+  zs.next_in = const_cast<uint8_t*>(data.data());
+  zs.avail_in = data.size();
+  zs.next_out = out.data();
+  zs.avail_out = out.size();
+  EXPECT_EQ(deflate(&zs, Z_FINISH), Z_STREAM_END);
+  out.resize(zs.total_out);
+  deflateEnd(&zs);
+  return out;
+}
+
+}  // namespace
+
+class CompressedFileStreamTest : public ::testing::TestWithParam<Compression> {
+ public:
+  void SetUp() override {
+    data_.resize(3 << 20);
+    for (size_t i = 0; i < data_.size(); i++)
+      data_[i] = static_cast<uint8_t>((i * 7 + i / 251) % 13);
+    WriteFile(Compress(data_, GetParam()));
+  }
+
+  void TearDown() override {
+    if (!path_.empty())
+      std::remove(path_.c_str());
+  }
+
+  void WriteFile(const std::vector<uint8_t> &content) {
+    if (path_.empty()) {
+      char name[] = "/tmp/dali_compressed_file_XXXXXX";
+      int fd = mkstemp(name);
+      ASSERT_GE(fd, 0);
+      close(fd);
+      path_ = name;
+    }
+    FILE *f = std::fopen(path_.c_str(), "wb");
+    ASSERT_NE(f, nullptr);
+    ASSERT_EQ(std::fwrite(content.data(), 1, content.size(), f), content.size());
+    std::fclose(f);
+  }
+
+  std::string path_;
+  std::vector<uint8_t> data_;
+};
+
+TEST_P(CompressedFileStreamTest, ReadAll) {
+  // small chunks, so the reads span many of them
+  CompressedFileStream stream(path_, GetParam(), 4000, 3);
+  std::vector<uint8_t> out(data_.size() + 100);
+  size_t pos = 0;
+  size_t step = 1;
+  while (pos < out.size()) {
+    size_t n = stream.Read(out.data() + pos, std::min(step, out.size() - pos));
+    if (n == 0)
+      break;
+    pos += n;
+    step = step * 3 + 1;
+  }
+  ASSERT_EQ(pos, data_.size());
+  out.resize(pos);
+  EXPECT_EQ(out, data_);
+  EXPECT_EQ(stream.Tell(), static_cast<int64>(data_.size()));
+}
+
+TEST_P(CompressedFileStreamTest, Seek) {
+  CompressedFileStream stream(path_, GetParam(), 1 << 16, 2);
+  std::vector<uint8_t> out(1000);
+  for (int64 pos : {100000, 2500000, 50, 1 << 20, 0}) {
+    stream.Seek(pos);
+    ASSERT_EQ(stream.Read(out.data(), out.size()), out.size());
+    EXPECT_TRUE(std::equal(out.begin(), out.end(), data_.begin() + pos));
+  }
+  EXPECT_THROW(stream.Seek(data_.size() + 1), DALIException);
+}
+
+TEST_P(CompressedFileStreamTest, Truncated) {
+  auto compressed = Compress(data_, GetParam());
+  compressed.resize(compressed.size() / 2);
+  WriteFile(compressed);
+  CompressedFileStream stream(path_, GetParam());
+  std::vector<uint8_t> out(data_.size());
+  EXPECT_THROW(stream.Read(out.data(), out.size()), DALIException);
+}
+
+INSTANTIATE_TEST_SUITE_P(CompressedFileStream, CompressedFileStreamTest,
+                         ::testing::Values(Compression::GZIP, Compression::ZLIB));
+
+TEST(CompressedFileStream, ConcatenatedGzip) {
+  std::vector<uint8_t> a(1000, 'a'), b(2000, 'b');
+  auto content = Compress(a, Compression::GZIP);
+  auto second = Compress(b, Compression::GZIP);
+  content.insert(content.end(), second.begin(), second.end());
+
+  char name[] = "/tmp/dali_compressed_file_XXXXXX";
+  int fd = mkstemp(name);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(write(fd, content.data(), content.size()), static_cast<ssize_t>(content.size()));
+  close(fd);
+
+  CompressedFileStream stream(name, Compression::GZIP);
+  std::vector<uint8_t> out(4000);
+  EXPECT_EQ(stream.Read(out.data(), out.size()), a.size() + b.size());
+  EXPECT_TRUE(std::equal(a.begin(), a.end(), out.begin()));
+  EXPECT_TRUE(std::equal(b.begin(), b.end(), out.begin() + a.size()));
+  std::remove(name);
+}
+
+TEST(CompressedFileStream, ParseCompression) {
+  EXPECT_EQ(ParseCompression(""), Compression::NONE);
+  EXPECT_EQ(ParseCompression("none"), Compression::NONE);
+  EXPECT_EQ(ParseCompression("GZIP"), Compression::GZIP);
+  EXPECT_EQ(ParseCompression("zlib"), Compression::ZLIB);
+  EXPECT_THROW(ParseCompression("lz4"), DALIException);
+}
+
+}  // namespace dali
@@ -0,0 +1,42 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_UTIL_CRC32C_H_
+#define DALI_UTIL_CRC32C_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "dali/core/api_helper.h"
+
+namespace dali {
+
+/**
+ * @brief CRC-32C (Castagnoli), as used by the TFRecord format
+ *
+ * @param crc value returned for the preceding data, used to compute the checksum incrementally
+ */
+DLL_PUBLIC uint32_t Crc32c(const void *data, size_t size, uint32_t crc = 0);
+
+/**
+ * @brief Masked CRC-32C stored in TFRecord files
+ */
+inline uint32_t MaskedCrc32c(const void *data, size_t size) {
+  uint32_t crc = Crc32c(data, size);
+  return ((crc >> 15) | (crc << 17)) + 0xa282ead8u;
+}
+
+}  // namespace dali
+
+#endif  // DALI_UTIL_CRC32C_H_
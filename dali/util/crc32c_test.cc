@@ -0,0 +1,44 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "dali/util/crc32c.h"
+
+namespace dali {
+
+TEST(Crc32c, KnownValues) {
+  // test vectors from RFC 3720, appendix B.4
+  std::vector<uint8_t> zeros(32, 0), ones(32, 0xff), incrementing(32);
+  for (int i = 0; i < 32; i++)
+    incrementing[i] = i;
+  EXPECT_EQ(Crc32c(zeros.data(), zeros.size()), 0x8a9136aau);
+  EXPECT_EQ(Crc32c(ones.data(), ones.size()), 0x62a8ab43u);
+  EXPECT_EQ(Crc32c(incrementing.data(), incrementing.size()), 0x46dd794eu);
+  std::string digits = "123456789";
+  EXPECT_EQ(Crc32c(digits.data(), digits.size()), 0xe3069283u);
+}
+
+TEST(Crc32c, Incremental) {
+  std::string text = "The quick brown fox jumps over the lazy dog";
+  uint32_t crc = Crc32c(text.data(), text.size());
+  for (size_t split = 0; split <= text.size(); split++) {
+    uint32_t head = Crc32c(text.data(), split);
+    EXPECT_EQ(Crc32c(text.data() + split, text.size() - split, head), crc);
+  }
+}
+
+}  // namespace dali
@@ -28,6 +28,7 @@
 #include <vector>
 
 #include "dali/core/api_helper.h"
+#include "dali/core/tracer.h"
 
 namespace dali {
 
@@ -70,6 +71,9 @@ enum class StorageDevice {
   COUNT = 2,
 };
 
+// Device id of the pipelines that run only CPU operators and don't touch CUDA at all
+constexpr int CPU_ONLY_DEVICE_ID = -99999;
+
 static std::string to_string(OpType op_type) {
   switch (op_type) {
     case OpType::CPU:
@@ -132,7 +136,7 @@ inline int NumberOfChannels(DALIImageType type) {
 #define CONCAT_2(var1, var2) CONCAT_1(var1, var2)
 #define ANONYMIZE_VARIABLE(name) CONCAT_2(name, __LINE__)
 
-// Basic timerange for profiling
+// Basic timerange for profiling, marks the range for NVTX and for the Tracer
 struct TimeRange {
   static const uint32_t kRed = 0xFF0000;
   static const uint32_t kGreen = 0x00FF00;
@@ -161,6 +165,10 @@ struct TimeRange {
     started = true;
 
 #endif
+    if (Tracer::IsEnabled()) {
+      trace_name_ = std::move(name);
+      trace_begin_ns_ = Tracer::Now();
+    }
   }
 
   ~TimeRange() { stop(); }
@@ -172,13 +180,18 @@ struct TimeRange {
       nvtxRangePop();
     }
 #endif
+    if (trace_begin_ns_ >= 0) {
+      Tracer::Record(trace_name_, trace_begin_ns_, Tracer::Now());
+      trace_begin_ns_ = -1;
+    }
   }
 
-#ifdef DALI_USE_NVTX
-
  private:
+#ifdef DALI_USE_NVTX
   bool started = false;
 #endif
+  std::string trace_name_;
+  int64_t trace_begin_ns_ = -1;
 };
 
 using std::to_string;
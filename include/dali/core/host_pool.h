@@ -0,0 +1,166 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_CORE_HOST_POOL_H_
+#define DALI_CORE_HOST_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "dali/core/api_helper.h"
+
+namespace dali {
+
+/**
+ * @brief Pool of host memory blocks, rounded up to size classes and reused
+ *        instead of going back to the system allocator.
+ *
+ * There are 8 size classes per power of two, so a block wastes at most 1/8 of its size.
+ * Blocks up to `kMaxThreadCachedBytes` are kept in a small cache of the thread that frees
+ * them, so most of the allocations of a thread don't take any lock. A thread cache keeps at
+ * most `thread_cache_bytes`. Bigger blocks and the overflow of the thread caches go to the
+ * shared cache, one free list per size class. The shared cache keeps at most
+ * `release_threshold` bytes; blocks freed beyond that go back to the system, and so do all
+ * the blocks freed or flushed from the thread caches while the pooling is disabled.
+ *
+ * Every block starts with a small header with its size class, so `Deallocate` doesn't need
+ * the size and blocks can be freed even after the pooling is disabled. With the pooling
+ * disabled (the default for the `Instance`), the pool is a thin wrapper over `malloc`.
+ *
+ * Blocks of at least `kMinHugePageBytes` can be backed with 2 MiB pages, see `HugePages`.
+ * That's independent of the pooling.
+ */
+class DLL_PUBLIC HostMemoryPool {
+ public:
+  struct Params {
+    // bytes the shared cache may keep before freeing the blocks to the system
+    size_t release_threshold = size_t(1) << 30;
+    // bytes every thread may keep in its cache, in all the size classes
+    size_t thread_cache_bytes = size_t(4) << 20;
+  };
+
+  enum class HugePages {
+    // regular pages
+    Off,
+    // transparent huge pages, requested with madvise(MADV_HUGEPAGE)
+    Transparent,
+    // the pages reserved in hugetlbfs (MAP_HUGETLB), falling back to `Transparent`
+    // when there are none left
+    Reserved,
+  };
+
+  struct Stats {
+    // bytes of the blocks held by the callers, rounded up to the size classes
+    size_t allocated_bytes;
+    size_t peak_allocated_bytes;
+    // bytes of the free blocks kept by the pool, in all the caches
+    size_t cached_bytes;
+    // allocations served from the caches
+    size_t hits;
+    // allocations which had to go to the system allocator
+    size_t misses;
+    // blocks given back to the system
+    size_t releases;
+    // blocks mapped with huge pages requested, and the ones among them which wanted
+    // reserved huge pages, but fell back to the transparent ones
+    size_t huge_page_blocks;
+    size_t huge_page_fallbacks;
+  };
+
+  static constexpr size_t kMaxThreadCachedBytes = 256 << 10;
+  // Bigger blocks are not pooled at all
+  static constexpr size_t kMaxPooledBytes = size_t(1) << 36;
+  // Smaller blocks are never backed by huge pages - they would waste too much memory
+  static constexpr size_t kMinHugePageBytes = 4 << 20;
+  static constexpr size_t kHugePageSize = 2 << 20;
+
+  /**
+   * @brief The pool shared by the CPU allocators of the pipeline and of the kernels
+   *
+   * The huge pages are initially set with the `DALI_HUGE_PAGES` environment variable:
+   * "off" (default), "thp" or "reserved".
+   */
+  static HostMemoryPool &Instance();
+
+  HostMemoryPool();
+  explicit HostMemoryPool(const Params &params, bool enabled = true);
+  ~HostMemoryPool();
+
+  HostMemoryPool(const HostMemoryPool &) = delete;
+  HostMemoryPool &operator=(const HostMemoryPool &) = delete;
+
+  /**
+   * @brief Allocates `bytes` bytes, aligned like malloc. Returns nullptr on failure.
+   */
+  void *Allocate(size_t bytes) noexcept;
+
+  /**
+   * @brief Frees a block returned by `Allocate` of this pool
+   */
+  void Deallocate(void *ptr) noexcept;
+
+  void SetEnabled(bool enabled);
+
+  bool IsEnabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  void SetParams(const Params &params);
+
+  /**
+   * @brief Sets the pages of the big blocks allocated from now on
+   */
+  void SetHugePages(HugePages huge_pages) {
+    huge_pages_ = static_cast<int>(huge_pages);
+  }
+
+  HugePages GetHugePages() const {
+    return static_cast<HugePages>(huge_pages_.load(std::memory_order_relaxed));
+  }
+
+  /**
+   * @brief Gives the blocks in the shared cache and in the cache of the calling thread
+   *        back to the system. The caches of the other threads are kept.
+   */
+  void Release();
+
+  Stats GetStats() const;
+
+  /**
+   * @brief Size class of an allocation of `bytes` bytes, 0 for up to `kMinBlockBytes`
+   */
+  static int SizeClass(size_t bytes);
+
+  /**
+   * @brief Usable bytes of a block of the given size class
+   */
+  static size_t ClassBytes(int size_class);
+
+  static constexpr size_t kMinBlockBytes = 64;
+
+  struct SharedCache;
+
+ private:
+  void *AllocateBlock(int size_class, size_t bytes) noexcept;
+
+  std::atomic<bool> enabled_;
+  std::atomic<int> huge_pages_{static_cast<int>(HugePages::Off)};
+  std::shared_ptr<SharedCache> shared_;
+};
+
+}  // namespace dali
+
+#endif  // DALI_CORE_HOST_POOL_H_
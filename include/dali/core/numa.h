@@ -0,0 +1,100 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_CORE_NUMA_H_
+#define DALI_CORE_NUMA_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "dali/core/api_helper.h"
+
+namespace dali {
+namespace numa {
+
+/**
+ * @brief Number of the NUMA nodes of the host, as reported by sysfs.
+ *
+ * Hosts without NUMA (or without sysfs) are reported as a single node with all the CPUs.
+ */
+DLL_PUBLIC int NumNodes();
+
+/**
+ * @brief CPUs of the given NUMA node
+ */
+DLL_PUBLIC const std::vector<int> &NodeCPUs(int node);
+
+/**
+ * @brief NUMA node of the given CPU, -1 if unknown
+ */
+DLL_PUBLIC int NodeOfCPU(int cpu);
+
+/**
+ * @brief NUMA node of the CPU the calling thread runs on, -1 if unknown
+ */
+DLL_PUBLIC int CurrentNode();
+
+/**
+ * @brief NUMA node closest to the GPU, -1 if unknown
+ */
+DLL_PUBLIC int DeviceNode(int device_id);
+
+/**
+ * @brief NUMA node the threads of a pipeline running on `device_id` should be bound to.
+ *
+ * That's the node set with the `DALI_NUMA_NODE` environment variable or the one
+ * closest to the GPU. Returns -1 if there is no choice to make, i.e. the host has
+ * a single node, or the node is unknown.
+ */
+DLL_PUBLIC int AffinityNode(int device_id);
+
+/**
+ * @brief Restricts the calling thread to the CPUs of `node` (that it's allowed to use).
+ *
+ * The memory allocated by the thread afterwards is placed on that node, see `PlaceMemory`.
+ *
+ * @return false if the thread could not be bound
+ */
+DLL_PUBLIC bool BindCurrentThread(int node);
+
+/**
+ * @brief NUMA node the calling thread was bound to with `BindCurrentThread`, -1 if none
+ */
+DLL_PUBLIC int BoundNode();
+
+/**
+ * @brief Moves the pages of a host allocation to the node the calling thread is bound to.
+ *
+ * The allocations go through the heap, which may hand out pages first touched on another
+ * node. Does nothing for unbound threads and small allocations (less than `kMinPlacedBytes`),
+ * where the first touch policy of the kernel does the job. Best effort, errors are ignored.
+ */
+DLL_PUBLIC void PlaceMemory(void *ptr, size_t bytes);
+
+constexpr size_t kMinPlacedBytes = 1 << 20;
+
+namespace detail {
+
+/**
+ * @brief Parses a list of CPUs in the sysfs format, e.g. "0-3,8,10-11"
+ */
+DLL_PUBLIC std::vector<int> ParseCPUList(const std::string &list);
+
+}  // namespace detail
+
+}  // namespace numa
+}  // namespace dali
+
+#endif  // DALI_CORE_NUMA_H_
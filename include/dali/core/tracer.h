@@ -0,0 +1,88 @@
+// Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DALI_CORE_TRACER_H_
+#define DALI_CORE_TRACER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include "dali/core/api_helper.h"
+
+namespace dali {
+
+/**
+ * @brief Records the timeline of the execution, to be viewed in chrome://tracing or Perfetto.
+ *
+ * Every thread records its events into its own ring buffer, without any locking,
+ * so only the most recent events of every thread are kept. The events come from
+ * the `TimeRange`s, which already mark the interesting regions of the code.
+ *
+ * The tracing is disabled by default and then costs a single relaxed load per `TimeRange`.
+ */
+class DLL_PUBLIC Tracer {
+ public:
+  // Longer names are truncated
+  static constexpr int kMaxNameLength = 63;
+  // Number of the most recent events kept for every thread
+  static constexpr int kEventsPerThread = 1 << 14;
+
+  static inline bool IsEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  static void Enable(bool enabled = true);
+
+  /**
+   * @brief Current time, in nanoseconds, on the clock used for the events
+   */
+  static int64_t Now();
+
+  /**
+   * @brief Records an event of the calling thread, spanning [begin_ns, end_ns)
+   */
+  static void Record(const char *name, size_t length, int64_t begin_ns, int64_t end_ns);
+
+  static void Record(const std::string &name, int64_t begin_ns, int64_t end_ns) {
+    Record(name.data(), name.size(), begin_ns, end_ns);
+  }
+
+  /**
+   * @brief Sets the name under which the events of the calling thread are shown
+   */
+  static void SetThreadName(const std::string &name);
+
+  /**
+   * @brief Writes the recorded events in the Chrome trace event format (JSON).
+   *
+   * The events recorded concurrently with the dump may be left out.
+   */
+  static void DumpChromeTrace(std::ostream &os);
+
+  static void DumpChromeTrace(const std::string &filename);
+
+  /**
+   * @brief Drops all the recorded events, as well as the buffers of the threads that ended
+   */
+  static void Clear();
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+}  // namespace dali
+
+#endif  // DALI_CORE_TRACER_H_